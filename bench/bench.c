@@ -0,0 +1,497 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Runs every corpus through parse, lookup, serialize, free and validate,
+ * and through parse and lookup again with keys interned in one table shared
+ * by the whole corpus, printing a json object per corpus and phase to stdout, one per line:
+ *
+ *   {"corpus":"floats","phase":"parse","bytes":8388608,"values":1048576,
+ *    "seconds":0.031,"mb_per_s":270.6,"ns_per_value":29.56,
+ *    "allocations":1.0,"peak_bytes":9437184,"peak_rss_kb":61440}
+ *
+ * Times are the best of all repeats. allocations and peak_bytes are per
+ * document, counted with a counting allocator in a separate run; they're
+ * null for phases that aren't counted. peak_rss_kb is the high-water mark
+ * of the whole process so far, or null where it can't be found out.
+ *
+ * usage: jsonfc_bench [-r repeat] [-s megabytes] [file...]
+ * Files, if given, are run instead of the generated corpora.
+ */
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+# define BENCH_POSIX
+# ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L
+# endif
+#endif
+
+#include "corpus.h"
+#include "index.h"
+#include "parser.h"
+#include "writer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef BENCH_POSIX
+# include <sys/resource.h>
+#endif
+
+#define BENCH_SIZE_DEFAULT 8 /* megabytes per generated corpus */
+#define BENCH_REPEAT_DEFAULT 5
+
+/* a document of a corpus, not necessarily NUL-terminated */
+struct BenchDocument {
+    const char *text;
+    size_t length;
+};
+
+struct BenchResult {
+    double seconds; /* the best run */
+    size_t bytes, values;
+    double allocations; /* per document, negative if not counted */
+    size_t peak_bytes;
+};
+
+static double bench_now(void) {
+#ifdef BENCH_POSIX
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* the peak resident set size of the process in kilobytes, -1 if unknown */
+static long bench_peak_rss(void) {
+#ifdef BENCH_POSIX
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+# ifdef __APPLE__
+    return (long)(usage.ru_maxrss / 1024); /* in bytes there */
+# else
+    return (long)usage.ru_maxrss;
+# endif
+#else
+    return -1;
+#endif
+}
+
+static void bench_fail(const char* const corpus, const char* const what, const struct JsonError* const error) {
+    if (error != NULL)
+        fprintf(stderr, "%s: %s failed at %lu:%lu, %s\n", corpus, what, (unsigned long)error->line,
+                (unsigned long)error->column, error->reason);
+    else
+        fprintf(stderr, "%s: %s failed\n", corpus, what);
+    exit(1);
+}
+
+/* split a corpus into its documents, every non-blank line of ndjson is one */
+static size_t bench_split(const struct Corpus* const corpus, struct BenchDocument** const documents) {
+    size_t count = 0, allocated = 16, start, end;
+    struct BenchDocument *grown;
+
+    *documents = malloc(allocated * sizeof(struct BenchDocument));
+    if (*documents == NULL)
+        bench_fail(corpus->name, "splitting", NULL);
+
+    if (!corpus->ndjson) {
+        (*documents)[0].text = corpus->text;
+        (*documents)[0].length = corpus->length;
+        return 1;
+    }
+
+    for (start = 0; start < corpus->length; start = end + 1) {
+        for (end = start; end < corpus->length && corpus->text[end] != '\n'; ++end)
+            ;
+        if (strspn(corpus->text + start, " \t\r") >= end - start)
+            continue;
+
+        if (count == allocated) {
+            allocated *= 2;
+            grown = realloc(*documents, allocated * sizeof(struct BenchDocument));
+            if (grown == NULL)
+                bench_fail(corpus->name, "splitting", NULL);
+            *documents = grown;
+        }
+
+        (*documents)[count].text = corpus->text + start;
+        (*documents)[count].length = end - start;
+        ++count;
+    }
+
+    return count;
+}
+
+static size_t bench_count(const struct Value* const value) {
+    size_t count = 1, i;
+
+    if (VALUE_TYPE(value) == Array) {
+        for (i = 0; i < VALUE_ARRAY(value)->written; ++i)
+            count += bench_count(&VALUE_ARRAY(value)->arr_dump[i]);
+    } else if (VALUE_TYPE(value) == Object) {
+        for (i = 0; i < VALUE_OBJECT(value)->pairs; ++i)
+            count += bench_count(&VALUE_OBJECT(value)->nodes[i].value);
+    }
+
+    return count;
+}
+
+/* the objects of a tree, gathered so looking their keys up can be timed on its own */
+struct BenchObjects {
+    struct Object **objects;
+    size_t count, allocated;
+};
+
+static void bench_collect(const struct Value* const value, struct BenchObjects* const objects) {
+    struct Object **grown;
+    size_t i;
+
+    if (VALUE_TYPE(value) == Array) {
+        for (i = 0; i < VALUE_ARRAY(value)->written; ++i)
+            bench_collect(&VALUE_ARRAY(value)->arr_dump[i], objects);
+    } else if (VALUE_TYPE(value) == Object) {
+        if (objects->count == objects->allocated) {
+            objects->allocated = objects->allocated ? objects->allocated * 2 : 64;
+            grown = realloc(objects->objects, objects->allocated * sizeof(struct Object *));
+            if (grown == NULL)
+                bench_fail("lookup", "collecting objects", NULL);
+            objects->objects = grown;
+        }
+        objects->objects[objects->count++] = VALUE_OBJECT(value);
+
+        for (i = 0; i < VALUE_OBJECT(value)->pairs; ++i)
+            bench_collect(&VALUE_OBJECT(value)->nodes[i].value, objects);
+    }
+}
+
+/*
+ * Look every key of every object up, returns how many lookups there were.
+ * With interned set the objects' keys are interned, and are looked up as such.
+ */
+static size_t bench_lookup(const struct BenchObjects* const objects, const bool interned) {
+    struct Object *object;
+    struct Value *value;
+    size_t count = 0, i, j;
+
+    for (i = 0; i < objects->count; ++i) {
+        object = objects->objects[i];
+        for (j = 0; j < object->pairs; ++j) {
+            value = interned ? object_get_interned(object, object->nodes[j].key) :
+                               object_get(object, object->nodes[j].key);
+            if (value != &object->nodes[j].value)
+                bench_fail("lookup", interned ? "object_get_interned" : "object_get", NULL);
+        }
+        count += object->pairs;
+    }
+
+    return count;
+}
+
+static void bench_report(const char* const corpus, const char* const phase,
+                         const struct BenchResult* const result, const int throughput) {
+    long rss = bench_peak_rss();
+    const char *c;
+
+    /* corpora named after files may hold anything a path can */
+    printf("{\"corpus\":\"");
+    for (c = corpus; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\')
+            putchar('\\');
+        if ((unsigned char)*c >= ' ')
+            putchar(*c);
+    }
+
+    printf("\",\"phase\":\"%s\",\"bytes\":%lu,\"values\":%lu,\"seconds\":%.6f,",
+           phase, (unsigned long)result->bytes, (unsigned long)result->values, result->seconds);
+
+    if (throughput)
+        printf("\"mb_per_s\":%.1f,", (double)result->bytes / result->seconds / 1e6);
+    else
+        printf("\"mb_per_s\":null,");
+    printf("\"ns_per_value\":%.2f,", result->values ? result->seconds * 1e9 / (double)result->values : 0.0);
+
+    if (result->allocations >= 0)
+        printf("\"allocations\":%.1f,\"peak_bytes\":%lu,", result->allocations,
+               (unsigned long)result->peak_bytes);
+    else
+        printf("\"allocations\":null,\"peak_bytes\":null,");
+
+    if (rss >= 0)
+        printf("\"peak_rss_kb\":%ld}\n", rss);
+    else
+        printf("\"peak_rss_kb\":null}\n");
+
+    fflush(stdout);
+}
+
+#define BENCH_BEST(best, start) do { \
+        double elapsed_ = bench_now() - (start); \
+        if (elapsed_ < (best)) \
+            (best) = elapsed_; \
+    } while (0)
+
+/*
+ * Count what parsing every document on its own costs, on the heap or in a
+ * document's arena. keys is the key table the document interns into, if
+ * any; its own memory is shared by the whole corpus and isn't counted.
+ */
+static void bench_count_parse(const struct Corpus* const corpus, const struct BenchDocument* const documents,
+                              const size_t count, const int arena, struct KeyTable* const keys,
+                              struct BenchResult* const result) {
+    struct JsonCountingAllocator counter;
+    struct JsonDocument doc;
+    struct JsonError error;
+    struct Arena heap;
+    struct Value *value;
+    size_t i, allocations = 0, consumed;
+    char *copy;
+
+    json_counting_allocator_construct(&counter, NULL);
+    arena_construct_heap(&heap, &counter.allocator);
+    document_construct_with(&doc, &counter.allocator);
+    doc.keys = keys;
+    result->peak_bytes = 0;
+
+    for (i = 0; i < count; ++i) {
+        json_counting_allocator_reset(&counter);
+
+        if (arena) {
+            if (parse_document_next(&doc, documents[i].text, documents[i].length, &consumed, &error) == NULL)
+                bench_fail(corpus->name, "parse_document", &error);
+        } else {
+            /* parse_in wants a terminator, which only the last document of a corpus has */
+            copy = malloc(documents[i].length + 1);
+            if (copy == NULL)
+                bench_fail(corpus->name, "copying", NULL);
+            memcpy(copy, documents[i].text, documents[i].length);
+            copy[documents[i].length] = '\0';
+
+            value = parse_in(copy, &heap, &error);
+            free(copy);
+            if (value == NULL)
+                bench_fail(corpus->name, "parse", &error);
+        }
+
+        allocations += counter.allocations + counter.reallocations;
+        if (counter.peak > result->peak_bytes)
+            result->peak_bytes = counter.peak;
+
+        if (arena)
+            document_reset(&doc);
+        else
+            value_dealloc_in(value, &heap);
+    }
+
+    document_dealloc(&doc);
+    result->allocations = (double)allocations / (double)count;
+}
+
+static void bench_corpus(const struct Corpus* const corpus, const int repeat) {
+    struct BenchResult parse, document, lookup, serialize, release, validate, interned, interned_lookup;
+    struct BenchDocument *documents;
+    struct JsonDocument doc, interned_doc;
+    struct KeyTable keys;
+    struct JsonWriter writer;
+    struct JsonError error;
+    struct BenchObjects objects;
+    struct Value **trees;
+    size_t count, i, consumed, lookups = 0, values = 0, written = 0;
+    double start;
+    int run;
+
+    count = bench_split(corpus, &documents);
+    trees = malloc(count * sizeof(struct Value *));
+    if (trees == NULL)
+        bench_fail(corpus->name, "allocating", NULL);
+
+    objects.objects = NULL;
+    objects.allocated = 0;
+    parse.seconds = document.seconds = lookup.seconds = serialize.seconds = release.seconds =
+        validate.seconds = interned.seconds = interned_lookup.seconds = 1e300;
+    document_construct(&doc);
+    document_construct(&interned_doc);
+    key_table_construct(&keys);
+    interned_doc.keys = &keys;
+
+    for (run = 0; run < repeat; ++run) {
+        start = bench_now();
+        for (i = 0; i < count; ++i) {
+            trees[i] = parse_n(documents[i].text, documents[i].length, &error);
+            if (trees[i] == NULL)
+                bench_fail(corpus->name, "parse", &error);
+        }
+        BENCH_BEST(parse.seconds, start);
+
+        if (run == 0) {
+            for (i = 0; i < count; ++i)
+                values += bench_count(trees[i]);
+        }
+
+        for (i = 0, objects.count = 0; i < count; ++i)
+            bench_collect(trees[i], &objects);
+
+        start = bench_now();
+        lookups = bench_lookup(&objects, false);
+        BENCH_BEST(lookup.seconds, start);
+
+        start = bench_now();
+        json_writer_construct(&writer);
+        for (i = 0; i < count; ++i)
+            json_write(trees[i], &writer);
+        written = writer.length;
+        if (writer.failed)
+            bench_fail(corpus->name, "serialize", NULL);
+        json_writer_dealloc(&writer);
+        BENCH_BEST(serialize.seconds, start);
+
+        start = bench_now();
+        for (i = 0; i < count; ++i)
+            value_dealloc(trees[i]);
+        BENCH_BEST(release.seconds, start);
+
+        start = bench_now();
+        for (i = 0; i < count; ++i) {
+            if (parse_document_next(&doc, documents[i].text, documents[i].length, &consumed, &error) == NULL)
+                bench_fail(corpus->name, "parse_document", &error);
+            document_reset(&doc);
+        }
+        BENCH_BEST(document.seconds, start);
+
+        start = bench_now();
+        for (i = 0; i < count; ++i) {
+            if (!json_validate(documents[i].text, documents[i].length, &error))
+                bench_fail(corpus->name, "validate", &error);
+        }
+        BENCH_BEST(validate.seconds, start);
+
+        start = bench_now();
+        for (i = 0; i < count; ++i) {
+            if (parse_document_next(&interned_doc, documents[i].text, documents[i].length, &consumed,
+                                    &error) == NULL)
+                bench_fail(corpus->name, "parse_interned", &error);
+            document_reset(&interned_doc);
+        }
+        BENCH_BEST(interned.seconds, start);
+
+        /* parse_document_next keeps the documents before, so all of them can be looked into */
+        for (i = 0; i < count; ++i) {
+            trees[i] = parse_document_next(&interned_doc, documents[i].text, documents[i].length, &consumed,
+                                           &error);
+            if (trees[i] == NULL)
+                bench_fail(corpus->name, "parse_interned", &error);
+        }
+
+        for (i = 0, objects.count = 0; i < count; ++i)
+            bench_collect(trees[i], &objects);
+
+        start = bench_now();
+        if (bench_lookup(&objects, true) != lookups)
+            bench_fail(corpus->name, "lookup_interned", NULL);
+        BENCH_BEST(interned_lookup.seconds, start);
+        document_reset(&interned_doc);
+    }
+
+    document_dealloc(&doc);
+    document_dealloc(&interned_doc);
+
+    parse.bytes = document.bytes = lookup.bytes = release.bytes = validate.bytes = interned.bytes =
+        interned_lookup.bytes = corpus->length;
+    parse.values = document.values = serialize.values = release.values = validate.values =
+        interned.values = values;
+    serialize.bytes = written;
+    lookup.values = interned_lookup.values = lookups;
+    lookup.allocations = serialize.allocations = release.allocations = validate.allocations =
+        interned_lookup.allocations = -1;
+
+    bench_count_parse(corpus, documents, count, 0, NULL, &parse);
+    bench_count_parse(corpus, documents, count, 1, NULL, &document);
+    bench_count_parse(corpus, documents, count, 1, &keys, &interned);
+    key_table_dealloc(&keys);
+
+    bench_report(corpus->name, "parse", &parse, 1);
+    bench_report(corpus->name, "parse_document", &document, 1);
+    bench_report(corpus->name, "lookup", &lookup, 0);
+    bench_report(corpus->name, "serialize", &serialize, 1);
+    bench_report(corpus->name, "free", &release, 1);
+    bench_report(corpus->name, "validate", &validate, 1);
+    bench_report(corpus->name, "parse_interned", &interned, 1);
+    bench_report(corpus->name, "lookup_interned", &interned_lookup, 0);
+
+    free(objects.objects);
+    free(trees);
+    free(documents);
+}
+
+static void bench_usage(const char* const program) {
+    fprintf(stderr, "usage: %s [-r repeat] [-s megabytes] [file...]\n", program);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    struct Corpus corpora[CORPUS_COUNT], corpus;
+    int repeat = BENCH_REPEAT_DEFAULT, size = BENCH_SIZE_DEFAULT, files = 0, i;
+
+    for (i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            repeat = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            size = atoi(argv[++i]);
+        else if (argv[i][0] == '-')
+            bench_usage(argv[0]);
+        else
+            break;
+    }
+
+    if (repeat < 1 || size < 1)
+        bench_usage(argv[0]);
+
+    for (; i < argc; ++i, ++files) {
+        if (!corpus_load(&corpus, argv[i])) {
+            fprintf(stderr, "%s: can't read it\n", argv[i]);
+            return 1;
+        }
+        bench_corpus(&corpus, repeat);
+        corpus_dealloc(&corpus);
+    }
+
+    if (files > 0)
+        return 0;
+
+    corpus_generate(corpora, (size_t)size * 1024 * 1024);
+    for (i = 0; i < CORPUS_COUNT; ++i) {
+        bench_corpus(&corpora[i], repeat);
+        corpus_dealloc(&corpora[i]);
+    }
+
+    return 0;
+}
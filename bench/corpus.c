@@ -0,0 +1,303 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "corpus.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* a growing NUL-terminated buffer, running out of memory ends the program */
+struct CorpusText {
+    char *text;
+    size_t length, allocated;
+};
+
+static void text_append(struct CorpusText* const text, const char* const string, const size_t length) {
+    char *grown;
+
+    if (text->length + length + 1 > text->allocated) {
+        while (text->length + length + 1 > text->allocated)
+            text->allocated = text->allocated ? text->allocated * 2 : 4096;
+
+        grown = realloc(text->text, text->allocated);
+        if (grown == NULL) {
+            fprintf(stderr, "out of memory generating the corpus\n");
+            exit(1);
+        }
+        text->text = grown;
+    }
+
+    memcpy(text->text + text->length, string, length);
+    text->length += length;
+    text->text[text->length] = '\0';
+}
+
+static void text_puts(struct CorpusText* const text, const char* const string) {
+    text_append(text, string, strlen(string));
+}
+
+static void text_long(struct CorpusText* const text, const long number) {
+    char digits[32];
+
+    sprintf(digits, "%ld", number);
+    text_puts(text, digits);
+}
+
+/* xorshift, so every platform generates the same text */
+static unsigned long corpus_random(unsigned long* const state) {
+    unsigned long x = *state;
+
+    x ^= (x << 13) & 0xffffffffUL;
+    x ^= x >> 17;
+    x ^= (x << 5) & 0xffffffffUL;
+    *state = x;
+    return x;
+}
+
+#define RANDOM_BELOW(state, n) (corpus_random(state) % (unsigned long)(n))
+
+static const char *const corpus_words[] = {
+    "the", "json", "parser", "fast", "arena", "value", "string", "number",
+    "caf\xc3\xa9", "na\xc3\xafve", "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e", "\xf0\x9f\x98\x80",
+    "\\\"quoted\\\"", "line\\nbreak", "tab\\there", "path\\/to", "back\\\\slash",
+    "lorem", "ipsum", "dolor", "sit", "amet", "#hashtag", "@mention", "http://t.co/x",
+    "\\u00e9t\\u00e9", "\\ud83d\\ude00"
+};
+
+#define CORPUS_WORDS (sizeof(corpus_words) / sizeof(corpus_words[0]))
+
+static void text_sentence(struct CorpusText* const text, unsigned long* const state, const size_t words) {
+    size_t i;
+
+    text_puts(text, "\"");
+    for (i = 0; i < words; ++i) {
+        if (i > 0)
+            text_puts(text, " ");
+        text_puts(text, corpus_words[RANDOM_BELOW(state, CORPUS_WORDS)]);
+    }
+    text_puts(text, "\"");
+}
+
+static void generate_strings(struct CorpusText* const text, const size_t size) {
+    unsigned long state = 2463534242UL;
+    long id = 500000000L;
+    size_t i;
+
+    text_puts(text, "{\"statuses\":[");
+    for (i = 0; text->length < size; ++i) {
+        if (i > 0)
+            text_puts(text, ",");
+        id += (long)RANDOM_BELOW(&state, 10000);
+
+        text_puts(text, "{\"created_at\":\"Sun Aug 31 00:29:15 +0000 2014\",\"id\":");
+        text_long(text, id);
+        text_puts(text, ",\"id_str\":\"");
+        text_long(text, id);
+        text_puts(text, "\",\"text\":");
+        text_sentence(text, &state, 4 + RANDOM_BELOW(&state, 20));
+        text_puts(text, ",\"truncated\":false,\"user\":{\"id\":");
+        text_long(text, (long)RANDOM_BELOW(&state, 2000000000UL));
+        text_puts(text, ",\"name\":");
+        text_sentence(text, &state, 2);
+        text_puts(text, ",\"screen_name\":");
+        text_sentence(text, &state, 1);
+        text_puts(text, ",\"description\":");
+        text_sentence(text, &state, RANDOM_BELOW(&state, 12));
+        text_puts(text, ",\"followers_count\":");
+        text_long(text, (long)RANDOM_BELOW(&state, 100000));
+        text_puts(text, ",\"verified\":false,\"profile_image_url\":\"http://pbs.twimg.com/profile_images/");
+        text_long(text, (long)RANDOM_BELOW(&state, 1000000000UL));
+        text_puts(text, "/normal.jpeg\"},\"entities\":{\"hashtags\":[");
+        if (RANDOM_BELOW(&state, 3) == 0)
+            text_puts(text, "{\"text\":\"json\",\"indices\":[10,15]}");
+        text_puts(text, "],\"user_mentions\":[],\"urls\":[]},\"retweet_count\":");
+        text_long(text, (long)RANDOM_BELOW(&state, 500));
+        text_puts(text, ",\"favorited\":false,\"lang\":\"en\",\"geo\":null}");
+    }
+    text_puts(text, "],\"search_metadata\":{\"count\":");
+    text_long(text, (long)i);
+    text_puts(text, ",\"query\":\"json\"}}");
+}
+
+static void generate_floats(struct CorpusText* const text, const size_t size) {
+    unsigned long state = 88172645UL;
+    double x = -65.613616999999977, y = 43.420273000000009;
+    char number[64];
+    size_t i;
+
+    text_puts(text, "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\","
+                    "\"properties\":{\"name\":\"Canada\"},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[");
+    for (i = 0; text->length < size; ++i) {
+        if (i > 0 && i % 4096 == 0)
+            text_puts(text, "],[");
+        else if (i > 0)
+            text_puts(text, ",");
+
+        x += ((double)RANDOM_BELOW(&state, 20001) - 10000.0) / 1000000.0;
+        y += ((double)RANDOM_BELOW(&state, 20001) - 10000.0) / 1000000.0;
+        sprintf(number, "[%.*f,%.*f]", 12 + (int)RANDOM_BELOW(&state, 4), x,
+                12 + (int)RANDOM_BELOW(&state, 4), y);
+        text_puts(text, number);
+    }
+    text_puts(text, "]]}}]}");
+}
+
+static void generate_deep(struct CorpusText* const text, const size_t size) {
+    unsigned long state = 521288629UL;
+    size_t i, level, depth;
+
+    text_puts(text, "[");
+    for (i = 0; text->length < size; ++i) {
+        if (i > 0)
+            text_puts(text, ",");
+
+        /* mostly shallow, now and then hundreds of levels deep */
+        depth = 1 + RANDOM_BELOW(&state, RANDOM_BELOW(&state, 8) == 0 ? 500 : 16);
+        for (level = 0; level < depth; ++level)
+            text_puts(text, level % 2 ? "{\"child\":" : "[");
+        text_long(text, (long)i);
+        for (level = depth; level-- > 0;)
+            text_puts(text, level % 2 ? ",\"depth\":1}" : ",null]");
+    }
+    text_puts(text, "]");
+}
+
+static void generate_flat(struct CorpusText* const text, const size_t size) {
+    unsigned long state = 123456789UL;
+    char number[32];
+    size_t i;
+
+    text_puts(text, "[");
+    for (i = 0; text->length < size; ++i) {
+        if (i > 0)
+            text_puts(text, ",");
+
+        switch (RANDOM_BELOW(&state, 8)) {
+        case 0:
+            sprintf(number, "%.1f", (double)RANDOM_BELOW(&state, 100000) / 10.0);
+            text_puts(text, number);
+            break;
+        case 1:
+            text_puts(text, RANDOM_BELOW(&state, 3) == 0 ? "null" : RANDOM_BELOW(&state, 2) ? "true" : "false");
+            break;
+        case 2:
+            text_long(text, -(long)RANDOM_BELOW(&state, 1000000000UL));
+            break;
+        default:
+            text_long(text, (long)RANDOM_BELOW(&state, 1UL << (RANDOM_BELOW(&state, 31) + 1)));
+            break;
+        }
+    }
+    text_puts(text, "]");
+}
+
+static void generate_ndjson(struct CorpusText* const text, const size_t size) {
+    static const char *const levels[] = { "debug", "info", "info", "info", "warn", "error" };
+    unsigned long state = 362436069UL;
+    char number[32];
+    size_t i;
+
+    for (i = 0; text->length < size; ++i) {
+        text_puts(text, "{\"ts\":\"2014-08-31T00:29:");
+        sprintf(number, "%02lu.%03luZ\"", RANDOM_BELOW(&state, 60), RANDOM_BELOW(&state, 1000));
+        text_puts(text, number);
+        text_puts(text, ",\"level\":\"");
+        text_puts(text, levels[RANDOM_BELOW(&state, 6)]);
+        text_puts(text, "\",\"host\":\"web-");
+        text_long(text, (long)RANDOM_BELOW(&state, 64));
+        text_puts(text, "\",\"status\":");
+        text_long(text, RANDOM_BELOW(&state, 10) ? 200 : 500);
+        text_puts(text, ",\"latency_ms\":");
+        sprintf(number, "%.3f", (double)RANDOM_BELOW(&state, 2000000) / 1000.0);
+        text_puts(text, number);
+        text_puts(text, ",\"path\":\"/api/v1/items/");
+        text_long(text, (long)RANDOM_BELOW(&state, 100000));
+        text_puts(text, "\",\"msg\":");
+        text_sentence(text, &state, 3 + RANDOM_BELOW(&state, 6));
+        text_puts(text, ",\"tags\":[\"http\",\"api\"],\"user\":{\"id\":");
+        text_long(text, (long)RANDOM_BELOW(&state, 1000000));
+        text_puts(text, ",\"ip\":\"10.0.");
+        text_long(text, (long)RANDOM_BELOW(&state, 256));
+        text_puts(text, ".");
+        text_long(text, (long)RANDOM_BELOW(&state, 256));
+        text_puts(text, "\"}}\n");
+    }
+}
+
+void corpus_generate(struct Corpus* const corpora, const size_t size) {
+    static const char *const names[CORPUS_COUNT] = { "strings", "floats", "deep", "flat", "ndjson" };
+    static void (*const generators[CORPUS_COUNT])(struct CorpusText* const, const size_t) = {
+        generate_strings, generate_floats, generate_deep, generate_flat, generate_ndjson
+    };
+    struct CorpusText text;
+    size_t i;
+
+    for (i = 0; i < CORPUS_COUNT; ++i) {
+        text.text = NULL;
+        text.length = 0;
+        text.allocated = 0;
+        generators[i](&text, size);
+
+        corpora[i].name = names[i];
+        corpora[i].text = text.text;
+        corpora[i].length = text.length;
+        corpora[i].ndjson = generators[i] == generate_ndjson;
+    }
+}
+
+int corpus_load(struct Corpus* const corpus, const char* const filename) {
+    size_t name_length = strlen(filename);
+    FILE *file = fopen(filename, "rb");
+    long length;
+
+    if (file == NULL)
+        return 0;
+
+    if (fseek(file, 0, SEEK_END) != 0 || (length = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return 0;
+    }
+
+    corpus->text = malloc((size_t)length + 1);
+    if (corpus->text == NULL || fread(corpus->text, 1, (size_t)length, file) != (size_t)length) {
+        free(corpus->text);
+        fclose(file);
+        return 0;
+    }
+
+    fclose(file);
+    corpus->text[length] = '\0';
+    corpus->length = (size_t)length;
+    corpus->name = filename;
+    corpus->ndjson = name_length >= 7 && strcmp(filename + name_length - 7, ".ndjson") == 0;
+    return 1;
+}
+
+void corpus_dealloc(struct Corpus* const corpus) {
+    free(corpus->text);
+    corpus->text = NULL;
+    corpus->length = 0;
+}
@@ -0,0 +1,62 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JSON_BENCH_CORPUS_H
+#define JSON_BENCH_CORPUS_H
+
+#include <stddef.h>
+
+/* how many corpora corpus_generate makes */
+#define CORPUS_COUNT 5
+
+/*
+ * A benchmark input, NUL-terminated. It's one document, or one document
+ * per line if ndjson is set.
+ */
+struct Corpus {
+    const char *name;
+    char *text;
+    size_t length;
+    int ndjson;
+};
+
+/*
+ * Generate the standard corpora, each about size bytes long, into corpora.
+ * The same size always gives the same text. In order:
+ *
+ *   strings  tweet-like objects, mostly text with escapes and UTF-8
+ *   floats   polygon coordinates, doubles printed with up to 17 digits
+ *   deep     arrays and objects nested up to hundreds of levels
+ *   flat     one huge array of integers, doubles and literals
+ *   ndjson   a log of small records, one per line
+ */
+void corpus_generate(struct Corpus* const corpora, const size_t size);
+
+/* read filename in as a corpus, files ending in .ndjson are taken as ndjson */
+int corpus_load(struct Corpus* const corpus, const char* const filename);
+
+void corpus_dealloc(struct Corpus* const corpus);
+
+#endif /* JSON_BENCH_CORPUS_H */
@@ -0,0 +1,268 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* every allocation is aligned to the strictest of these */
+union ArenaAlign {
+    double d;
+    long l;
+    void *p;
+};
+
+#define ARENA_ALIGN(size) \
+    (((size) + sizeof(union ArenaAlign) - 1) & ~(sizeof(union ArenaAlign) - 1))
+
+#define ARENA_CHUNK_HEADER ARENA_ALIGN(sizeof(struct ArenaChunk))
+#define ARENA_CHUNK_DATA(chunk) ((char *)(chunk) + ARENA_CHUNK_HEADER)
+
+void *json_alloc(const struct JsonAllocator* const allocator, const size_t size) {
+    if (allocator == NULL)
+        return malloc(size);
+    return allocator->allocate(allocator->context, size);
+}
+
+void *json_realloc(const struct JsonAllocator* const allocator, void *ptr, const size_t size) {
+    if (allocator == NULL)
+        return realloc(ptr, size);
+    return allocator->reallocate(allocator->context, ptr, size);
+}
+
+void json_free(const struct JsonAllocator* const allocator, void *ptr) {
+    if (allocator == NULL)
+        free(ptr);
+    else if (ptr != NULL)
+        allocator->deallocate(allocator->context, ptr);
+}
+
+/* what the counting allocator puts in front of every allocation */
+union CountingHeader {
+    size_t size;
+    union ArenaAlign align;
+};
+
+static void counting_grow(struct JsonCountingAllocator* const counter, const size_t size) {
+    counter->bytes += size;
+    counter->total += size;
+    if (counter->bytes > counter->peak)
+        counter->peak = counter->bytes;
+}
+
+static void *counting_allocate(void *context, size_t size) {
+    struct JsonCountingAllocator *counter = context;
+    union CountingHeader *header = json_alloc(counter->parent, sizeof(union CountingHeader) + size);
+
+    if (header == NULL)
+        return NULL;
+
+    header->size = size;
+    ++counter->allocations;
+    counting_grow(counter, size);
+    return header + 1;
+}
+
+static void *counting_reallocate(void *context, void *ptr, size_t size) {
+    struct JsonCountingAllocator *counter = context;
+    union CountingHeader *header;
+    size_t old_size;
+
+    if (ptr == NULL)
+        return counting_allocate(context, size);
+
+    header = (union CountingHeader *)ptr - 1;
+    old_size = header->size;
+    header = json_realloc(counter->parent, header, sizeof(union CountingHeader) + size);
+    if (header == NULL)
+        return NULL;
+
+    header->size = size;
+    ++counter->reallocations;
+    counter->bytes -= old_size;
+    counting_grow(counter, size);
+    return header + 1;
+}
+
+static void counting_deallocate(void *context, void *ptr) {
+    struct JsonCountingAllocator *counter = context;
+    union CountingHeader *header = (union CountingHeader *)ptr - 1;
+
+    ++counter->deallocations;
+    counter->bytes -= header->size;
+    json_free(counter->parent, header);
+}
+
+void json_counting_allocator_construct(struct JsonCountingAllocator* const counter,
+                                       const struct JsonAllocator* const parent) {
+    counter->allocator.context = counter;
+    counter->allocator.allocate = counting_allocate;
+    counter->allocator.reallocate = counting_reallocate;
+    counter->allocator.deallocate = counting_deallocate;
+    counter->parent = parent;
+    counter->bytes = 0;
+    json_counting_allocator_reset(counter);
+}
+
+void json_counting_allocator_reset(struct JsonCountingAllocator* const counter) {
+    counter->peak = counter->bytes;
+    counter->total = 0;
+    counter->allocations = 0;
+    counter->reallocations = 0;
+    counter->deallocations = 0;
+}
+
+void arena_construct_with(struct Arena* const arena, const struct JsonAllocator* const allocator) {
+    arena->head = NULL;
+    arena->next_chunk_size = ARENA_CHUNK_SIZE_DEFAULT;
+    arena->allocator = allocator;
+    arena->heap = 0;
+}
+
+void arena_construct(struct Arena* const arena) {
+    arena_construct_with(arena, NULL);
+}
+
+void arena_construct_heap(struct Arena* const arena, const struct JsonAllocator* const allocator) {
+    arena_construct_with(arena, allocator);
+    arena->heap = 1;
+}
+
+static struct ArenaChunk *arena_add_chunk(struct Arena* const arena, const size_t min_size) {
+    struct ArenaChunk *chunk;
+    size_t size = arena->next_chunk_size;
+
+    if (size < min_size)
+        size = min_size;
+
+    chunk = json_alloc(arena->allocator, ARENA_CHUNK_HEADER + size);
+    if (chunk == NULL)
+        return NULL;
+
+    chunk->size = size;
+    chunk->used = 0;
+    chunk->next = arena->head;
+    arena->head = chunk;
+
+    if (arena->next_chunk_size < ARENA_CHUNK_SIZE_MAX)
+        arena->next_chunk_size *= 2;
+
+    return chunk;
+}
+
+void *arena_alloc(struct Arena* const arena, const size_t size) {
+    struct ArenaChunk *chunk;
+    size_t aligned;
+    void *ptr;
+
+    if (arena == NULL)
+        return malloc(size);
+    if (arena->heap)
+        return json_alloc(arena->allocator, size);
+
+    aligned = ARENA_ALIGN(size);
+    chunk = arena->head;
+
+    if (chunk == NULL || chunk->size - chunk->used < aligned) {
+        chunk = arena_add_chunk(arena, aligned);
+        if (chunk == NULL)
+            return NULL;
+    }
+
+    ptr = ARENA_CHUNK_DATA(chunk) + chunk->used;
+    chunk->used += aligned;
+    return ptr;
+}
+
+void *arena_realloc(struct Arena* const arena, void *ptr, const size_t old_size, const size_t new_size) {
+    struct ArenaChunk *chunk;
+    size_t old_aligned, new_aligned;
+    void *new_ptr;
+
+    if (arena == NULL)
+        return realloc(ptr, new_size);
+    if (arena->heap)
+        return json_realloc(arena->allocator, ptr, new_size);
+
+    if (ptr == NULL)
+        return arena_alloc(arena, new_size);
+
+    chunk = arena->head;
+    old_aligned = ARENA_ALIGN(old_size);
+    new_aligned = ARENA_ALIGN(new_size);
+
+    /* the last allocation can grow or shrink in place */
+    if ((char *)ptr + old_aligned == ARENA_CHUNK_DATA(chunk) + chunk->used &&
+        chunk->used - old_aligned + new_aligned <= chunk->size) {
+        chunk->used = chunk->used - old_aligned + new_aligned;
+        return ptr;
+    }
+
+    if (new_size <= old_size)
+        return ptr;
+
+    new_ptr = arena_alloc(arena, new_size);
+    if (new_ptr == NULL)
+        return NULL;
+
+    memcpy(new_ptr, ptr, old_size);
+    return new_ptr;
+}
+
+void arena_free(struct Arena* const arena, void *ptr) {
+    /* arena memory is only released as a whole */
+    if (arena == NULL)
+        free(ptr);
+    else if (arena->heap)
+        json_free(arena->allocator, ptr);
+}
+
+void arena_reset(struct Arena* const arena) {
+    struct ArenaChunk *chunk, *next;
+
+    if (arena->head == NULL)
+        return;
+
+    for (chunk = arena->head->next; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        json_free(arena->allocator, chunk);
+    }
+
+    arena->head->next = NULL;
+    arena->head->used = 0;
+}
+
+void arena_dealloc(struct Arena* const arena) {
+    struct ArenaChunk *chunk, *next;
+
+    for (chunk = arena->head; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        json_free(arena->allocator, chunk);
+    }
+
+    arena->head = NULL;
+    arena->next_chunk_size = ARENA_CHUNK_SIZE_DEFAULT;
+}
@@ -0,0 +1,119 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <stddef.h>
+
+/* size of the first chunk, every chunk after it is twice as big as the last */
+#define ARENA_CHUNK_SIZE_DEFAULT 4096
+#define ARENA_CHUNK_SIZE_MAX (1024 * 1024)
+
+/*
+ * Where memory comes from, to plug in a pool or a malloc replacement. The
+ * functions behave like malloc, realloc and free, context is passed to
+ * every one of them. Everywhere an allocator is taken, NULL stands for
+ * malloc, realloc and free themselves.
+ */
+struct JsonAllocator {
+    void *context;
+    void *(*allocate)(void *context, size_t size);
+    void *(*reallocate)(void *context, void *ptr, size_t size);
+    void (*deallocate)(void *context, void *ptr);
+};
+
+void *json_alloc(const struct JsonAllocator* const allocator, const size_t size);
+
+void *json_realloc(const struct JsonAllocator* const allocator, void *ptr, const size_t size);
+
+void json_free(const struct JsonAllocator* const allocator, void *ptr);
+
+/*
+ * An allocator that passes everything on to parent, keeping count of what
+ * goes through it. Each allocation carries a small header recording its
+ * size. Not thread safe, give every thread its own.
+ */
+struct JsonCountingAllocator {
+    struct JsonAllocator allocator; /* hand &counter->allocator out */
+    const struct JsonAllocator *parent;
+    size_t bytes; /* requested and not freed yet */
+    size_t peak; /* the most bytes ever was */
+    size_t total; /* all bytes ever requested, reallocations included */
+    size_t allocations, reallocations, deallocations;
+};
+
+void json_counting_allocator_construct(struct JsonCountingAllocator* const counter,
+                                       const struct JsonAllocator* const parent);
+
+/* zero the counts, the bytes still allocated stay counted */
+void json_counting_allocator_reset(struct JsonCountingAllocator* const counter);
+
+/*
+ * A bump-pointer allocator. Memory taken from an arena is only given back
+ * all at once, with arena_reset or arena_dealloc.
+ *
+ * A heap arena is the exception: it passes every allocation on to its
+ * allocator and frees them one by one, like the heap would. Containers made
+ * in one are freed with array_dealloc, object_dealloc and value_dealloc_in
+ * as usual, but their memory comes from the allocator.
+ *
+ * All arena functions accept a NULL arena, in which case they fall back to
+ * malloc, realloc and free.
+ */
+struct Arena {
+    struct ArenaChunk {
+        struct ArenaChunk *next;
+        size_t size, used;
+    } *head;
+    size_t next_chunk_size;
+    const struct JsonAllocator *allocator; /* where chunks come from */
+    int heap;
+};
+
+/* whether memory from arena is only ever released all at once */
+#define ARENA_BULK(arena) ((arena) != NULL && !(arena)->heap)
+#define ARENA_ALLOCATOR(arena) ((arena) != NULL ? (arena)->allocator : NULL)
+
+void arena_construct(struct Arena* const arena);
+
+/* an arena whose chunks come from allocator */
+void arena_construct_with(struct Arena* const arena, const struct JsonAllocator* const allocator);
+
+/* a heap arena, every allocation goes straight to allocator */
+void arena_construct_heap(struct Arena* const arena, const struct JsonAllocator* const allocator);
+
+void *arena_alloc(struct Arena* const arena, const size_t size);
+
+void *arena_realloc(struct Arena* const arena, void *ptr, const size_t old_size, const size_t new_size);
+
+void arena_free(struct Arena* const arena, void *ptr);
+
+/* release everything, but keep the newest chunk around for reuse */
+void arena_reset(struct Arena* const arena);
+
+void arena_dealloc(struct Arena* const arena);
+
+#endif /* JSON_ARENA_H */
@@ -0,0 +1,976 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "index.h"
+#include "number.h"
+#include "scan.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+# define INDEX_CTZ(bits) __builtin_ctzll(bits)
+#else
+# define INDEX_CTZ(bits) index_ctz(bits)
+
+static int index_ctz(json_uint bits) {
+    int count = 0;
+
+    for (; !(bits & 1); bits >>= 1)
+        ++count;
+    return count;
+}
+#endif
+
+#define INDEX_NONE ((size_t)-1)
+#define INDEX_CHAR(index, at) ((index)->buffer[(index)->offsets[at]])
+
+/* bit i is set if an odd number of bits up to and including i are */
+static json_uint prefix_xor(json_uint bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+/*
+ * The bytes escaped by a backslash. Backslashes are rare enough to go
+ * through one by one, a backslash that is escaped itself escapes nothing.
+ * carry is set if the last byte of the block escapes the next block's first.
+ */
+static json_uint index_escaped(json_uint backslashes, json_uint* const carry) {
+    json_uint escaped = *carry, bit;
+
+    *carry = 0;
+    while (backslashes != 0) {
+        bit = backslashes & (~backslashes + 1);
+        backslashes ^= bit;
+
+        if (escaped & bit)
+            continue;
+        if (bit << 1 == 0)
+            *carry = 1;
+        else
+            escaped |= bit << 1;
+    }
+
+    return escaped;
+}
+
+static bool index_reserve(struct JsonIndex* const index, const size_t count) {
+    size_t allocated = index->allocated ? index->allocated : 256;
+    size_t *offsets;
+
+    if (count <= index->allocated)
+        return true;
+
+    while (allocated < count)
+        allocated *= 2;
+
+    offsets = realloc(index->offsets, allocated * sizeof(size_t));
+    if (offsets == NULL)
+        return false;
+
+    index->offsets = offsets;
+    index->allocated = allocated;
+    return true;
+}
+
+/* what one block of 64 bytes leaves over for the next */
+struct IndexCarry {
+    json_uint escape, string, scalar;
+};
+
+/* one block of 64 bytes, classified */
+struct IndexBlock {
+    json_uint structural; /* structural characters outside of strings, and where every value starts */
+    json_uint operators; /* just the structural characters */
+    json_uint in_string; /* from every opening quote up to, not including, its closing one */
+    json_uint escaped; /* bytes a backslash escapes */
+    struct ScanBlock scan;
+};
+
+/* classify the 64 bytes at base, blanks fill in past the end of the buffer */
+static void index_block(const char* const buffer, const size_t length, const size_t base,
+                        struct IndexCarry* const carry, struct IndexBlock* const block) {
+    json_uint quotes, scalars;
+    char tail[64];
+
+    if (length - base >= 64) {
+        scan_block(buffer + base, &block->scan);
+    } else {
+        memset(tail, ' ', sizeof(tail));
+        memcpy(tail, buffer + base, length - base);
+        scan_block(tail, &block->scan);
+    }
+
+    /* strings run from their opening quote up to, not including, their closing one */
+    block->escaped = index_escaped(block->scan.backslashes, &carry->escape);
+    quotes = block->scan.quotes & ~block->escaped;
+    block->in_string = prefix_xor(quotes) ^ carry->string;
+    carry->string = (json_uint)0 - (block->in_string >> 63);
+
+    /* numbers and literals, recorded where they start */
+    scalars = ~(block->scan.whitespace | block->scan.operators | block->scan.quotes | block->in_string);
+
+    block->operators = block->scan.operators & ~block->in_string;
+    block->structural = block->operators | (quotes & block->in_string) |
+                        (scalars & ~((scalars << 1) | carry->scalar));
+    carry->scalar = scalars >> 63;
+}
+
+/* find every structural character and the start of every value, 64 bytes at a time */
+static bool index_scan(struct JsonIndex* const index, struct JsonError* const error) {
+    struct IndexCarry carry = { 0, 0, 0 };
+    struct IndexBlock block;
+    json_uint structural;
+    size_t base;
+
+    for (base = 0; base < index->length; base += 64) {
+        index_block(index->buffer, index->length, base, &carry, &block);
+        structural = block.structural;
+
+        if (!index_reserve(index, index->count + 64)) {
+            error_construct(error, index->buffer, base, "out of memory");
+            return false;
+        }
+
+        for (; structural != 0; structural &= structural - 1)
+            index->offsets[index->count++] = base + INDEX_CTZ(structural);
+    }
+
+    if (carry.string != 0) {
+        error_construct(error, index->buffer, index->length, "unterminated string");
+        return false;
+    }
+
+    return true;
+}
+
+/* pair up the brackets, using matches as the stack of the open ones */
+static bool index_match(struct JsonIndex* const index, struct JsonError* const error) {
+    size_t open = INDEX_NONE, i, outer;
+    char c;
+
+    index->matches = malloc((index->count ? index->count : 1) * sizeof(size_t));
+    if (index->matches == NULL) {
+        error_construct(error, index->buffer, 0, "out of memory");
+        return false;
+    }
+
+    for (i = 0; i < index->count; ++i) {
+        c = INDEX_CHAR(index, i);
+
+        if (c == '[' || c == '{') {
+            index->matches[i] = open;
+            open = i;
+        } else if (c == ']' || c == '}') {
+            /* the closing brackets are two past the opening ones */
+            if (open == INDEX_NONE || INDEX_CHAR(index, open) != c - 2) {
+                error_construct(error, index->buffer, index->offsets[i], "unexpected character");
+                return false;
+            }
+            outer = index->matches[open];
+            index->matches[open] = i;
+            open = outer;
+        }
+    }
+
+    if (index->count == 0 || open != INDEX_NONE) {
+        error_construct(error, index->buffer, index->length, "unexpected end of input");
+        return false;
+    }
+
+    /* the root has to be all there is */
+    c = INDEX_CHAR(index, 0);
+    i = c == '[' || c == '{' ? index->matches[0] + 1 : 1;
+    if (i < index->count) {
+        error_construct(error, index->buffer, index->offsets[i], "trailing characters after the value");
+        return false;
+    }
+
+    return true;
+}
+
+bool json_index_build(struct JsonIndex* const index, const char* const buffer, const size_t length,
+                      struct JsonError* const error) {
+    index->buffer = buffer;
+    index->length = length;
+    index->offsets = NULL;
+    index->matches = NULL;
+    index->count = 0;
+    index->allocated = 0;
+
+    if (!index_scan(index, error) || !index_match(index, error)) {
+        json_index_dealloc(index);
+        return false;
+    }
+
+    return true;
+}
+
+void json_index_dealloc(struct JsonIndex* const index) {
+    free(index->offsets);
+    free(index->matches);
+    index->offsets = NULL;
+    index->matches = NULL;
+    index->count = 0;
+    index->allocated = 0;
+}
+
+/* append offset to splits, which has room for allocated offsets */
+static bool index_split(size_t** const splits, size_t* const count, size_t* const allocated,
+                        const size_t offset) {
+    size_t *grown;
+
+    if (*count >= *allocated) {
+        grown = realloc(*splits, (*allocated ? *allocated * 2 : 256) * sizeof(size_t));
+        if (grown == NULL)
+            return false;
+        *splits = grown;
+        *allocated = *allocated ? *allocated * 2 : 256;
+    }
+
+    (*splits)[(*count)++] = offset;
+    return true;
+}
+
+bool json_index_elements(const char* const buffer, const size_t length, size_t** const splits,
+                         size_t* const count, struct JsonError* const error) {
+    struct IndexCarry carry = { 0, 0, 0 };
+    struct IndexBlock block;
+    json_uint structural, operators, after;
+    size_t base, at, depth = 0, allocated = 0;
+    const char *reason = NULL;
+    char c;
+
+    *splits = NULL;
+    *count = 0;
+
+    at = scan_whitespace_n(buffer, length);
+    if (at >= length || buffer[at] != '[') {
+        error_construct(error, buffer, at, at >= length ? "unexpected end of input" : "expected an array");
+        return false;
+    }
+
+    for (base = 0; base < length && reason == NULL; base += 64) {
+        index_block(buffer, length, base, &carry, &block);
+        structural = block.structural;
+        operators = block.operators;
+
+        /* everything after the closing bracket is trailing */
+        if (depth == 0 && *count > 0) {
+            if (structural != 0) {
+                at = base + INDEX_CTZ(structural);
+                reason = "trailing characters after the value";
+            }
+            continue;
+        }
+
+        for (; operators != 0; operators &= operators - 1) {
+            at = base + INDEX_CTZ(operators);
+            c = buffer[at];
+
+            if (c == '[' || c == '{') {
+                if (depth++ == 0 && !index_split(splits, count, &allocated, at))
+                    reason = "out of memory";
+            } else if (c == ']' || c == '}') {
+                if (--depth > 0)
+                    continue;
+                if (c != ']' || !index_split(splits, count, &allocated, at)) {
+                    reason = c != ']' ? "unexpected character" : "out of memory";
+                    break;
+                }
+
+                after = (structural >> (at - base)) >> 1;
+                if (after != 0) {
+                    at += 1 + INDEX_CTZ(after);
+                    reason = "trailing characters after the value";
+                }
+                break;
+            } else if (c == ',' && depth == 1 && !index_split(splits, count, &allocated, at)) {
+                reason = "out of memory";
+            }
+
+            if (reason != NULL)
+                break;
+        }
+    }
+
+    if (reason == NULL && (carry.string != 0 || depth != 0)) {
+        at = length;
+        reason = carry.string != 0 ? "unterminated string" : "unexpected end of input";
+    }
+
+    if (reason != NULL) {
+        error_construct(error, buffer, at, reason);
+        free(*splits);
+        *splits = NULL;
+        *count = 0;
+        return false;
+    }
+
+    return true;
+}
+
+size_t json_index_boundary(const char* const buffer, const size_t length, const size_t least) {
+    struct IndexCarry carry = { 0, 0, 0 };
+    struct IndexBlock block;
+    json_uint blanks, brackets, before;
+    size_t base, at, depth = 0;
+    char c;
+
+    /* strings and brackets before least still have to be gone through */
+    for (base = 0; base < length; base += 64) {
+        index_block(buffer, length, base, &carry, &block);
+        blanks = base + 64 > least ? block.scan.whitespace & ~block.in_string : 0;
+        if (blanks != 0 && least > base)
+            blanks &= ~(json_uint)0 << (least - base);
+
+        /* between two brackets the depth stays the same */
+        for (brackets = block.scan.brackets & ~block.in_string;; brackets &= brackets - 1) {
+            at = brackets != 0 ? (size_t)INDEX_CTZ(brackets) : 64;
+            before = at < 64 ? ((json_uint)1 << at) - 1 : ~(json_uint)0;
+
+            if (depth == 0 && (blanks & before) != 0) {
+                at = base + INDEX_CTZ(blanks & before) + 1;
+                return at < length ? at : length;
+            }
+            if (brackets == 0)
+                break;
+
+            blanks &= ~before;
+            c = buffer[base + at];
+            if (c == '[' || c == '{')
+                ++depth;
+            else if (depth > 0)
+                --depth;
+        }
+    }
+
+    return length;
+}
+
+bool json_index_sizes(const char* const buffer, const size_t length, size_t** const sizes,
+                      size_t* const count, struct JsonError* const error) {
+    struct IndexCarry carry = { 0, 0, 0 };
+    struct IndexBlock block;
+    json_uint operators;
+    size_t base, at = 0, next, depth = 0, allocated = 0, stack_allocated = 0, *stack = NULL, *grown;
+    const char *reason = NULL;
+    char c;
+
+    *sizes = NULL;
+    *count = 0;
+
+    /* only brackets and commas matter, a container holds one more than it has commas unless it's empty */
+    for (base = 0; base < length && reason == NULL; base += 64) {
+        index_block(buffer, length, base, &carry, &block);
+        operators = block.operators;
+
+        for (; operators != 0; operators &= operators - 1) {
+            at = base + INDEX_CTZ(operators);
+            c = buffer[at];
+
+            if (c == ',' && depth > 0) {
+                ++(*sizes)[stack[depth - 1]];
+            } else if (c == ']' || c == '}') {
+                if (depth == 0) {
+                    reason = "unexpected character";
+                    break;
+                }
+                --depth;
+            } else if (c == '[' || c == '{') {
+                if (depth >= stack_allocated) {
+                    grown = realloc(stack, (stack_allocated ? stack_allocated * 2 : 64) * sizeof(size_t));
+                    if (grown == NULL) {
+                        reason = "out of memory";
+                        break;
+                    }
+                    stack = grown;
+                    stack_allocated = stack_allocated ? stack_allocated * 2 : 64;
+                }
+
+                next = at + 1 + scan_whitespace_n(buffer + at + 1, length - at - 1);
+                stack[depth++] = *count;
+                if (!index_split(sizes, count, &allocated,
+                                 next < length && (buffer[next] == ']' || buffer[next] == '}') ? 0 : 1)) {
+                    reason = "out of memory";
+                    break;
+                }
+            }
+        }
+    }
+
+    free(stack);
+
+    if (reason == NULL && (carry.string != 0 || depth != 0)) {
+        at = length;
+        reason = carry.string != 0 ? "unterminated string" : "unexpected end of input";
+    }
+
+    if (reason != NULL) {
+        error_construct(error, buffer, at, reason);
+        free(*sizes);
+        *sizes = NULL;
+        *count = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void json_index_root(const struct JsonIndex* const index, struct JsonCursor* const cursor) {
+    cursor->index = index;
+    cursor->at = 0;
+}
+
+/* the position right after the value at at, containers are skipped in one go */
+static size_t cursor_skip(const struct JsonIndex* const index, const size_t at) {
+    char c = INDEX_CHAR(index, at);
+
+    return c == '[' || c == '{' ? index->matches[at] + 1 : at + 1;
+}
+
+/* how many bytes the value at cursor may span, up to the next structural character */
+static size_t cursor_span(const struct JsonCursor* const cursor) {
+    const struct JsonIndex *index = cursor->index;
+    size_t end = cursor_skip(index, cursor->at);
+
+    if (INDEX_CHAR(index, cursor->at) == '[' || INDEX_CHAR(index, cursor->at) == '{')
+        return index->offsets[end - 1] + 1 - index->offsets[cursor->at];
+    if (end < index->count)
+        return index->offsets[end] - index->offsets[cursor->at];
+    return index->length - index->offsets[cursor->at];
+}
+
+enum ValueType json_cursor_type(const struct JsonCursor* const cursor) {
+    if (cursor->at >= cursor->index->count)
+        return 0;
+
+    switch (INDEX_CHAR(cursor->index, cursor->at)) {
+    case '{': return Object;
+    case '[': return Array;
+    case '"': return String;
+    case 'n': return Null;
+    case 't': case 'f': return Bool;
+    case '-':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+        return Number;
+    default:
+        return 0;
+    }
+}
+
+bool json_cursor_first(const struct JsonCursor* const container, struct JsonCursor* const child) {
+    const struct JsonIndex *index = container->index;
+    size_t at = container->at + 1;
+    enum ValueType type = json_cursor_type(container);
+
+    if ((type != Array && type != Object) || at == index->matches[container->at])
+        return false;
+
+    child->index = index;
+
+    if (type == Array) {
+        child->at = at;
+        return true;
+    }
+
+    /* members start with their key and a ':' */
+    if (INDEX_CHAR(index, at) != '"' || INDEX_CHAR(index, at + 1) != ':')
+        return false;
+    child->at = at + 2;
+    return true;
+}
+
+bool json_cursor_next(struct JsonCursor* const child) {
+    const struct JsonIndex *index = child->index;
+    size_t next = cursor_skip(index, child->at);
+
+    if (next >= index->count || INDEX_CHAR(index, next) != ',')
+        return false;
+
+    /* an element follows a '[' or ',', a member value its ':' */
+    if (INDEX_CHAR(index, child->at - 1) != ':') {
+        child->at = next + 1;
+        return true;
+    }
+
+    if (INDEX_CHAR(index, next + 1) != '"' || INDEX_CHAR(index, next + 2) != ':')
+        return false;
+    child->at = next + 3;
+    return true;
+}
+
+bool json_cursor_key(const struct JsonCursor* const member, const char** const key, size_t* const length) {
+    const struct JsonIndex *index = member->index;
+    size_t start, run;
+
+    if (member->at < 2 || INDEX_CHAR(index, member->at - 1) != ':')
+        return false;
+
+    /* the key is handed out as it is in the buffer, so it can't have escapes */
+    start = index->offsets[member->at - 2] + 1;
+    run = scan_string_n(index->buffer + start, index->length - start);
+    if (start + run >= index->length || index->buffer[start + run] != '"')
+        return false;
+
+    *key = index->buffer + start;
+    *length = run;
+    return true;
+}
+
+bool json_cursor_find(const struct JsonCursor* const object, const char* const key, struct JsonCursor* const out) {
+    size_t key_length = strlen(key), length;
+    const char *member_key;
+    bool found;
+
+    if (json_cursor_type(object) != Object)
+        return false;
+
+    for (found = json_cursor_first(object, out); found; found = json_cursor_next(out)) {
+        if (json_cursor_key(out, &member_key, &length) && length == key_length &&
+            memcmp(member_key, key, length) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+bool json_cursor_at(const struct JsonCursor* const array, size_t idx, struct JsonCursor* const out) {
+    if (json_cursor_type(array) != Array || !json_cursor_first(array, out))
+        return false;
+
+    for (; idx > 0; --idx) {
+        if (!json_cursor_next(out))
+            return false;
+    }
+
+    return true;
+}
+
+/* decode a number, which may only be followed by whitespace */
+static bool cursor_number(const struct JsonCursor* const cursor, struct JsonNumber* const out) {
+    const char *p;
+    size_t span, length;
+
+    if (json_cursor_type(cursor) != Number)
+        return false;
+
+    p = cursor->index->buffer + cursor->index->offsets[cursor->at];
+    span = cursor_span(cursor);
+    length = number_parse(p, span, out);
+    return length != 0 && scan_whitespace_n(p + length, span - length) == span - length;
+}
+
+bool json_cursor_number(const struct JsonCursor* const cursor, double* const out) {
+    struct JsonNumber number;
+
+    if (!cursor_number(cursor, &number))
+        return false;
+
+    *out = number.integer ? (double)number.as.integer : number.as.number;
+    return true;
+}
+
+bool json_cursor_int(const struct JsonCursor* const cursor, json_int* const out) {
+    struct JsonNumber number;
+
+    if (!cursor_number(cursor, &number) || !number.integer)
+        return false;
+
+    *out = number.as.integer;
+    return true;
+}
+
+static bool cursor_literal(const struct JsonCursor* const cursor, const char* const literal) {
+    size_t length = strlen(literal), span;
+    const char *p;
+
+    if (json_cursor_type(cursor) != Null && json_cursor_type(cursor) != Bool)
+        return false;
+
+    p = cursor->index->buffer + cursor->index->offsets[cursor->at];
+    span = cursor_span(cursor);
+    return span >= length && memcmp(p, literal, length) == 0 &&
+           scan_whitespace_n(p + length, span - length) == span - length;
+}
+
+bool json_cursor_bool(const struct JsonCursor* const cursor, bool* const out) {
+    if (cursor_literal(cursor, "true"))
+        *out = true;
+    else if (cursor_literal(cursor, "false"))
+        *out = false;
+    else
+        return false;
+
+    return true;
+}
+
+bool json_cursor_is_null(const struct JsonCursor* const cursor) {
+    return cursor_literal(cursor, "null");
+}
+
+bool json_cursor_string(const struct JsonCursor* const cursor, struct Arena* const arena,
+                        char** const out, size_t* const length) {
+    const struct JsonIndex *index = cursor->index;
+    const char *start, *end, *cur;
+    char *copy, *write;
+    size_t run, consumed = 0, written;
+
+    if (json_cursor_type(cursor) != String)
+        return false;
+
+    /* find the closing quote first, the string only gets shorter decoded */
+    start = cur = index->buffer + index->offsets[cursor->at] + 1;
+    end = index->buffer + index->length;
+    for (;;) {
+        cur += scan_string_n(cur, end - cur);
+        if (cur == end || *cur != '\\')
+            break;
+        if (end - cur < 2)
+            return false;
+        cur += 2;
+    }
+
+    if (cur == end || *cur != '"')
+        return false;
+
+    end = cur;
+    copy = write = arena_alloc(arena, end - start + 1);
+    if (copy == NULL)
+        return false;
+
+    for (cur = start; cur < end; cur += consumed + 1) {
+        run = scan_string_n(cur, end - cur);
+        if (scan_utf8_n(cur, run) != run) {
+            arena_free(arena, copy);
+            return false;
+        }
+        memcpy(write, cur, run);
+        write += run;
+        cur += run;
+        if (cur == end)
+            break;
+
+        /* a \u escape only ever decodes to fewer bytes than it takes up */
+        if (cur[1] == 'u') {
+            consumed = scan_unicode(cur + 1, end - cur - 1, write, &written);
+        } else {
+            *write = scan_escape(cur[1]);
+            consumed = *write != '\0';
+            written = 1;
+        }
+        if (consumed == 0) {
+            arena_free(arena, copy);
+            return false;
+        }
+        write += written;
+    }
+
+    *write = '\0';
+    *out = copy;
+    *length = write - copy;
+    return true;
+}
+
+struct Value *json_cursor_parse(const struct JsonCursor* const cursor, struct JsonError* const error) {
+    if (cursor->at >= cursor->index->count) {
+        error_construct(error, "", 0, "unexpected end of input");
+        return NULL;
+    }
+
+    return parse_n(cursor->index->buffer + cursor->index->offsets[cursor->at], cursor_span(cursor), error);
+}
+
+/* what the validator expects to come next */
+enum ValidateState {
+    VALIDATE_VALUE,
+    VALIDATE_VALUE_OR_CLOSE, /* right after '[' */
+    VALIDATE_KEY,
+    VALIDATE_KEY_OR_CLOSE, /* right after '{' */
+    VALIDATE_COLON,
+    VALIDATE_NEXT, /* a ',' or the closing bracket, after a value inside a container */
+    VALIDATE_DONE /* the root value is over */
+};
+
+#define VALIDATE_DIGIT(c) ((unsigned char)((c) - '0') < 10)
+
+/* the bit stack of open containers, set for objects */
+#define VALIDATE_OBJECT(objects, depth) ((objects)[((depth) - 1) / 8] >> (((depth) - 1) % 8) & 1)
+
+/* what goes wrong when the byte at hand doesn't fit state */
+static const char *validate_unexpected(const enum ValidateState state, const bool in_object) {
+    switch (state) {
+    case VALIDATE_KEY:
+    case VALIDATE_KEY_OR_CLOSE:
+        return "expected a string key";
+    case VALIDATE_COLON:
+        return "expected ':'";
+    case VALIDATE_NEXT:
+        return in_object ? "expected ',' or '}'" : "expected ',' or ']'";
+    case VALIDATE_DONE:
+        return "trailing characters after the value";
+    default:
+        return "unexpected character";
+    }
+}
+
+/* length of the number at p, 0 if it isn't one. Only the grammar is checked, nothing is decoded */
+static size_t validate_number(const char* const p, const size_t length) {
+    size_t i = 0;
+
+    if (i < length && p[i] == '-')
+        ++i;
+
+    if (i < length && p[i] == '0') {
+        if (++i < length && VALIDATE_DIGIT(p[i]))
+            return 0; /* no leading zeroes */
+    } else if (i < length && VALIDATE_DIGIT(p[i])) {
+        while (i < length && VALIDATE_DIGIT(p[i]))
+            ++i;
+    } else {
+        return 0;
+    }
+
+    if (i < length && p[i] == '.') {
+        if (++i >= length || !VALIDATE_DIGIT(p[i]))
+            return 0;
+        while (i < length && VALIDATE_DIGIT(p[i]))
+            ++i;
+    }
+
+    if (i < length && (p[i] == 'e' || p[i] == 'E')) {
+        if (++i < length && (p[i] == '-' || p[i] == '+'))
+            ++i;
+        if (i >= length || !VALIDATE_DIGIT(p[i]))
+            return 0;
+        while (i < length && VALIDATE_DIGIT(p[i]))
+            ++i;
+    }
+
+    return i;
+}
+
+/*
+ * Check the escape whose backslash is right before at. A surrogate pair is
+ * checked whole, and the escape of its low half is skipped when its turn
+ * comes.
+ */
+static bool validate_escape(const char* const buffer, const size_t length, const size_t at,
+                            size_t* const skip) {
+    char decoded[4];
+    size_t consumed, written;
+
+    if (at == *skip)
+        return true;
+
+    if (at >= length)
+        return false;
+
+    if (buffer[at] != 'u')
+        return scan_escape(buffer[at]) != '\0';
+
+    consumed = scan_unicode(buffer + at, length - at, decoded, &written);
+    if (consumed == 11)
+        *skip = at + 6;
+    return consumed != 0;
+}
+
+bool json_validate(const char* const buffer, const size_t length, struct JsonError* const error) {
+    struct IndexCarry carry = { 0, 0, 0 };
+    struct IndexBlock block;
+    enum ValidateState state = VALIDATE_VALUE;
+    unsigned char objects[(JSON_MAX_DEPTH_DEFAULT + 7) / 8];
+    json_uint valid, bits;
+    size_t base, at, utf8 = 0, skip = INDEX_NONE, depth = 0, scalar, bad;
+    const char *reason = NULL, *bad_reason = NULL;
+    char c;
+
+    for (base = 0; base < length; base += 64) {
+        index_block(buffer, length, base, &carry, &block);
+        valid = length - base >= 64 ? ~(json_uint)0 : ((json_uint)1 << (length - base)) - 1;
+        bad = INDEX_NONE;
+
+        /*
+         * First what's wrong inside strings, the earliest of it. Whatever
+         * the walk below finds before that is what gets reported. An
+         * escape the end of the input cuts off is in the block too.
+         */
+        for (bits = block.escaped & block.in_string; bits != 0; bits &= bits - 1) {
+            at = base + INDEX_CTZ(bits);
+            if (!validate_escape(buffer, length, at, &skip)) {
+                bad = at - 1;
+                bad_reason = "invalid escape";
+                break;
+            }
+        }
+
+        bits = block.scan.controls & block.in_string & valid;
+        if (bits != 0 && base + INDEX_CTZ(bits) < bad) {
+            bad = base + INDEX_CTZ(bits);
+            bad_reason = "control character in string";
+        }
+
+        /*
+         * The first byte past ascii that wasn't checked yet has the rest of
+         * the buffer checked in one go, up to the first error. Only once
+         * the blocks get there is that error reported.
+         */
+        bits = block.scan.non_ascii & valid;
+        if (utf8 >= base + 64)
+            bits = 0;
+        else if (utf8 > base)
+            bits &= ~(json_uint)0 << (utf8 - base);
+        if (bits != 0) {
+            at = base + INDEX_CTZ(bits);
+            utf8 = at + scan_utf8_n(buffer + at, length - at);
+            if (utf8 < length && utf8 < base + 64 && utf8 < bad) {
+                bad = utf8;
+                bad_reason = "invalid UTF-8";
+            }
+        }
+
+        /* then the grammar, one structural character or value at a time */
+        for (bits = block.structural & valid; bits != 0 && reason == NULL; bits &= bits - 1) {
+            at = base + INDEX_CTZ(bits);
+            if (at > bad)
+                break;
+            c = buffer[at];
+
+            switch (state) {
+            case VALIDATE_VALUE_OR_CLOSE:
+                if (c == ']') {
+                    --depth;
+                    state = depth == 0 ? VALIDATE_DONE : VALIDATE_NEXT;
+                    continue;
+                }
+                /* fall through */
+            case VALIDATE_VALUE:
+                if (c == '[' || c == '{') {
+                    if (depth >= JSON_MAX_DEPTH_DEFAULT) {
+                        reason = "nested too deeply";
+                        break;
+                    }
+                    if (c == '{')
+                        objects[depth / 8] |= 1 << depth % 8;
+                    else
+                        objects[depth / 8] &= ~(1 << depth % 8);
+                    ++depth;
+                    state = c == '{' ? VALIDATE_KEY_OR_CLOSE : VALIDATE_VALUE_OR_CLOSE;
+                    continue;
+                }
+
+                if (c == '"') {
+                    scalar = 0;
+                } else if (c == '-' || VALIDATE_DIGIT(c)) {
+                    scalar = validate_number(buffer + at, length - at);
+                    if (scalar == 0)
+                        reason = "invalid number";
+                } else if (c == 't' || c == 'f' || c == 'n') {
+                    scalar = c == 'f' ? 5 : 4;
+                    if (length - at < scalar ||
+                        memcmp(buffer + at, c == 't' ? "true" : c == 'f' ? "false" : "null", scalar) != 0)
+                        reason = "invalid literal";
+                } else {
+                    reason = "unexpected character";
+                }
+                if (reason != NULL)
+                    break;
+
+                state = depth == 0 ? VALIDATE_DONE : VALIDATE_NEXT;
+
+                /* whatever is stuck to the end of a number or literal can't come after a value */
+                at += scalar;
+                c = at < length ? buffer[at] : ' ';
+                if (scalar != 0 && c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != '"' &&
+                    c != '[' && c != ']' && c != '{' && c != '}' && c != ':' && c != ',')
+                    reason = validate_unexpected(state, depth != 0 && VALIDATE_OBJECT(objects, depth));
+                break;
+            case VALIDATE_KEY_OR_CLOSE:
+            case VALIDATE_KEY:
+                if (c == '"')
+                    state = VALIDATE_COLON;
+                else if (c == '}' && state == VALIDATE_KEY_OR_CLOSE)
+                    state = --depth == 0 ? VALIDATE_DONE : VALIDATE_NEXT;
+                else
+                    reason = validate_unexpected(state, true);
+                break;
+            case VALIDATE_COLON:
+                if (c == ':')
+                    state = VALIDATE_VALUE;
+                else
+                    reason = validate_unexpected(state, true);
+                break;
+            case VALIDATE_NEXT:
+                if (c == ',')
+                    state = VALIDATE_OBJECT(objects, depth) ? VALIDATE_KEY : VALIDATE_VALUE;
+                else if (c == (VALIDATE_OBJECT(objects, depth) ? '}' : ']'))
+                    state = --depth == 0 ? VALIDATE_DONE : VALIDATE_NEXT;
+                else
+                    reason = validate_unexpected(state, VALIDATE_OBJECT(objects, depth));
+                break;
+            case VALIDATE_DONE:
+                reason = validate_unexpected(state, false);
+                break;
+            }
+        }
+
+        if (reason != NULL) {
+            error_construct(error, buffer, at, reason);
+            return false;
+        }
+
+        if (bad != INDEX_NONE) {
+            error_construct(error, buffer, bad, bad_reason);
+            return false;
+        }
+    }
+
+    /* the end of the input, which is where the document has to end too */
+    at = length;
+    if (carry.string && carry.escape) {
+        at = length - 1;
+        reason = "invalid escape";
+    } else if (carry.string) {
+        reason = "unterminated string";
+    } else if (state == VALIDATE_VALUE || state == VALIDATE_VALUE_OR_CLOSE) {
+        reason = "unexpected end of input";
+    } else if (state != VALIDATE_DONE) {
+        reason = validate_unexpected(state, VALIDATE_OBJECT(objects, depth));
+    }
+
+    if (reason != NULL) {
+        error_construct(error, buffer, at, reason);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,138 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JSON_INDEX_H
+#define JSON_INDEX_H
+
+#include "parser.h"
+
+#include <stddef.h>
+
+/*
+ * A structural index of a document, for when only a few values out of it
+ * are needed. Building it is one vectorized pass that records where every
+ * '{', '}', '[', ']', ':', ',', string and other value starts, and which
+ * bracket closes which. Cursors then walk the index, skip whole containers
+ * in one step and only decode what they are asked for.
+ *
+ * Building checks that strings are terminated and brackets are balanced.
+ * Everything else is only checked by the cursor functions that look at it,
+ * so they can fail on a document that was indexed fine.
+ */
+struct JsonIndex {
+    const char *buffer;
+    size_t length;
+    size_t *offsets; /* where each structural character or value starts */
+    size_t *matches; /* for '{' and '[', the position of their closing bracket in offsets */
+    size_t count, allocated;
+};
+
+/* a value in an indexed document */
+struct JsonCursor {
+    const struct JsonIndex *index;
+    size_t at; /* position of the value's first byte in index->offsets */
+};
+
+/* index the first length bytes of buffer, which must outlive the index */
+bool json_index_build(struct JsonIndex* const index, const char* const buffer, const size_t length,
+                      struct JsonError* const error);
+
+void json_index_dealloc(struct JsonIndex* const index);
+
+/*
+ * A lighter pass for documents that are one big array: find only the
+ * array's brackets and the commas between its elements, so that element i
+ * lies between (*splits)[i] and (*splits)[i + 1]. *splits is malloced and
+ * holds count offsets. Like json_index_build this only checks strings and
+ * brackets, and that nothing follows the array.
+ */
+bool json_index_elements(const char* const buffer, const size_t length, size_t** const splits,
+                         size_t* const count, struct JsonError* const error);
+
+/*
+ * Where a buffer of many documents can be cut without cutting one of them:
+ * just past the first blank at or after least that is outside of every
+ * string and bracket, or length if there's none. buffer has to start
+ * between documents. Only strings and brackets are looked at, so in a
+ * broken document the cut may come anywhere.
+ */
+size_t json_index_boundary(const char* const buffer, const size_t length, const size_t least);
+
+/*
+ * Another light pass, for presizing a tree: the number of elements of every
+ * array and of pairs of every object in buffer, in the order they open.
+ * *sizes is malloced and holds count sizes. The sizes are only right for a
+ * valid document, and only strings and brackets are checked.
+ */
+bool json_index_sizes(const char* const buffer, const size_t length, size_t** const sizes,
+                      size_t* const count, struct JsonError* const error);
+
+/*
+ * Check that the first length bytes of buffer are one whole JSON document,
+ * without building anything or allocating: the full grammar, well-formed
+ * UTF-8 inside strings and valid escapes, \u ones and their surrogate pairs
+ * included. Arrays and objects may nest up to JSON_MAX_DEPTH_DEFAULT deep.
+ * Where a document fails to parse, error is filled in just like the parser
+ * would.
+ */
+bool json_validate(const char* const buffer, const size_t length, struct JsonError* const error);
+
+/* the cursor for the whole document */
+void json_index_root(const struct JsonIndex* const index, struct JsonCursor* const cursor);
+
+/* the type of the value, a Number for all numbers, 0 if it's invalid */
+enum ValueType json_cursor_type(const struct JsonCursor* const cursor);
+
+/* move child to the first element or member value of container, false if it's empty */
+bool json_cursor_first(const struct JsonCursor* const container, struct JsonCursor* const child);
+
+/* move child to the next element or member value, false after the last one */
+bool json_cursor_next(struct JsonCursor* const child);
+
+/* the key of a member value, which isn't NUL-terminated, false if the key has escapes */
+bool json_cursor_key(const struct JsonCursor* const member, const char** const key, size_t* const length);
+
+/* find the value at key in an object, or at idx in an array */
+bool json_cursor_find(const struct JsonCursor* const object, const char* const key, struct JsonCursor* const out);
+
+bool json_cursor_at(const struct JsonCursor* const array, size_t idx, struct JsonCursor* const out);
+
+/* decode a scalar, these fail if the value isn't of that type */
+bool json_cursor_number(const struct JsonCursor* const cursor, double* const out);
+
+bool json_cursor_int(const struct JsonCursor* const cursor, json_int* const out);
+
+bool json_cursor_bool(const struct JsonCursor* const cursor, bool* const out);
+
+bool json_cursor_is_null(const struct JsonCursor* const cursor);
+
+/* decode a string into a NUL-terminated copy allocated from arena, which may be NULL */
+bool json_cursor_string(const struct JsonCursor* const cursor, struct Arena* const arena,
+                        char** const out, size_t* const length);
+
+/* parse the value and everything in it into a tree, error offsets count from the value */
+struct Value *json_cursor_parse(const struct JsonCursor* const cursor, struct JsonError* const error);
+
+#endif /* JSON_INDEX_H */
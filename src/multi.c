@@ -0,0 +1,473 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* workers run on threads of their own where the system has POSIX threads */
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+# define JSON_THREADS
+# ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L
+# endif
+#endif
+
+#include "multi.h"
+#include "index.h"
+#include "scan.h"
+
+#include <stdlib.h>
+
+#ifdef JSON_THREADS
+# include <pthread.h>
+# include <unistd.h>
+# define MULTI_LOCK(run) pthread_mutex_lock(&(run)->lock)
+# define MULTI_UNLOCK(run) pthread_mutex_unlock(&(run)->lock)
+# define MULTI_WAIT(run) pthread_cond_wait(&(run)->turn, &(run)->lock)
+# define MULTI_SIGNAL(run) pthread_cond_broadcast(&(run)->turn)
+#else
+/* a single worker never has to wait for its turn */
+# define MULTI_LOCK(run) ((void)0)
+# define MULTI_UNLOCK(run) ((void)0)
+# define MULTI_WAIT(run) ((void)0)
+# define MULTI_SIGNAL(run) ((void)0)
+#endif
+
+/*
+ * Batches are numbered in input order as they are handed out. A worker
+ * parses its batch whenever it gets it, but only passes the documents on
+ * once every batch before it was passed on, which keeps them in order and
+ * the callbacks from ever overlapping.
+ */
+struct MultiRun {
+    const char *buffer;
+    size_t length, batch_size;
+    const struct JsonMultiOptions *options;
+#ifdef JSON_THREADS
+    pthread_mutex_t lock;
+    pthread_cond_t turn; /* broadcast every time a batch was passed on or cut */
+#endif
+    /* where the next batch starts and how many were handed out so far */
+    size_t next_start, batches;
+    bool cutting; /* the last batch handed out is still looking for its end, next_start isn't known */
+    /* how many batches and documents were passed on so far */
+    size_t delivered, documents;
+    bool stopped;
+    /* why and where the parse stopped, set along with stopped */
+    const char *reason;
+    size_t offset;
+};
+
+struct MultiWorker {
+    struct MultiRun *run;
+    struct JsonDocument doc; /* the arena the worker parses into */
+    /* the documents of the current batch */
+    struct MultiDocument {
+        struct Value *value;
+        size_t offset;
+    } *documents;
+    size_t count, allocated;
+};
+
+static void multi_worker_construct(struct MultiWorker* const worker, struct MultiRun* const run) {
+    worker->run = run;
+    document_construct(&worker->doc);
+    worker->documents = NULL;
+    worker->count = 0;
+    worker->allocated = 0;
+}
+
+static void multi_worker_dealloc(struct MultiWorker* const worker) {
+    document_dealloc(&worker->doc);
+    free(worker->documents);
+}
+
+/*
+ * Take the next batch, if there's any left, with run locked. It ends after
+ * the first blank between documents that is at least batch_size bytes in,
+ * so it never ends inside a document. Finding it is a quick pass over the
+ * whole batch, much cheaper than parsing it, which runs unlocked: only the
+ * next claim has to wait for it, not the workers passing batches on.
+ */
+static bool multi_claim(struct MultiRun* const run, size_t* const batch,
+                        size_t* const start, size_t* const end) {
+    while (run->cutting && !run->stopped)
+        MULTI_WAIT(run);
+
+    if (run->stopped || run->next_start >= run->length)
+        return false;
+
+    *batch = run->batches++;
+    *start = run->next_start;
+
+    if (run->length - *start <= run->batch_size) {
+        *end = run->length;
+    } else {
+        run->cutting = true;
+        MULTI_UNLOCK(run);
+        *end = *start + json_index_boundary(run->buffer + *start, run->length - *start, run->batch_size);
+        MULTI_LOCK(run);
+        run->cutting = false;
+        MULTI_SIGNAL(run);
+    }
+
+    run->next_start = *end;
+    return true;
+}
+
+/*
+ * Parse every document from start to end into the worker. On failure the
+ * documents before the invalid one are kept, and reason and offset say
+ * what went wrong.
+ */
+static bool multi_parse_batch(struct MultiWorker* const worker, size_t start, const size_t end,
+                              const char** const reason, size_t* const offset) {
+    const char *buffer = worker->run->buffer;
+    struct MultiDocument *documents;
+    struct JsonError error;
+    struct Value *value;
+    size_t allocated, consumed;
+
+    worker->count = 0;
+    start += scan_whitespace_n(buffer + start, end - start);
+
+    while (start < end) {
+        if (worker->count >= worker->allocated) {
+            allocated = worker->allocated ? worker->allocated * 2 : 64;
+            documents = realloc(worker->documents, allocated * sizeof(struct MultiDocument));
+            if (documents == NULL) {
+                *reason = "out of memory";
+                *offset = start;
+                return false;
+            }
+            worker->documents = documents;
+            worker->allocated = allocated;
+        }
+
+        value = parse_document_next(&worker->doc, buffer + start, end - start, &consumed, &error);
+        if (value == NULL) {
+            *reason = error.reason;
+            *offset = start + error.offset;
+            return false;
+        }
+
+        worker->documents[worker->count].value = value;
+        worker->documents[worker->count].offset = start;
+        ++worker->count;
+        start += consumed;
+    }
+
+    return true;
+}
+
+static void *multi_work(void *context) {
+    struct MultiWorker *worker = context;
+    struct MultiRun *run = worker->run;
+    const struct JsonMultiOptions *options = run->options;
+    size_t batch, start, end, offset = 0, i;
+    const char *reason;
+
+    MULTI_LOCK(run);
+    while (multi_claim(run, &batch, &start, &end)) {
+        MULTI_UNLOCK(run);
+
+        reason = NULL;
+        multi_parse_batch(worker, start, end, &reason, &offset);
+
+        MULTI_LOCK(run);
+        while (run->delivered != batch && !run->stopped)
+            MULTI_WAIT(run);
+        if (run->stopped)
+            break;
+        MULTI_UNLOCK(run);
+
+        /* it's this batch's turn, nobody else touches run->documents until it's passed on */
+        for (i = 0; i < worker->count && options->on_document != NULL; ++i) {
+            if (!options->on_document(options->context, run->documents++, worker->documents[i].value)) {
+                reason = "aborted by handler";
+                offset = worker->documents[i].offset;
+                break;
+            }
+        }
+
+        document_reset(&worker->doc);
+
+        MULTI_LOCK(run);
+        if (reason != NULL) {
+            run->stopped = true;
+            run->reason = reason;
+            run->offset = offset;
+        }
+        ++run->delivered;
+        MULTI_SIGNAL(run);
+    }
+    MULTI_UNLOCK(run);
+
+    return NULL;
+}
+
+/* how many workers to run, 0 asks for one per processor, and never more than most */
+static size_t multi_threads(const size_t requested, const size_t most) {
+    size_t threads = 1;
+
+#ifdef JSON_THREADS
+    long processors;
+
+    threads = requested;
+    if (threads == 0) {
+# ifdef _SC_NPROCESSORS_ONLN
+        processors = sysconf(_SC_NPROCESSORS_ONLN);
+# else
+        processors = 1;
+# endif
+        threads = processors > 0 ? (size_t)processors : 1;
+    }
+#else
+    (void)requested;
+#endif
+
+    if (threads > most)
+        threads = most;
+
+    return threads > 0 ? threads : 1;
+}
+
+bool json_multi_parse(const char* const buffer, const size_t length,
+                      const struct JsonMultiOptions* const options, struct JsonError* const error) {
+    struct MultiRun run;
+    struct MultiWorker *workers;
+    size_t threads, i;
+#ifdef JSON_THREADS
+    pthread_t *ids;
+    size_t started;
+#endif
+
+    run.buffer = buffer;
+    run.length = length;
+    run.batch_size = options->batch_size ? options->batch_size : MULTI_BATCH_SIZE_DEFAULT;
+    run.options = options;
+    run.next_start = 0;
+    run.batches = 0;
+    run.cutting = false;
+    run.delivered = 0;
+    run.documents = 0;
+    run.stopped = false;
+    run.reason = NULL;
+    run.offset = 0;
+
+    threads = multi_threads(options->threads, length / run.batch_size + 1);
+    workers = malloc(threads * sizeof(struct MultiWorker));
+    if (workers == NULL) {
+        error_construct(error, "", 0, "out of memory");
+        return false;
+    }
+
+    for (i = 0; i < threads; ++i)
+        multi_worker_construct(&workers[i], &run);
+
+#ifdef JSON_THREADS
+    ids = malloc(threads * sizeof(pthread_t));
+    pthread_mutex_init(&run.lock, NULL);
+    pthread_cond_init(&run.turn, NULL);
+
+    /*
+     * The calling thread is a worker as well. A thread that can't be
+     * started only leaves more batches to the workers that were.
+     */
+    started = 1;
+    while (ids != NULL && started < threads &&
+           pthread_create(&ids[started], NULL, multi_work, &workers[started]) == 0)
+        ++started;
+
+    multi_work(&workers[0]);
+
+    for (i = 1; i < started; ++i)
+        pthread_join(ids[i], NULL);
+
+    pthread_cond_destroy(&run.turn);
+    pthread_mutex_destroy(&run.lock);
+    free(ids);
+#else
+    multi_work(&workers[0]);
+#endif
+
+    for (i = 0; i < threads; ++i)
+        multi_worker_dealloc(&workers[i]);
+    free(workers);
+
+    if (run.stopped) {
+        error_construct(error, buffer, run.offset, run.reason);
+        return false;
+    }
+
+    return true;
+}
+
+bool json_multi_parse_file(char* const filename, const struct JsonMultiOptions* const options,
+                           struct JsonError* const error) {
+    bool parsed;
+    size_t length;
+    char *buffer = map_file(filename, &length, error);
+
+    if (buffer == NULL)
+        return false;
+
+    parsed = json_multi_parse(buffer, length, options, error);
+
+    unmap_file(buffer, length);
+    return parsed;
+}
+
+/*
+ * The elements of a big array are parsed in chunks of consecutive ones,
+ * each straight into its place in the array.
+ */
+struct ParallelRun {
+    const char *buffer;
+    const size_t *splits; /* element i lies between splits[i] and splits[i + 1] */
+    size_t elements, chunk;
+    struct Value *values;
+#ifdef JSON_THREADS
+    pthread_mutex_t lock;
+#endif
+    size_t next; /* the first element not handed out yet */
+    bool failed;
+};
+
+static void *parallel_work(void *context) {
+    struct ParallelRun *run = context;
+    struct Value *value;
+    size_t first, last, start;
+
+    for (;;) {
+        MULTI_LOCK(run);
+        first = run->next;
+        last = run->failed || run->elements - first <= run->chunk ? run->elements : first + run->chunk;
+        if (run->failed)
+            first = last;
+        run->next = last;
+        MULTI_UNLOCK(run);
+
+        if (first == last)
+            return NULL;
+
+        for (; first < last; ++first) {
+            /* elements are one level down, inside the array */
+            start = run->splits[first] + 1;
+            value = parse_n_depth(run->buffer + start, run->splits[first + 1] - start,
+                                  JSON_MAX_DEPTH_DEFAULT - 1, NULL);
+
+            if (value == NULL) {
+                MULTI_LOCK(run);
+                run->failed = true;
+                MULTI_UNLOCK(run);
+                return NULL;
+            }
+
+            run->values[first] = *value;
+            free(value);
+        }
+    }
+}
+
+struct Value *json_parse_parallel(const char* const buffer, const size_t length,
+                                  const size_t threads, struct JsonError* const error) {
+    struct ParallelRun run;
+    struct Value *root;
+    struct Array *array;
+    size_t *splits, count, workers, i;
+#ifdef JSON_THREADS
+    pthread_t *ids;
+    size_t started;
+#endif
+
+    /* the serial parser has a better idea of what's wrong with a broken document */
+    if (!json_index_elements(buffer, length, &splits, &count, NULL))
+        return parse_n(buffer, length, error);
+
+    run.buffer = buffer;
+    run.splits = splits;
+    run.elements = count - 1;
+    run.next = 0;
+    run.failed = false;
+
+    /* a lone blank between the brackets is an empty array rather than a missing element */
+    if (run.elements == 1 && scan_whitespace_n(buffer + splits[0] + 1, splits[1] - splits[0] - 1) ==
+                             splits[1] - splits[0] - 1)
+        run.elements = 0;
+
+    root = malloc(sizeof(struct Value));
+    array = malloc(sizeof(struct Array));
+    if (array != NULL)
+        array_construct(array);
+
+    /* the array is sized up front, workers only ever write their own elements */
+    if (root == NULL || array == NULL || !array_reserve(array, run.elements)) {
+        free(splits);
+        free(root);
+        if (array != NULL)
+            array_dealloc(array);
+        error_construct(error, buffer, 0, "out of memory");
+        return NULL;
+    }
+
+    run.values = array->arr_dump;
+    array->written = run.elements;
+    VALUE_SET_ARRAY(root, array);
+
+    for (i = 0; i < run.elements; ++i)
+        VALUE_SET_NULL(&run.values[i]);
+
+    workers = multi_threads(threads, run.elements);
+    /* chunks small enough that workers finishing early can help with the rest */
+    run.chunk = run.elements / (workers * 16) + 1;
+
+#ifdef JSON_THREADS
+    ids = malloc(workers * sizeof(pthread_t));
+    pthread_mutex_init(&run.lock, NULL);
+
+    started = 1;
+    while (ids != NULL && started < workers &&
+           pthread_create(&ids[started], NULL, parallel_work, &run) == 0)
+        ++started;
+
+    parallel_work(&run);
+
+    for (i = 1; i < started; ++i)
+        pthread_join(ids[i], NULL);
+
+    pthread_mutex_destroy(&run.lock);
+    free(ids);
+#else
+    (void)workers;
+    parallel_work(&run);
+#endif
+
+    free(splits);
+
+    if (run.failed) {
+        value_dealloc(root);
+        return parse_n(buffer, length, error);
+    }
+
+    return root;
+}
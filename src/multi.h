@@ -0,0 +1,79 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JSON_MULTI_H
+#define JSON_MULTI_H
+
+#include "parser.h"
+
+#include <stddef.h>
+
+/* bytes of input a worker takes at a time */
+#define MULTI_BATCH_SIZE_DEFAULT (1024 * 1024)
+
+/*
+ * Parsing of many documents in one buffer, as in JSON Lines or log files:
+ * documents separated by whitespace, or by nothing where the end of one is
+ * unambiguous. The buffer is cut into batches of about batch_size bytes
+ * between documents, and a pool of worker threads parses the batches, each
+ * into an arena of its own. Documents may span any number of lines.
+ */
+struct JsonMultiOptions {
+    void *context; /* passed to on_document */
+    /*
+     * Called for every document, in input order and never for two documents
+     * at once, index counts the documents from 0. value lives in an arena
+     * that is reset after the call, so anything to be kept must be copied
+     * out. Returning false stops the parse.
+     */
+    bool (*on_document)(void *context, size_t index, struct Value *value);
+    size_t threads; /* workers, 0 for one per processor */
+    size_t batch_size; /* 0 for MULTI_BATCH_SIZE_DEFAULT */
+};
+
+/*
+ * Parse every document in the first length bytes of buffer, which isn't
+ * modified. Parsing stops at the first invalid document, after which error
+ * says where in buffer it is; the documents before it were all passed to
+ * on_document.
+ */
+bool json_multi_parse(const char* const buffer, const size_t length,
+                      const struct JsonMultiOptions* const options, struct JsonError* const error);
+
+/* map filename into memory and parse every document in it */
+bool json_multi_parse_file(char* const filename, const struct JsonMultiOptions* const options,
+                           struct JsonError* const error);
+
+/*
+ * Parse the first length bytes of buffer, which hold one big array, with
+ * its elements parsed in parallel by threads workers (0 for one per
+ * processor). A quick pass over the buffer finds the commas between the
+ * elements first, so the workers know where to start. The tree is the same
+ * parse_n builds, and so are the errors.
+ */
+struct Value *json_parse_parallel(const char* const buffer, const size_t length,
+                                  const size_t threads, struct JsonError* const error);
+
+#endif /* JSON_MULTI_H */
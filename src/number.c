@@ -0,0 +1,1270 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "number.h"
+
+#include <float.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define IS_DIGIT(c) ((unsigned)((c) - '0') < 10)
+/* the byte at cur, or '\0' past the end. comparing offsets can't overflow */
+#define IN_BOUNDS(cur) ((size_t)((cur) - p) < length)
+#define PEEK(cur) (IN_BOUNDS(cur) ? *(cur) : '\0')
+
+/* json_uint constants out of two 32-bit halves, C89 has no 64-bit literals */
+#define U64(hi, lo) (((json_uint)(hi) << 32) | (json_uint)(lo))
+
+/* at most this many significant digits are kept, any more are truncated */
+#define NUMBER_MAX_DIGITS 19
+
+/*
+ * Whether double arithmetic rounds to double rather than to the x87's wider
+ * format. C89's float.h doesn't say, but the compiler usually does.
+ */
+#if defined(FLT_EVAL_METHOD)
+# define NUMBER_EVAL_METHOD FLT_EVAL_METHOD
+#elif defined(__FLT_EVAL_METHOD__)
+# define NUMBER_EVAL_METHOD __FLT_EVAL_METHOD__
+#elif defined(_M_IX86) && (!defined(_M_IX86_FP) || _M_IX86_FP < 2)
+# define NUMBER_EVAL_METHOD 2
+#else
+# define NUMBER_EVAL_METHOD 0
+#endif
+
+#define POWER_OF_FIVE_MIN (-342)
+#define POWER_OF_FIVE_MAX 308
+
+/* powers of ten a double holds exactly */
+static const double exact_powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/*
+ * 5^q for every q from POWER_OF_FIVE_MIN to POWER_OF_FIVE_MAX, normalized
+ * to a 128-bit mantissa (high word first). Negative powers are rounded up,
+ * positive ones truncated.
+ */
+static const json_uint powers_of_five[] = {
+    U64(0xeef453d6UL, 0x923bd65aUL), U64(0x113faa29UL, 0x06a13b3fUL),
+    U64(0x9558b466UL, 0x1b6565f8UL), U64(0x4ac7ca59UL, 0xa424c507UL),
+    U64(0xbaaee17fUL, 0xa23ebf76UL), U64(0x5d79bcf0UL, 0x0d2df649UL),
+    U64(0xe95a99dfUL, 0x8ace6f53UL), U64(0xf4d82c2cUL, 0x107973dcUL),
+    U64(0x91d8a02bUL, 0xb6c10594UL), U64(0x79071b9bUL, 0x8a4be869UL),
+    U64(0xb64ec836UL, 0xa47146f9UL), U64(0x9748e282UL, 0x6cdee284UL),
+    U64(0xe3e27a44UL, 0x4d8d98b7UL), U64(0xfd1b1b23UL, 0x08169b25UL),
+    U64(0x8e6d8c6aUL, 0xb0787f72UL), U64(0xfe30f0f5UL, 0xe50e20f7UL),
+    U64(0xb208ef85UL, 0x5c969f4fUL), U64(0xbdbd2d33UL, 0x5e51a935UL),
+    U64(0xde8b2b66UL, 0xb3bc4723UL), U64(0xad2c7880UL, 0x35e61382UL),
+    U64(0x8b16fb20UL, 0x3055ac76UL), U64(0x4c3bcb50UL, 0x21afcc31UL),
+    U64(0xaddcb9e8UL, 0x3c6b1793UL), U64(0xdf4abe24UL, 0x2a1bbf3dUL),
+    U64(0xd953e862UL, 0x4b85dd78UL), U64(0xd71d6dadUL, 0x34a2af0dUL),
+    U64(0x87d4713dUL, 0x6f33aa6bUL), U64(0x8672648cUL, 0x40e5ad68UL),
+    U64(0xa9c98d8cUL, 0xcb009506UL), U64(0x680efdafUL, 0x511f18c2UL),
+    U64(0xd43bf0efUL, 0xfdc0ba48UL), U64(0x0212bd1bUL, 0x2566def2UL),
+    U64(0x84a57695UL, 0xfe98746dUL), U64(0x014bb630UL, 0xf7604b57UL),
+    U64(0xa5ced43bUL, 0x7e3e9188UL), U64(0x419ea3bdUL, 0x35385e2dUL),
+    U64(0xcf42894aUL, 0x5dce35eaUL), U64(0x52064cacUL, 0x828675b9UL),
+    U64(0x818995ceUL, 0x7aa0e1b2UL), U64(0x7343efebUL, 0xd1940993UL),
+    U64(0xa1ebfb42UL, 0x19491a1fUL), U64(0x1014ebe6UL, 0xc5f90bf8UL),
+    U64(0xca66fa12UL, 0x9f9b60a6UL), U64(0xd41a26e0UL, 0x77774ef6UL),
+    U64(0xfd00b897UL, 0x478238d0UL), U64(0x8920b098UL, 0x955522b4UL),
+    U64(0x9e20735eUL, 0x8cb16382UL), U64(0x55b46e5fUL, 0x5d5535b0UL),
+    U64(0xc5a89036UL, 0x2fddbc62UL), U64(0xeb2189f7UL, 0x34aa831dUL),
+    U64(0xf712b443UL, 0xbbd52b7bUL), U64(0xa5e9ec75UL, 0x01d523e4UL),
+    U64(0x9a6bb0aaUL, 0x55653b2dUL), U64(0x47b233c9UL, 0x2125366eUL),
+    U64(0xc1069cd4UL, 0xeabe89f8UL), U64(0x999ec0bbUL, 0x696e840aUL),
+    U64(0xf148440aUL, 0x256e2c76UL), U64(0xc00670eaUL, 0x43ca250dUL),
+    U64(0x96cd2a86UL, 0x5764dbcaUL), U64(0x38040692UL, 0x6a5e5728UL),
+    U64(0xbc807527UL, 0xed3e12bcUL), U64(0xc6050837UL, 0x04f5ecf2UL),
+    U64(0xeba09271UL, 0xe88d976bUL), U64(0xf7864a44UL, 0xc633682eUL),
+    U64(0x93445b87UL, 0x31587ea3UL), U64(0x7ab3ee6aUL, 0xfbe0211dUL),
+    U64(0xb8157268UL, 0xfdae9e4cUL), U64(0x5960ea05UL, 0xbad82964UL),
+    U64(0xe61acf03UL, 0x3d1a45dfUL), U64(0x6fb92487UL, 0x298e33bdUL),
+    U64(0x8fd0c162UL, 0x06306babUL), U64(0xa5d3b6d4UL, 0x79f8e056UL),
+    U64(0xb3c4f1baUL, 0x87bc8696UL), U64(0x8f48a489UL, 0x9877186cUL),
+    U64(0xe0b62e29UL, 0x29aba83cUL), U64(0x331acdabUL, 0xfe94de87UL),
+    U64(0x8c71dcd9UL, 0xba0b4925UL), U64(0x9ff0c08bUL, 0x7f1d0b14UL),
+    U64(0xaf8e5410UL, 0x288e1b6fUL), U64(0x07ecf0aeUL, 0x5ee44dd9UL),
+    U64(0xdb71e914UL, 0x32b1a24aUL), U64(0xc9e82cd9UL, 0xf69d6150UL),
+    U64(0x892731acUL, 0x9faf056eUL), U64(0xbe311c08UL, 0x3a225cd2UL),
+    U64(0xab70fe17UL, 0xc79ac6caUL), U64(0x6dbd630aUL, 0x48aaf406UL),
+    U64(0xd64d3d9dUL, 0xb981787dUL), U64(0x092cbbccUL, 0xdad5b108UL),
+    U64(0x85f04682UL, 0x93f0eb4eUL), U64(0x25bbf560UL, 0x08c58ea5UL),
+    U64(0xa76c5823UL, 0x38ed2621UL), U64(0xaf2af2b8UL, 0x0af6f24eUL),
+    U64(0xd1476e2cUL, 0x07286faaUL), U64(0x1af5af66UL, 0x0db4aee1UL),
+    U64(0x82cca4dbUL, 0x847945caUL), U64(0x50d98d9fUL, 0xc890ed4dUL),
+    U64(0xa37fce12UL, 0x6597973cUL), U64(0xe50ff107UL, 0xbab528a0UL),
+    U64(0xcc5fc196UL, 0xfefd7d0cUL), U64(0x1e53ed49UL, 0xa96272c8UL),
+    U64(0xff77b1fcUL, 0xbebcdc4fUL), U64(0x25e8e89cUL, 0x13bb0f7aUL),
+    U64(0x9faacf3dUL, 0xf73609b1UL), U64(0x77b19161UL, 0x8c54e9acUL),
+    U64(0xc795830dUL, 0x75038c1dUL), U64(0xd59df5b9UL, 0xef6a2417UL),
+    U64(0xf97ae3d0UL, 0xd2446f25UL), U64(0x4b057328UL, 0x6b44ad1dUL),
+    U64(0x9becce62UL, 0x836ac577UL), U64(0x4ee367f9UL, 0x430aec32UL),
+    U64(0xc2e801fbUL, 0x244576d5UL), U64(0x229c41f7UL, 0x93cda73fUL),
+    U64(0xf3a20279UL, 0xed56d48aUL), U64(0x6b435275UL, 0x78c1110fUL),
+    U64(0x9845418cUL, 0x345644d6UL), U64(0x830a1389UL, 0x6b78aaa9UL),
+    U64(0xbe5691efUL, 0x416bd60cUL), U64(0x23cc986bUL, 0xc656d553UL),
+    U64(0xedec366bUL, 0x11c6cb8fUL), U64(0x2cbfbe86UL, 0xb7ec8aa8UL),
+    U64(0x94b3a202UL, 0xeb1c3f39UL), U64(0x7bf7d714UL, 0x32f3d6a9UL),
+    U64(0xb9e08a83UL, 0xa5e34f07UL), U64(0xdaf5ccd9UL, 0x3fb0cc53UL),
+    U64(0xe858ad24UL, 0x8f5c22c9UL), U64(0xd1b3400fUL, 0x8f9cff68UL),
+    U64(0x91376c36UL, 0xd99995beUL), U64(0x23100809UL, 0xb9c21fa1UL),
+    U64(0xb5854744UL, 0x8ffffb2dUL), U64(0xabd40a0cUL, 0x2832a78aUL),
+    U64(0xe2e69915UL, 0xb3fff9f9UL), U64(0x16c90c8fUL, 0x323f516cUL),
+    U64(0x8dd01fadUL, 0x907ffc3bUL), U64(0xae3da7d9UL, 0x7f6792e3UL),
+    U64(0xb1442798UL, 0xf49ffb4aUL), U64(0x99cd11cfUL, 0xdf41779cUL),
+    U64(0xdd95317fUL, 0x31c7fa1dUL), U64(0x40405643UL, 0xd711d583UL),
+    U64(0x8a7d3eefUL, 0x7f1cfc52UL), U64(0x482835eaUL, 0x666b2572UL),
+    U64(0xad1c8eabUL, 0x5ee43b66UL), U64(0xda324365UL, 0x0005eecfUL),
+    U64(0xd863b256UL, 0x369d4a40UL), U64(0x90bed43eUL, 0x40076a82UL),
+    U64(0x873e4f75UL, 0xe2224e68UL), U64(0x5a7744a6UL, 0xe804a291UL),
+    U64(0xa90de353UL, 0x5aaae202UL), U64(0x711515d0UL, 0xa205cb36UL),
+    U64(0xd3515c28UL, 0x31559a83UL), U64(0x0d5a5b44UL, 0xca873e03UL),
+    U64(0x8412d999UL, 0x1ed58091UL), U64(0xe858790aUL, 0xfe9486c2UL),
+    U64(0xa5178fffUL, 0x668ae0b6UL), U64(0x626e974dUL, 0xbe39a872UL),
+    U64(0xce5d73ffUL, 0x402d98e3UL), U64(0xfb0a3d21UL, 0x2dc8128fUL),
+    U64(0x80fa687fUL, 0x881c7f8eUL), U64(0x7ce66634UL, 0xbc9d0b99UL),
+    U64(0xa139029fUL, 0x6a239f72UL), U64(0x1c1fffc1UL, 0xebc44e80UL),
+    U64(0xc9874347UL, 0x44ac874eUL), U64(0xa327ffb2UL, 0x66b56220UL),
+    U64(0xfbe91419UL, 0x15d7a922UL), U64(0x4bf1ff9fUL, 0x0062baa8UL),
+    U64(0x9d71ac8fUL, 0xada6c9b5UL), U64(0x6f773fc3UL, 0x603db4a9UL),
+    U64(0xc4ce17b3UL, 0x99107c22UL), U64(0xcb550fb4UL, 0x384d21d3UL),
+    U64(0xf6019da0UL, 0x7f549b2bUL), U64(0x7e2a53a1UL, 0x46606a48UL),
+    U64(0x99c10284UL, 0x4f94e0fbUL), U64(0x2eda7444UL, 0xcbfc426dUL),
+    U64(0xc0314325UL, 0x637a1939UL), U64(0xfa911155UL, 0xfefb5308UL),
+    U64(0xf03d93eeUL, 0xbc589f88UL), U64(0x793555abUL, 0x7eba27caUL),
+    U64(0x96267c75UL, 0x35b763b5UL), U64(0x4bc1558bUL, 0x2f3458deUL),
+    U64(0xbbb01b92UL, 0x83253ca2UL), U64(0x9eb1aaedUL, 0xfb016f16UL),
+    U64(0xea9c2277UL, 0x23ee8bcbUL), U64(0x465e15a9UL, 0x79c1cadcUL),
+    U64(0x92a1958aUL, 0x7675175fUL), U64(0x0bfacd89UL, 0xec191ec9UL),
+    U64(0xb749faedUL, 0x14125d36UL), U64(0xcef980ecUL, 0x671f667bUL),
+    U64(0xe51c79a8UL, 0x5916f484UL), U64(0x82b7e127UL, 0x80e7401aUL),
+    U64(0x8f31cc09UL, 0x37ae58d2UL), U64(0xd1b2ecb8UL, 0xb0908810UL),
+    U64(0xb2fe3f0bUL, 0x8599ef07UL), U64(0x861fa7e6UL, 0xdcb4aa15UL),
+    U64(0xdfbdceceUL, 0x67006ac9UL), U64(0x67a791e0UL, 0x93e1d49aUL),
+    U64(0x8bd6a141UL, 0x006042bdUL), U64(0xe0c8bb2cUL, 0x5c6d24e0UL),
+    U64(0xaecc4991UL, 0x4078536dUL), U64(0x58fae9f7UL, 0x73886e18UL),
+    U64(0xda7f5bf5UL, 0x90966848UL), U64(0xaf39a475UL, 0x506a899eUL),
+    U64(0x888f9979UL, 0x7a5e012dUL), U64(0x6d8406c9UL, 0x52429603UL),
+    U64(0xaab37fd7UL, 0xd8f58178UL), U64(0xc8e5087bUL, 0xa6d33b83UL),
+    U64(0xd5605fcdUL, 0xcf32e1d6UL), U64(0xfb1e4a9aUL, 0x90880a64UL),
+    U64(0x855c3be0UL, 0xa17fcd26UL), U64(0x5cf2eea0UL, 0x9a55067fUL),
+    U64(0xa6b34ad8UL, 0xc9dfc06fUL), U64(0xf42faa48UL, 0xc0ea481eUL),
+    U64(0xd0601d8eUL, 0xfc57b08bUL), U64(0xf13b94daUL, 0xf124da26UL),
+    U64(0x823c1279UL, 0x5db6ce57UL), U64(0x76c53d08UL, 0xd6b70858UL),
+    U64(0xa2cb1717UL, 0xb52481edUL), U64(0x54768c4bUL, 0x0c64ca6eUL),
+    U64(0xcb7ddcddUL, 0xa26da268UL), U64(0xa9942f5dUL, 0xcf7dfd09UL),
+    U64(0xfe5d5415UL, 0x0b090b02UL), U64(0xd3f93b35UL, 0x435d7c4cUL),
+    U64(0x9efa548dUL, 0x26e5a6e1UL), U64(0xc47bc501UL, 0x4a1a6dafUL),
+    U64(0xc6b8e9b0UL, 0x709f109aUL), U64(0x359ab641UL, 0x9ca1091bUL),
+    U64(0xf867241cUL, 0x8cc6d4c0UL), U64(0xc30163d2UL, 0x03c94b62UL),
+    U64(0x9b407691UL, 0xd7fc44f8UL), U64(0x79e0de63UL, 0x425dcf1dUL),
+    U64(0xc2109436UL, 0x4dfb5636UL), U64(0x985915fcUL, 0x12f542e4UL),
+    U64(0xf294b943UL, 0xe17a2bc4UL), U64(0x3e6f5b7bUL, 0x17b2939dUL),
+    U64(0x979cf3caUL, 0x6cec5b5aUL), U64(0xa705992cUL, 0xeecf9c42UL),
+    U64(0xbd8430bdUL, 0x08277231UL), U64(0x50c6ff78UL, 0x2a838353UL),
+    U64(0xece53cecUL, 0x4a314ebdUL), U64(0xa4f8bf56UL, 0x35246428UL),
+    U64(0x940f4613UL, 0xae5ed136UL), U64(0x871b7795UL, 0xe136be99UL),
+    U64(0xb9131798UL, 0x99f68584UL), U64(0x28e2557bUL, 0x59846e3fUL),
+    U64(0xe757dd7eUL, 0xc07426e5UL), U64(0x331aeadaUL, 0x2fe589cfUL),
+    U64(0x9096ea6fUL, 0x3848984fUL), U64(0x3ff0d2c8UL, 0x5def7621UL),
+    U64(0xb4bca50bUL, 0x065abe63UL), U64(0x0fed077aUL, 0x756b53a9UL),
+    U64(0xe1ebce4dUL, 0xc7f16dfbUL), U64(0xd3e84959UL, 0x12c62894UL),
+    U64(0x8d3360f0UL, 0x9cf6e4bdUL), U64(0x64712dd7UL, 0xabbbd95cUL),
+    U64(0xb080392cUL, 0xc4349decUL), U64(0xbd8d794dUL, 0x96aacfb3UL),
+    U64(0xdca04777UL, 0xf541c567UL), U64(0xecf0d7a0UL, 0xfc5583a0UL),
+    U64(0x89e42caaUL, 0xf9491b60UL), U64(0xf41686c4UL, 0x9db57244UL),
+    U64(0xac5d37d5UL, 0xb79b6239UL), U64(0x311c2875UL, 0xc522ced5UL),
+    U64(0xd77485cbUL, 0x25823ac7UL), U64(0x7d633293UL, 0x366b828bUL),
+    U64(0x86a8d39eUL, 0xf77164bcUL), U64(0xae5dff9cUL, 0x02033197UL),
+    U64(0xa8530886UL, 0xb54dbdebUL), U64(0xd9f57f83UL, 0x0283fdfcUL),
+    U64(0xd267caa8UL, 0x62a12d66UL), U64(0xd072df63UL, 0xc324fd7bUL),
+    U64(0x8380dea9UL, 0x3da4bc60UL), U64(0x4247cb9eUL, 0x59f71e6dUL),
+    U64(0xa4611653UL, 0x8d0deb78UL), U64(0x52d9be85UL, 0xf074e608UL),
+    U64(0xcd795be8UL, 0x70516656UL), U64(0x67902e27UL, 0x6c921f8bUL),
+    U64(0x806bd971UL, 0x4632dff6UL), U64(0x00ba1cd8UL, 0xa3db53b6UL),
+    U64(0xa086cfcdUL, 0x97bf97f3UL), U64(0x80e8a40eUL, 0xccd228a4UL),
+    U64(0xc8a883c0UL, 0xfdaf7df0UL), U64(0x6122cd12UL, 0x8006b2cdUL),
+    U64(0xfad2a4b1UL, 0x3d1b5d6cUL), U64(0x796b8057UL, 0x20085f81UL),
+    U64(0x9cc3a6eeUL, 0xc6311a63UL), U64(0xcbe33036UL, 0x74053bb0UL),
+    U64(0xc3f490aaUL, 0x77bd60fcUL), U64(0xbedbfc44UL, 0x11068a9cUL),
+    U64(0xf4f1b4d5UL, 0x15acb93bUL), U64(0xee92fb55UL, 0x15482d44UL),
+    U64(0x99171105UL, 0x2d8bf3c5UL), U64(0x751bdd15UL, 0x2d4d1c4aUL),
+    U64(0xbf5cd546UL, 0x78eef0b6UL), U64(0xd262d45aUL, 0x78a0635dUL),
+    U64(0xef340a98UL, 0x172aace4UL), U64(0x86fb8971UL, 0x16c87c34UL),
+    U64(0x9580869fUL, 0x0e7aac0eUL), U64(0xd45d35e6UL, 0xae3d4da0UL),
+    U64(0xbae0a846UL, 0xd2195712UL), U64(0x89748360UL, 0x59cca109UL),
+    U64(0xe998d258UL, 0x869facd7UL), U64(0x2bd1a438UL, 0x703fc94bUL),
+    U64(0x91ff8377UL, 0x5423cc06UL), U64(0x7b6306a3UL, 0x4627ddcfUL),
+    U64(0xb67f6455UL, 0x292cbf08UL), U64(0x1a3bc84cUL, 0x17b1d542UL),
+    U64(0xe41f3d6aUL, 0x7377eecaUL), U64(0x20caba5fUL, 0x1d9e4a93UL),
+    U64(0x8e938662UL, 0x882af53eUL), U64(0x547eb47bUL, 0x7282ee9cUL),
+    U64(0xb23867fbUL, 0x2a35b28dUL), U64(0xe99e619aUL, 0x4f23aa43UL),
+    U64(0xdec681f9UL, 0xf4c31f31UL), U64(0x6405fa00UL, 0xe2ec94d4UL),
+    U64(0x8b3c113cUL, 0x38f9f37eUL), U64(0xde83bc40UL, 0x8dd3dd04UL),
+    U64(0xae0b158bUL, 0x4738705eUL), U64(0x9624ab50UL, 0xb148d445UL),
+    U64(0xd98ddaeeUL, 0x19068c76UL), U64(0x3badd624UL, 0xdd9b0957UL),
+    U64(0x87f8a8d4UL, 0xcfa417c9UL), U64(0xe54ca5d7UL, 0x0a80e5d6UL),
+    U64(0xa9f6d30aUL, 0x038d1dbcUL), U64(0x5e9fcf4cUL, 0xcd211f4cUL),
+    U64(0xd47487ccUL, 0x8470652bUL), U64(0x7647c320UL, 0x0069671fUL),
+    U64(0x84c8d4dfUL, 0xd2c63f3bUL), U64(0x29ecd9f4UL, 0x0041e073UL),
+    U64(0xa5fb0a17UL, 0xc777cf09UL), U64(0xf4681071UL, 0x00525890UL),
+    U64(0xcf79cc9dUL, 0xb955c2ccUL), U64(0x7182148dUL, 0x4066eeb4UL),
+    U64(0x81ac1fe2UL, 0x93d599bfUL), U64(0xc6f14cd8UL, 0x48405530UL),
+    U64(0xa21727dbUL, 0x38cb002fUL), U64(0xb8ada00eUL, 0x5a506a7cUL),
+    U64(0xca9cf1d2UL, 0x06fdc03bUL), U64(0xa6d90811UL, 0xf0e4851cUL),
+    U64(0xfd442e46UL, 0x88bd304aUL), U64(0x908f4a16UL, 0x6d1da663UL),
+    U64(0x9e4a9cecUL, 0x15763e2eUL), U64(0x9a598e4eUL, 0x043287feUL),
+    U64(0xc5dd4427UL, 0x1ad3cdbaUL), U64(0x40eff1e1UL, 0x853f29fdUL),
+    U64(0xf7549530UL, 0xe188c128UL), U64(0xd12bee59UL, 0xe68ef47cUL),
+    U64(0x9a94dd3eUL, 0x8cf578b9UL), U64(0x82bb74f8UL, 0x301958ceUL),
+    U64(0xc13a148eUL, 0x3032d6e7UL), U64(0xe36a5236UL, 0x3c1faf01UL),
+    U64(0xf18899b1UL, 0xbc3f8ca1UL), U64(0xdc44e6c3UL, 0xcb279ac1UL),
+    U64(0x96f5600fUL, 0x15a7b7e5UL), U64(0x29ab103aUL, 0x5ef8c0b9UL),
+    U64(0xbcb2b812UL, 0xdb11a5deUL), U64(0x7415d448UL, 0xf6b6f0e7UL),
+    U64(0xebdf6617UL, 0x91d60f56UL), U64(0x111b495bUL, 0x3464ad21UL),
+    U64(0x936b9fceUL, 0xbb25c995UL), U64(0xcab10dd9UL, 0x00beec34UL),
+    U64(0xb84687c2UL, 0x69ef3bfbUL), U64(0x3d5d514fUL, 0x40eea742UL),
+    U64(0xe65829b3UL, 0x046b0afaUL), U64(0x0cb4a5a3UL, 0x112a5112UL),
+    U64(0x8ff71a0fUL, 0xe2c2e6dcUL), U64(0x47f0e785UL, 0xeaba72abUL),
+    U64(0xb3f4e093UL, 0xdb73a093UL), U64(0x59ed2167UL, 0x65690f56UL),
+    U64(0xe0f218b8UL, 0xd25088b8UL), U64(0x306869c1UL, 0x3ec3532cUL),
+    U64(0x8c974f73UL, 0x83725573UL), U64(0x1e414218UL, 0xc73a13fbUL),
+    U64(0xafbd2350UL, 0x644eeacfUL), U64(0xe5d1929eUL, 0xf90898faUL),
+    U64(0xdbac6c24UL, 0x7d62a583UL), U64(0xdf45f746UL, 0xb74abf39UL),
+    U64(0x894bc396UL, 0xce5da772UL), U64(0x6b8bba8cUL, 0x328eb783UL),
+    U64(0xab9eb47cUL, 0x81f5114fUL), U64(0x066ea92fUL, 0x3f326564UL),
+    U64(0xd686619bUL, 0xa27255a2UL), U64(0xc80a537bUL, 0x0efefebdUL),
+    U64(0x8613fd01UL, 0x45877585UL), U64(0xbd06742cUL, 0xe95f5f36UL),
+    U64(0xa798fc41UL, 0x96e952e7UL), U64(0x2c481138UL, 0x23b73704UL),
+    U64(0xd17f3b51UL, 0xfca3a7a0UL), U64(0xf75a1586UL, 0x2ca504c5UL),
+    U64(0x82ef8513UL, 0x3de648c4UL), U64(0x9a984d73UL, 0xdbe722fbUL),
+    U64(0xa3ab6658UL, 0x0d5fdaf5UL), U64(0xc13e60d0UL, 0xd2e0ebbaUL),
+    U64(0xcc963feeUL, 0x10b7d1b3UL), U64(0x318df905UL, 0x079926a8UL),
+    U64(0xffbbcfe9UL, 0x94e5c61fUL), U64(0xfdf17746UL, 0x497f7052UL),
+    U64(0x9fd561f1UL, 0xfd0f9bd3UL), U64(0xfeb6ea8bUL, 0xedefa633UL),
+    U64(0xc7caba6eUL, 0x7c5382c8UL), U64(0xfe64a52eUL, 0xe96b8fc0UL),
+    U64(0xf9bd690aUL, 0x1b68637bUL), U64(0x3dfdce7aUL, 0xa3c673b0UL),
+    U64(0x9c1661a6UL, 0x51213e2dUL), U64(0x06bea10cUL, 0xa65c084eUL),
+    U64(0xc31bfa0fUL, 0xe5698db8UL), U64(0x486e494fUL, 0xcff30a62UL),
+    U64(0xf3e2f893UL, 0xdec3f126UL), U64(0x5a89dba3UL, 0xc3efccfaUL),
+    U64(0x986ddb5cUL, 0x6b3a76b7UL), U64(0xf8962946UL, 0x5a75e01cUL),
+    U64(0xbe895233UL, 0x86091465UL), U64(0xf6bbb397UL, 0xf1135823UL),
+    U64(0xee2ba6c0UL, 0x678b597fUL), U64(0x746aa07dUL, 0xed582e2cUL),
+    U64(0x94db4838UL, 0x40b717efUL), U64(0xa8c2a44eUL, 0xb4571cdcUL),
+    U64(0xba121a46UL, 0x50e4ddebUL), U64(0x92f34d62UL, 0x616ce413UL),
+    U64(0xe896a0d7UL, 0xe51e1566UL), U64(0x77b020baUL, 0xf9c81d17UL),
+    U64(0x915e2486UL, 0xef32cd60UL), U64(0x0ace1474UL, 0xdc1d122eUL),
+    U64(0xb5b5ada8UL, 0xaaff80b8UL), U64(0x0d819992UL, 0x132456baUL),
+    U64(0xe3231912UL, 0xd5bf60e6UL), U64(0x10e1fff6UL, 0x97ed6c69UL),
+    U64(0x8df5efabUL, 0xc5979c8fUL), U64(0xca8d3ffaUL, 0x1ef463c1UL),
+    U64(0xb1736b96UL, 0xb6fd83b3UL), U64(0xbd308ff8UL, 0xa6b17cb2UL),
+    U64(0xddd0467cUL, 0x64bce4a0UL), U64(0xac7cb3f6UL, 0xd05ddbdeUL),
+    U64(0x8aa22c0dUL, 0xbef60ee4UL), U64(0x6bcdf07aUL, 0x423aa96bUL),
+    U64(0xad4ab711UL, 0x2eb3929dUL), U64(0x86c16c98UL, 0xd2c953c6UL),
+    U64(0xd89d64d5UL, 0x7a607744UL), U64(0xe871c7bfUL, 0x077ba8b7UL),
+    U64(0x87625f05UL, 0x6c7c4a8bUL), U64(0x11471cd7UL, 0x64ad4972UL),
+    U64(0xa93af6c6UL, 0xc79b5d2dUL), U64(0xd598e40dUL, 0x3dd89bcfUL),
+    U64(0xd389b478UL, 0x79823479UL), U64(0x4aff1d10UL, 0x8d4ec2c3UL),
+    U64(0x843610cbUL, 0x4bf160cbUL), U64(0xcedf722aUL, 0x585139baUL),
+    U64(0xa54394feUL, 0x1eedb8feUL), U64(0xc2974eb4UL, 0xee658828UL),
+    U64(0xce947a3dUL, 0xa6a9273eUL), U64(0x733d2262UL, 0x29feea32UL),
+    U64(0x811ccc66UL, 0x8829b887UL), U64(0x0806357dUL, 0x5a3f525fUL),
+    U64(0xa163ff80UL, 0x2a3426a8UL), U64(0xca07c2dcUL, 0xb0cf26f7UL),
+    U64(0xc9bcff60UL, 0x34c13052UL), U64(0xfc89b393UL, 0xdd02f0b5UL),
+    U64(0xfc2c3f38UL, 0x41f17c67UL), U64(0xbbac2078UL, 0xd443ace2UL),
+    U64(0x9d9ba783UL, 0x2936edc0UL), U64(0xd54b944bUL, 0x84aa4c0dUL),
+    U64(0xc5029163UL, 0xf384a931UL), U64(0x0a9e795eUL, 0x65d4df11UL),
+    U64(0xf64335bcUL, 0xf065d37dUL), U64(0x4d4617b5UL, 0xff4a16d5UL),
+    U64(0x99ea0196UL, 0x163fa42eUL), U64(0x504bced1UL, 0xbf8e4e45UL),
+    U64(0xc06481fbUL, 0x9bcf8d39UL), U64(0xe45ec286UL, 0x2f71e1d6UL),
+    U64(0xf07da27aUL, 0x82c37088UL), U64(0x5d767327UL, 0xbb4e5a4cUL),
+    U64(0x964e858cUL, 0x91ba2655UL), U64(0x3a6a07f8UL, 0xd510f86fUL),
+    U64(0xbbe226efUL, 0xb628afeaUL), U64(0x890489f7UL, 0x0a55368bUL),
+    U64(0xeadab0abUL, 0xa3b2dbe5UL), U64(0x2b45ac74UL, 0xccea842eUL),
+    U64(0x92c8ae6bUL, 0x464fc96fUL), U64(0x3b0b8bc9UL, 0x0012929dUL),
+    U64(0xb77ada06UL, 0x17e3bbcbUL), U64(0x09ce6ebbUL, 0x40173744UL),
+    U64(0xe5599087UL, 0x9ddcaabdUL), U64(0xcc420a6aUL, 0x101d0515UL),
+    U64(0x8f57fa54UL, 0xc2a9eab6UL), U64(0x9fa94682UL, 0x4a12232dUL),
+    U64(0xb32df8e9UL, 0xf3546564UL), U64(0x47939822UL, 0xdc96abf9UL),
+    U64(0xdff97724UL, 0x70297ebdUL), U64(0x59787e2bUL, 0x93bc56f7UL),
+    U64(0x8bfbea76UL, 0xc619ef36UL), U64(0x57eb4edbUL, 0x3c55b65aUL),
+    U64(0xaefae514UL, 0x77a06b03UL), U64(0xede62292UL, 0x0b6b23f1UL),
+    U64(0xdab99e59UL, 0x958885c4UL), U64(0xe95fab36UL, 0x8e45ecedUL),
+    U64(0x88b402f7UL, 0xfd75539bUL), U64(0x11dbcb02UL, 0x18ebb414UL),
+    U64(0xaae103b5UL, 0xfcd2a881UL), U64(0xd652bdc2UL, 0x9f26a119UL),
+    U64(0xd59944a3UL, 0x7c0752a2UL), U64(0x4be76d33UL, 0x46f0495fUL),
+    U64(0x857fcae6UL, 0x2d8493a5UL), U64(0x6f70a440UL, 0x0c562ddbUL),
+    U64(0xa6dfbd9fUL, 0xb8e5b88eUL), U64(0xcb4ccd50UL, 0x0f6bb952UL),
+    U64(0xd097ad07UL, 0xa71f26b2UL), U64(0x7e2000a4UL, 0x1346a7a7UL),
+    U64(0x825ecc24UL, 0xc873782fUL), U64(0x8ed40066UL, 0x8c0c28c8UL),
+    U64(0xa2f67f2dUL, 0xfa90563bUL), U64(0x72890080UL, 0x2f0f32faUL),
+    U64(0xcbb41ef9UL, 0x79346bcaUL), U64(0x4f2b40a0UL, 0x3ad2ffb9UL),
+    U64(0xfea126b7UL, 0xd78186bcUL), U64(0xe2f610c8UL, 0x4987bfa8UL),
+    U64(0x9f24b832UL, 0xe6b0f436UL), U64(0x0dd9ca7dUL, 0x2df4d7c9UL),
+    U64(0xc6ede63fUL, 0xa05d3143UL), U64(0x91503d1cUL, 0x79720dbbUL),
+    U64(0xf8a95fcfUL, 0x88747d94UL), U64(0x75a44c63UL, 0x97ce912aUL),
+    U64(0x9b69dbe1UL, 0xb548ce7cUL), U64(0xc986afbeUL, 0x3ee11abaUL),
+    U64(0xc24452daUL, 0x229b021bUL), U64(0xfbe85badUL, 0xce996168UL),
+    U64(0xf2d56790UL, 0xab41c2a2UL), U64(0xfae27299UL, 0x423fb9c3UL),
+    U64(0x97c560baUL, 0x6b0919a5UL), U64(0xdccd879fUL, 0xc967d41aUL),
+    U64(0xbdb6b8e9UL, 0x05cb600fUL), U64(0x5400e987UL, 0xbbc1c920UL),
+    U64(0xed246723UL, 0x473e3813UL), U64(0x290123e9UL, 0xaab23b68UL),
+    U64(0x9436c076UL, 0x0c86e30bUL), U64(0xf9a0b672UL, 0x0aaf6521UL),
+    U64(0xb9447093UL, 0x8fa89bceUL), U64(0xf808e40eUL, 0x8d5b3e69UL),
+    U64(0xe7958cb8UL, 0x7392c2c2UL), U64(0xb60b1d12UL, 0x30b20e04UL),
+    U64(0x90bd77f3UL, 0x483bb9b9UL), U64(0xb1c6f22bUL, 0x5e6f48c2UL),
+    U64(0xb4ecd5f0UL, 0x1a4aa828UL), U64(0x1e38aeb6UL, 0x360b1af3UL),
+    U64(0xe2280b6cUL, 0x20dd5232UL), U64(0x25c6da63UL, 0xc38de1b0UL),
+    U64(0x8d590723UL, 0x948a535fUL), U64(0x579c487eUL, 0x5a38ad0eUL),
+    U64(0xb0af48ecUL, 0x79ace837UL), U64(0x2d835a9dUL, 0xf0c6d851UL),
+    U64(0xdcdb1b27UL, 0x98182244UL), U64(0xf8e43145UL, 0x6cf88e65UL),
+    U64(0x8a08f0f8UL, 0xbf0f156bUL), U64(0x1b8e9ecbUL, 0x641b58ffUL),
+    U64(0xac8b2d36UL, 0xeed2dac5UL), U64(0xe272467eUL, 0x3d222f3fUL),
+    U64(0xd7adf884UL, 0xaa879177UL), U64(0x5b0ed81dUL, 0xcc6abb0fUL),
+    U64(0x86ccbb52UL, 0xea94baeaUL), U64(0x98e94712UL, 0x9fc2b4e9UL),
+    U64(0xa87fea27UL, 0xa539e9a5UL), U64(0x3f2398d7UL, 0x47b36224UL),
+    U64(0xd29fe4b1UL, 0x8e88640eUL), U64(0x8eec7f0dUL, 0x19a03aadUL),
+    U64(0x83a3eeeeUL, 0xf9153e89UL), U64(0x1953cf68UL, 0x300424acUL),
+    U64(0xa48ceaaaUL, 0xb75a8e2bUL), U64(0x5fa8c342UL, 0x3c052dd7UL),
+    U64(0xcdb02555UL, 0x653131b6UL), U64(0x3792f412UL, 0xcb06794dUL),
+    U64(0x808e1755UL, 0x5f3ebf11UL), U64(0xe2bbd88bUL, 0xbee40bd0UL),
+    U64(0xa0b19d2aUL, 0xb70e6ed6UL), U64(0x5b6aceaeUL, 0xae9d0ec4UL),
+    U64(0xc8de0475UL, 0x64d20a8bUL), U64(0xf245825aUL, 0x5a445275UL),
+    U64(0xfb158592UL, 0xbe068d2eUL), U64(0xeed6e2f0UL, 0xf0d56712UL),
+    U64(0x9ced737bUL, 0xb6c4183dUL), U64(0x55464dd6UL, 0x9685606bUL),
+    U64(0xc428d05aUL, 0xa4751e4cUL), U64(0xaa97e14cUL, 0x3c26b886UL),
+    U64(0xf5330471UL, 0x4d9265dfUL), U64(0xd53dd99fUL, 0x4b3066a8UL),
+    U64(0x993fe2c6UL, 0xd07b7fabUL), U64(0xe546a803UL, 0x8efe4029UL),
+    U64(0xbf8fdb78UL, 0x849a5f96UL), U64(0xde985204UL, 0x72bdd033UL),
+    U64(0xef73d256UL, 0xa5c0f77cUL), U64(0x963e6685UL, 0x8f6d4440UL),
+    U64(0x95a86376UL, 0x27989aadUL), U64(0xdde70013UL, 0x79a44aa8UL),
+    U64(0xbb127c53UL, 0xb17ec159UL), U64(0x5560c018UL, 0x580d5d52UL),
+    U64(0xe9d71b68UL, 0x9dde71afUL), U64(0xaab8f01eUL, 0x6e10b4a6UL),
+    U64(0x92267121UL, 0x62ab070dUL), U64(0xcab39613UL, 0x04ca70e8UL),
+    U64(0xb6b00d69UL, 0xbb55c8d1UL), U64(0x3d607b97UL, 0xc5fd0d22UL),
+    U64(0xe45c10c4UL, 0x2a2b3b05UL), U64(0x8cb89a7dUL, 0xb77c506aUL),
+    U64(0x8eb98a7aUL, 0x9a5b04e3UL), U64(0x77f3608eUL, 0x92adb242UL),
+    U64(0xb267ed19UL, 0x40f1c61cUL), U64(0x55f038b2UL, 0x37591ed3UL),
+    U64(0xdf01e85fUL, 0x912e37a3UL), U64(0x6b6c46deUL, 0xc52f6688UL),
+    U64(0x8b61313bUL, 0xbabce2c6UL), U64(0x2323ac4bUL, 0x3b3da015UL),
+    U64(0xae397d8aUL, 0xa96c1b77UL), U64(0xabec975eUL, 0x0a0d081aUL),
+    U64(0xd9c7dcedUL, 0x53c72255UL), U64(0x96e7bd35UL, 0x8c904a21UL),
+    U64(0x881cea14UL, 0x545c7575UL), U64(0x7e50d641UL, 0x77da2e54UL),
+    U64(0xaa242499UL, 0x697392d2UL), U64(0xdde50bd1UL, 0xd5d0b9e9UL),
+    U64(0xd4ad2dbfUL, 0xc3d07787UL), U64(0x955e4ec6UL, 0x4b44e864UL),
+    U64(0x84ec3c97UL, 0xda624ab4UL), U64(0xbd5af13bUL, 0xef0b113eUL),
+    U64(0xa6274bbdUL, 0xd0fadd61UL), U64(0xecb1ad8aUL, 0xeacdd58eUL),
+    U64(0xcfb11eadUL, 0x453994baUL), U64(0x67de18edUL, 0xa5814af2UL),
+    U64(0x81ceb32cUL, 0x4b43fcf4UL), U64(0x80eacf94UL, 0x8770ced7UL),
+    U64(0xa2425ff7UL, 0x5e14fc31UL), U64(0xa1258379UL, 0xa94d028dUL),
+    U64(0xcad2f7f5UL, 0x359a3b3eUL), U64(0x096ee458UL, 0x13a04330UL),
+    U64(0xfd87b5f2UL, 0x8300ca0dUL), U64(0x8bca9d6eUL, 0x188853fcUL),
+    U64(0x9e74d1b7UL, 0x91e07e48UL), U64(0x775ea264UL, 0xcf55347eUL),
+    U64(0xc6120625UL, 0x76589ddaUL), U64(0x95364afeUL, 0x032a819eUL),
+    U64(0xf79687aeUL, 0xd3eec551UL), U64(0x3a83ddbdUL, 0x83f52205UL),
+    U64(0x9abe14cdUL, 0x44753b52UL), U64(0xc4926a96UL, 0x72793543UL),
+    U64(0xc16d9a00UL, 0x95928a27UL), U64(0x75b7053cUL, 0x0f178294UL),
+    U64(0xf1c90080UL, 0xbaf72cb1UL), U64(0x5324c68bUL, 0x12dd6339UL),
+    U64(0x971da050UL, 0x74da7beeUL), U64(0xd3f6fc16UL, 0xebca5e04UL),
+    U64(0xbce50864UL, 0x92111aeaUL), U64(0x88f4bb1cUL, 0xa6bcf585UL),
+    U64(0xec1e4a7dUL, 0xb69561a5UL), U64(0x2b31e9e3UL, 0xd06c32e6UL),
+    U64(0x9392ee8eUL, 0x921d5d07UL), U64(0x3aff322eUL, 0x62439fd0UL),
+    U64(0xb877aa32UL, 0x36a4b449UL), U64(0x09befeb9UL, 0xfad487c3UL),
+    U64(0xe69594beUL, 0xc44de15bUL), U64(0x4c2ebe68UL, 0x7989a9b4UL),
+    U64(0x901d7cf7UL, 0x3ab0acd9UL), U64(0x0f9d3701UL, 0x4bf60a11UL),
+    U64(0xb424dc35UL, 0x095cd80fUL), U64(0x538484c1UL, 0x9ef38c95UL),
+    U64(0xe12e1342UL, 0x4bb40e13UL), U64(0x2865a5f2UL, 0x06b06fbaUL),
+    U64(0x8cbccc09UL, 0x6f5088cbUL), U64(0xf93f87b7UL, 0x442e45d4UL),
+    U64(0xafebff0bUL, 0xcb24aafeUL), U64(0xf78f69a5UL, 0x1539d749UL),
+    U64(0xdbe6feceUL, 0xbdedd5beUL), U64(0xb573440eUL, 0x5a884d1cUL),
+    U64(0x89705f41UL, 0x36b4a597UL), U64(0x31680a88UL, 0xf8953031UL),
+    U64(0xabcc7711UL, 0x8461cefcUL), U64(0xfdc20d2bUL, 0x36ba7c3eUL),
+    U64(0xd6bf94d5UL, 0xe57a42bcUL), U64(0x3d329076UL, 0x04691b4dUL),
+    U64(0x8637bd05UL, 0xaf6c69b5UL), U64(0xa63f9a49UL, 0xc2c1b110UL),
+    U64(0xa7c5ac47UL, 0x1b478423UL), U64(0x0fcf80dcUL, 0x33721d54UL),
+    U64(0xd1b71758UL, 0xe219652bUL), U64(0xd3c36113UL, 0x404ea4a9UL),
+    U64(0x83126e97UL, 0x8d4fdf3bUL), U64(0x645a1cacUL, 0x083126eaUL),
+    U64(0xa3d70a3dUL, 0x70a3d70aUL), U64(0x3d70a3d7UL, 0x0a3d70a4UL),
+    U64(0xccccccccUL, 0xccccccccUL), U64(0xccccccccUL, 0xcccccccdUL),
+    U64(0x80000000UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xa0000000UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xc8000000UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xfa000000UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0x9c400000UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xc3500000UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xf4240000UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0x98968000UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xbebc2000UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xee6b2800UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0x9502f900UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xba43b740UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xe8d4a510UL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0x9184e72aUL, 0x00000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xb5e620f4UL, 0x80000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xe35fa931UL, 0xa0000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0x8e1bc9bfUL, 0x04000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xb1a2bc2eUL, 0xc5000000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xde0b6b3aUL, 0x76400000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0x8ac72304UL, 0x89e80000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xad78ebc5UL, 0xac620000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xd8d726b7UL, 0x177a8000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0x87867832UL, 0x6eac9000UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xa968163fUL, 0x0a57b400UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xd3c21bceUL, 0xcceda100UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0x84595161UL, 0x401484a0UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xa56fa5b9UL, 0x9019a5c8UL), U64(0x00000000UL, 0x00000000UL),
+    U64(0xcecb8f27UL, 0xf4200f3aUL), U64(0x00000000UL, 0x00000000UL),
+    U64(0x813f3978UL, 0xf8940984UL), U64(0x40000000UL, 0x00000000UL),
+    U64(0xa18f07d7UL, 0x36b90be5UL), U64(0x50000000UL, 0x00000000UL),
+    U64(0xc9f2c9cdUL, 0x04674edeUL), U64(0xa4000000UL, 0x00000000UL),
+    U64(0xfc6f7c40UL, 0x45812296UL), U64(0x4d000000UL, 0x00000000UL),
+    U64(0x9dc5ada8UL, 0x2b70b59dUL), U64(0xf0200000UL, 0x00000000UL),
+    U64(0xc5371912UL, 0x364ce305UL), U64(0x6c280000UL, 0x00000000UL),
+    U64(0xf684df56UL, 0xc3e01bc6UL), U64(0xc7320000UL, 0x00000000UL),
+    U64(0x9a130b96UL, 0x3a6c115cUL), U64(0x3c7f4000UL, 0x00000000UL),
+    U64(0xc097ce7bUL, 0xc90715b3UL), U64(0x4b9f1000UL, 0x00000000UL),
+    U64(0xf0bdc21aUL, 0xbb48db20UL), U64(0x1e86d400UL, 0x00000000UL),
+    U64(0x96769950UL, 0xb50d88f4UL), U64(0x13144480UL, 0x00000000UL),
+    U64(0xbc143fa4UL, 0xe250eb31UL), U64(0x17d955a0UL, 0x00000000UL),
+    U64(0xeb194f8eUL, 0x1ae525fdUL), U64(0x5dcfab08UL, 0x00000000UL),
+    U64(0x92efd1b8UL, 0xd0cf37beUL), U64(0x5aa1cae5UL, 0x00000000UL),
+    U64(0xb7abc627UL, 0x050305adUL), U64(0xf14a3d9eUL, 0x40000000UL),
+    U64(0xe596b7b0UL, 0xc643c719UL), U64(0x6d9ccd05UL, 0xd0000000UL),
+    U64(0x8f7e32ceUL, 0x7bea5c6fUL), U64(0xe4820023UL, 0xa2000000UL),
+    U64(0xb35dbf82UL, 0x1ae4f38bUL), U64(0xdda2802cUL, 0x8a800000UL),
+    U64(0xe0352f62UL, 0xa19e306eUL), U64(0xd50b2037UL, 0xad200000UL),
+    U64(0x8c213d9dUL, 0xa502de45UL), U64(0x4526f422UL, 0xcc340000UL),
+    U64(0xaf298d05UL, 0x0e4395d6UL), U64(0x9670b12bUL, 0x7f410000UL),
+    U64(0xdaf3f046UL, 0x51d47b4cUL), U64(0x3c0cdd76UL, 0x5f114000UL),
+    U64(0x88d8762bUL, 0xf324cd0fUL), U64(0xa5880a69UL, 0xfb6ac800UL),
+    U64(0xab0e93b6UL, 0xefee0053UL), U64(0x8eea0d04UL, 0x7a457a00UL),
+    U64(0xd5d238a4UL, 0xabe98068UL), U64(0x72a49045UL, 0x98d6d880UL),
+    U64(0x85a36366UL, 0xeb71f041UL), U64(0x47a6da2bUL, 0x7f864750UL),
+    U64(0xa70c3c40UL, 0xa64e6c51UL), U64(0x999090b6UL, 0x5f67d924UL),
+    U64(0xd0cf4b50UL, 0xcfe20765UL), U64(0xfff4b4e3UL, 0xf741cf6dUL),
+    U64(0x82818f12UL, 0x81ed449fUL), U64(0xbff8f10eUL, 0x7a8921a4UL),
+    U64(0xa321f2d7UL, 0x226895c7UL), U64(0xaff72d52UL, 0x192b6a0dUL),
+    U64(0xcbea6f8cUL, 0xeb02bb39UL), U64(0x9bf4f8a6UL, 0x9f764490UL),
+    U64(0xfee50b70UL, 0x25c36a08UL), U64(0x02f236d0UL, 0x4753d5b4UL),
+    U64(0x9f4f2726UL, 0x179a2245UL), U64(0x01d76242UL, 0x2c946590UL),
+    U64(0xc722f0efUL, 0x9d80aad6UL), U64(0x424d3ad2UL, 0xb7b97ef5UL),
+    U64(0xf8ebad2bUL, 0x84e0d58bUL), U64(0xd2e08987UL, 0x65a7deb2UL),
+    U64(0x9b934c3bUL, 0x330c8577UL), U64(0x63cc55f4UL, 0x9f88eb2fUL),
+    U64(0xc2781f49UL, 0xffcfa6d5UL), U64(0x3cbf6b71UL, 0xc76b25fbUL),
+    U64(0xf316271cUL, 0x7fc3908aUL), U64(0x8bef464eUL, 0x3945ef7aUL),
+    U64(0x97edd871UL, 0xcfda3a56UL), U64(0x97758bf0UL, 0xe3cbb5acUL),
+    U64(0xbde94e8eUL, 0x43d0c8ecUL), U64(0x3d52eeedUL, 0x1cbea317UL),
+    U64(0xed63a231UL, 0xd4c4fb27UL), U64(0x4ca7aaa8UL, 0x63ee4bddUL),
+    U64(0x945e455fUL, 0x24fb1cf8UL), U64(0x8fe8caa9UL, 0x3e74ef6aUL),
+    U64(0xb975d6b6UL, 0xee39e436UL), U64(0xb3e2fd53UL, 0x8e122b44UL),
+    U64(0xe7d34c64UL, 0xa9c85d44UL), U64(0x60dbbca8UL, 0x7196b616UL),
+    U64(0x90e40fbeUL, 0xea1d3a4aUL), U64(0xbc8955e9UL, 0x46fe31cdUL),
+    U64(0xb51d13aeUL, 0xa4a488ddUL), U64(0x6babab63UL, 0x98bdbe41UL),
+    U64(0xe264589aUL, 0x4dcdab14UL), U64(0xc696963cUL, 0x7eed2dd1UL),
+    U64(0x8d7eb760UL, 0x70a08aecUL), U64(0xfc1e1de5UL, 0xcf543ca2UL),
+    U64(0xb0de6538UL, 0x8cc8ada8UL), U64(0x3b25a55fUL, 0x43294bcbUL),
+    U64(0xdd15fe86UL, 0xaffad912UL), U64(0x49ef0eb7UL, 0x13f39ebeUL),
+    U64(0x8a2dbf14UL, 0x2dfcc7abUL), U64(0x6e356932UL, 0x6c784337UL),
+    U64(0xacb92ed9UL, 0x397bf996UL), U64(0x49c2c37fUL, 0x07965404UL),
+    U64(0xd7e77a8fUL, 0x87daf7fbUL), U64(0xdc33745eUL, 0xc97be906UL),
+    U64(0x86f0ac99UL, 0xb4e8dafdUL), U64(0x69a028bbUL, 0x3ded71a3UL),
+    U64(0xa8acd7c0UL, 0x222311bcUL), U64(0xc40832eaUL, 0x0d68ce0cUL),
+    U64(0xd2d80db0UL, 0x2aabd62bUL), U64(0xf50a3fa4UL, 0x90c30190UL),
+    U64(0x83c7088eUL, 0x1aab65dbUL), U64(0x792667c6UL, 0xda79e0faUL),
+    U64(0xa4b8cab1UL, 0xa1563f52UL), U64(0x577001b8UL, 0x91185938UL),
+    U64(0xcde6fd5eUL, 0x09abcf26UL), U64(0xed4c0226UL, 0xb55e6f86UL),
+    U64(0x80b05e5aUL, 0xc60b6178UL), U64(0x544f8158UL, 0x315b05b4UL),
+    U64(0xa0dc75f1UL, 0x778e39d6UL), U64(0x696361aeUL, 0x3db1c721UL),
+    U64(0xc913936dUL, 0xd571c84cUL), U64(0x03bc3a19UL, 0xcd1e38e9UL),
+    U64(0xfb587849UL, 0x4ace3a5fUL), U64(0x04ab48a0UL, 0x4065c723UL),
+    U64(0x9d174b2dUL, 0xcec0e47bUL), U64(0x62eb0d64UL, 0x283f9c76UL),
+    U64(0xc45d1df9UL, 0x42711d9aUL), U64(0x3ba5d0bdUL, 0x324f8394UL),
+    U64(0xf5746577UL, 0x930d6500UL), U64(0xca8f44ecUL, 0x7ee36479UL),
+    U64(0x9968bf6aUL, 0xbbe85f20UL), U64(0x7e998b13UL, 0xcf4e1ecbUL),
+    U64(0xbfc2ef45UL, 0x6ae276e8UL), U64(0x9e3fedd8UL, 0xc321a67eUL),
+    U64(0xefb3ab16UL, 0xc59b14a2UL), U64(0xc5cfe94eUL, 0xf3ea101eUL),
+    U64(0x95d04aeeUL, 0x3b80ece5UL), U64(0xbba1f1d1UL, 0x58724a12UL),
+    U64(0xbb445da9UL, 0xca61281fUL), U64(0x2a8a6e45UL, 0xae8edc97UL),
+    U64(0xea157514UL, 0x3cf97226UL), U64(0xf52d09d7UL, 0x1a3293bdUL),
+    U64(0x924d692cUL, 0xa61be758UL), U64(0x593c2626UL, 0x705f9c56UL),
+    U64(0xb6e0c377UL, 0xcfa2e12eUL), U64(0x6f8b2fb0UL, 0x0c77836cUL),
+    U64(0xe498f455UL, 0xc38b997aUL), U64(0x0b6dfb9cUL, 0x0f956447UL),
+    U64(0x8edf98b5UL, 0x9a373fecUL), U64(0x4724bd41UL, 0x89bd5eacUL),
+    U64(0xb2977ee3UL, 0x00c50fe7UL), U64(0x58edec91UL, 0xec2cb657UL),
+    U64(0xdf3d5e9bUL, 0xc0f653e1UL), U64(0x2f2967b6UL, 0x6737e3edUL),
+    U64(0x8b865b21UL, 0x5899f46cUL), U64(0xbd79e0d2UL, 0x0082ee74UL),
+    U64(0xae67f1e9UL, 0xaec07187UL), U64(0xecd85906UL, 0x80a3aa11UL),
+    U64(0xda01ee64UL, 0x1a708de9UL), U64(0xe80e6f48UL, 0x20cc9495UL),
+    U64(0x884134feUL, 0x908658b2UL), U64(0x3109058dUL, 0x147fdcddUL),
+    U64(0xaa51823eUL, 0x34a7eedeUL), U64(0xbd4b46f0UL, 0x599fd415UL),
+    U64(0xd4e5e2cdUL, 0xc1d1ea96UL), U64(0x6c9e18acUL, 0x7007c91aUL),
+    U64(0x850fadc0UL, 0x9923329eUL), U64(0x03e2cf6bUL, 0xc604ddb0UL),
+    U64(0xa6539930UL, 0xbf6bff45UL), U64(0x84db8346UL, 0xb786151cUL),
+    U64(0xcfe87f7cUL, 0xef46ff16UL), U64(0xe6126418UL, 0x65679a63UL),
+    U64(0x81f14faeUL, 0x158c5f6eUL), U64(0x4fcb7e8fUL, 0x3f60c07eUL),
+    U64(0xa26da399UL, 0x9aef7749UL), U64(0xe3be5e33UL, 0x0f38f09dUL),
+    U64(0xcb090c80UL, 0x01ab551cUL), U64(0x5cadf5bfUL, 0xd3072cc5UL),
+    U64(0xfdcb4fa0UL, 0x02162a63UL), U64(0x73d9732fUL, 0xc7c8f7f6UL),
+    U64(0x9e9f11c4UL, 0x014dda7eUL), U64(0x2867e7fdUL, 0xdcdd9afaUL),
+    U64(0xc646d635UL, 0x01a1511dUL), U64(0xb281e1fdUL, 0x541501b8UL),
+    U64(0xf7d88bc2UL, 0x4209a565UL), U64(0x1f225a7cUL, 0xa91a4226UL),
+    U64(0x9ae75759UL, 0x6946075fUL), U64(0x3375788dUL, 0xe9b06958UL),
+    U64(0xc1a12d2fUL, 0xc3978937UL), U64(0x0052d6b1UL, 0x641c83aeUL),
+    U64(0xf209787bUL, 0xb47d6b84UL), U64(0xc0678c5dUL, 0xbd23a49aUL),
+    U64(0x9745eb4dUL, 0x50ce6332UL), U64(0xf840b7baUL, 0x963646e0UL),
+    U64(0xbd176620UL, 0xa501fbffUL), U64(0xb650e5a9UL, 0x3bc3d898UL),
+    U64(0xec5d3fa8UL, 0xce427affUL), U64(0xa3e51f13UL, 0x8ab4cebeUL),
+    U64(0x93ba47c9UL, 0x80e98cdfUL), U64(0xc66f336cUL, 0x36b10137UL),
+    U64(0xb8a8d9bbUL, 0xe123f017UL), U64(0xb80b0047UL, 0x445d4184UL),
+    U64(0xe6d3102aUL, 0xd96cec1dUL), U64(0xa60dc059UL, 0x157491e5UL),
+    U64(0x9043ea1aUL, 0xc7e41392UL), U64(0x87c89837UL, 0xad68db2fUL),
+    U64(0xb454e4a1UL, 0x79dd1877UL), U64(0x29babe45UL, 0x98c311fbUL),
+    U64(0xe16a1dc9UL, 0xd8545e94UL), U64(0xf4296dd6UL, 0xfef3d67aUL),
+    U64(0x8ce2529eUL, 0x2734bb1dUL), U64(0x1899e4a6UL, 0x5f58660cUL),
+    U64(0xb01ae745UL, 0xb101e9e4UL), U64(0x5ec05dcfUL, 0xf72e7f8fUL),
+    U64(0xdc21a117UL, 0x1d42645dUL), U64(0x76707543UL, 0xf4fa1f73UL),
+    U64(0x899504aeUL, 0x72497ebaUL), U64(0x6a06494aUL, 0x791c53a8UL),
+    U64(0xabfa45daUL, 0x0edbde69UL), U64(0x0487db9dUL, 0x17636892UL),
+    U64(0xd6f8d750UL, 0x9292d603UL), U64(0x45a9d284UL, 0x5d3c42b6UL),
+    U64(0x865b8692UL, 0x5b9bc5c2UL), U64(0x0b8a2392UL, 0xba45a9b2UL),
+    U64(0xa7f26836UL, 0xf282b732UL), U64(0x8e6cac77UL, 0x68d7141eUL),
+    U64(0xd1ef0244UL, 0xaf2364ffUL), U64(0x3207d795UL, 0x430cd926UL),
+    U64(0x8335616aUL, 0xed761f1fUL), U64(0x7f44e6bdUL, 0x49e807b8UL),
+    U64(0xa402b9c5UL, 0xa8d3a6e7UL), U64(0x5f16206cUL, 0x9c6209a6UL),
+    U64(0xcd036837UL, 0x130890a1UL), U64(0x36dba887UL, 0xc37a8c0fUL),
+    U64(0x80222122UL, 0x6be55a64UL), U64(0xc2494954UL, 0xda2c9789UL),
+    U64(0xa02aa96bUL, 0x06deb0fdUL), U64(0xf2db9baaUL, 0x10b7bd6cUL),
+    U64(0xc83553c5UL, 0xc8965d3dUL), U64(0x6f928294UL, 0x94e5acc7UL),
+    U64(0xfa42a8b7UL, 0x3abbf48cUL), U64(0xcb772339UL, 0xba1f17f9UL),
+    U64(0x9c69a972UL, 0x84b578d7UL), U64(0xff2a7604UL, 0x14536efbUL),
+    U64(0xc38413cfUL, 0x25e2d70dUL), U64(0xfef51385UL, 0x19684abaUL),
+    U64(0xf46518c2UL, 0xef5b8cd1UL), U64(0x7eb25866UL, 0x5fc25d69UL),
+    U64(0x98bf2f79UL, 0xd5993802UL), U64(0xef2f773fUL, 0xfbd97a61UL),
+    U64(0xbeeefb58UL, 0x4aff8603UL), U64(0xaafb550fUL, 0xfacfd8faUL),
+    U64(0xeeaaba2eUL, 0x5dbf6784UL), U64(0x95ba2a53UL, 0xf983cf38UL),
+    U64(0x952ab45cUL, 0xfa97a0b2UL), U64(0xdd945a74UL, 0x7bf26183UL),
+    U64(0xba756174UL, 0x393d88dfUL), U64(0x94f97111UL, 0x9aeef9e4UL),
+    U64(0xe912b9d1UL, 0x478ceb17UL), U64(0x7a37cd56UL, 0x01aab85dUL),
+    U64(0x91abb422UL, 0xccb812eeUL), U64(0xac62e055UL, 0xc10ab33aUL),
+    U64(0xb616a12bUL, 0x7fe617aaUL), U64(0x577b986bUL, 0x314d6009UL),
+    U64(0xe39c4976UL, 0x5fdf9d94UL), U64(0xed5a7e85UL, 0xfda0b80bUL),
+    U64(0x8e41ade9UL, 0xfbebc27dUL), U64(0x14588f13UL, 0xbe847307UL),
+    U64(0xb1d21964UL, 0x7ae6b31cUL), U64(0x596eb2d8UL, 0xae258fc8UL),
+    U64(0xde469fbdUL, 0x99a05fe3UL), U64(0x6fca5f8eUL, 0xd9aef3bbUL),
+    U64(0x8aec23d6UL, 0x80043beeUL), U64(0x25de7bb9UL, 0x480d5854UL),
+    U64(0xada72cccUL, 0x20054ae9UL), U64(0xaf561aa7UL, 0x9a10ae6aUL),
+    U64(0xd910f7ffUL, 0x28069da4UL), U64(0x1b2ba151UL, 0x8094da04UL),
+    U64(0x87aa9affUL, 0x79042286UL), U64(0x90fb44d2UL, 0xf05d0842UL),
+    U64(0xa99541bfUL, 0x57452b28UL), U64(0x353a1607UL, 0xac744a53UL),
+    U64(0xd3fa922fUL, 0x2d1675f2UL), U64(0x42889b89UL, 0x97915ce8UL),
+    U64(0x847c9b5dUL, 0x7c2e09b7UL), U64(0x69956135UL, 0xfebada11UL),
+    U64(0xa59bc234UL, 0xdb398c25UL), U64(0x43fab983UL, 0x7e699095UL),
+    U64(0xcf02b2c2UL, 0x1207ef2eUL), U64(0x94f967e4UL, 0x5e03f4bbUL),
+    U64(0x8161afb9UL, 0x4b44f57dUL), U64(0x1d1be0eeUL, 0xbac278f5UL),
+    U64(0xa1ba1ba7UL, 0x9e1632dcUL), U64(0x6462d92aUL, 0x69731732UL),
+    U64(0xca28a291UL, 0x859bbf93UL), U64(0x7d7b8f75UL, 0x03cfdcfeUL),
+    U64(0xfcb2cb35UL, 0xe702af78UL), U64(0x5cda7352UL, 0x44c3d43eUL),
+    U64(0x9defbf01UL, 0xb061adabUL), U64(0x3a088813UL, 0x6afa64a7UL),
+    U64(0xc56baec2UL, 0x1c7a1916UL), U64(0x088aaa18UL, 0x45b8fdd0UL),
+    U64(0xf6c69a72UL, 0xa3989f5bUL), U64(0x8aad549eUL, 0x57273d45UL),
+    U64(0x9a3c2087UL, 0xa63f6399UL), U64(0x36ac54e2UL, 0xf678864bUL),
+    U64(0xc0cb28a9UL, 0x8fcf3c7fUL), U64(0x84576a1bUL, 0xb416a7ddUL),
+    U64(0xf0fdf2d3UL, 0xf3c30b9fUL), U64(0x656d44a2UL, 0xa11c51d5UL),
+    U64(0x969eb7c4UL, 0x7859e743UL), U64(0x9f644ae5UL, 0xa4b1b325UL),
+    U64(0xbc4665b5UL, 0x96706114UL), U64(0x873d5d9fUL, 0x0dde1feeUL),
+    U64(0xeb57ff22UL, 0xfc0c7959UL), U64(0xa90cb506UL, 0xd155a7eaUL),
+    U64(0x9316ff75UL, 0xdd87cbd8UL), U64(0x09a7f124UL, 0x42d588f2UL),
+    U64(0xb7dcbf53UL, 0x54e9beceUL), U64(0x0c11ed6dUL, 0x538aeb2fUL),
+    U64(0xe5d3ef28UL, 0x2a242e81UL), U64(0x8f1668c8UL, 0xa86da5faUL),
+    U64(0x8fa47579UL, 0x1a569d10UL), U64(0xf96e017dUL, 0x694487bcUL),
+    U64(0xb38d92d7UL, 0x60ec4455UL), U64(0x37c981dcUL, 0xc395a9acUL),
+    U64(0xe070f78dUL, 0x3927556aUL), U64(0x85bbe253UL, 0xf47b1417UL),
+    U64(0x8c469ab8UL, 0x43b89562UL), U64(0x93956d74UL, 0x78ccec8eUL),
+    U64(0xaf584166UL, 0x54a6babbUL), U64(0x387ac8d1UL, 0x970027b2UL),
+    U64(0xdb2e51bfUL, 0xe9d0696aUL), U64(0x06997b05UL, 0xfcc0319eUL),
+    U64(0x88fcf317UL, 0xf22241e2UL), U64(0x441fece3UL, 0xbdf81f03UL),
+    U64(0xab3c2fddUL, 0xeeaad25aUL), U64(0xd527e81cUL, 0xad7626c3UL),
+    U64(0xd60b3bd5UL, 0x6a5586f1UL), U64(0x8a71e223UL, 0xd8d3b074UL),
+    U64(0x85c70565UL, 0x62757456UL), U64(0xf6872d56UL, 0x67844e49UL),
+    U64(0xa738c6beUL, 0xbb12d16cUL), U64(0xb428f8acUL, 0x016561dbUL),
+    U64(0xd106f86eUL, 0x69d785c7UL), U64(0xe13336d7UL, 0x01beba52UL),
+    U64(0x82a45b45UL, 0x0226b39cUL), U64(0xecc00246UL, 0x61173473UL),
+    U64(0xa34d7216UL, 0x42b06084UL), U64(0x27f002d7UL, 0xf95d0190UL),
+    U64(0xcc20ce9bUL, 0xd35c78a5UL), U64(0x31ec038dUL, 0xf7b441f4UL),
+    U64(0xff290242UL, 0xc83396ceUL), U64(0x7e670471UL, 0x75a15271UL),
+    U64(0x9f79a169UL, 0xbd203e41UL), U64(0x0f0062c6UL, 0xe984d386UL),
+    U64(0xc75809c4UL, 0x2c684dd1UL), U64(0x52c07b78UL, 0xa3e60868UL),
+    U64(0xf92e0c35UL, 0x37826145UL), U64(0xa7709a56UL, 0xccdf8a82UL),
+    U64(0x9bbcc7a1UL, 0x42b17ccbUL), U64(0x88a66076UL, 0x400bb691UL),
+    U64(0xc2abf989UL, 0x935ddbfeUL), U64(0x6acff893UL, 0xd00ea435UL),
+    U64(0xf356f7ebUL, 0xf83552feUL), U64(0x0583f6b8UL, 0xc4124d43UL),
+    U64(0x98165af3UL, 0x7b2153deUL), U64(0xc3727a33UL, 0x7a8b704aUL),
+    U64(0xbe1bf1b0UL, 0x59e9a8d6UL), U64(0x744f18c0UL, 0x592e4c5cUL),
+    U64(0xeda2ee1cUL, 0x7064130cUL), U64(0x1162def0UL, 0x6f79df73UL),
+    U64(0x9485d4d1UL, 0xc63e8be7UL), U64(0x8addcb56UL, 0x45ac2ba8UL),
+    U64(0xb9a74a06UL, 0x37ce2ee1UL), U64(0x6d953e2bUL, 0xd7173692UL),
+    U64(0xe8111c87UL, 0xc5c1ba99UL), U64(0xc8fa8db6UL, 0xccdd0437UL),
+    U64(0x910ab1d4UL, 0xdb9914a0UL), U64(0x1d9c9892UL, 0x400a22a2UL),
+    U64(0xb54d5e4aUL, 0x127f59c8UL), U64(0x2503beb6UL, 0xd00cab4bUL),
+    U64(0xe2a0b5dcUL, 0x971f303aUL), U64(0x2e44ae64UL, 0x840fd61dUL),
+    U64(0x8da471a9UL, 0xde737e24UL), U64(0x5ceaecfeUL, 0xd289e5d2UL),
+    U64(0xb10d8e14UL, 0x56105dadUL), U64(0x7425a83eUL, 0x872c5f47UL),
+    U64(0xdd50f199UL, 0x6b947518UL), U64(0xd12f124eUL, 0x28f77719UL),
+    U64(0x8a5296ffUL, 0xe33cc92fUL), U64(0x82bd6b70UL, 0xd99aaa6fUL),
+    U64(0xace73cbfUL, 0xdc0bfb7bUL), U64(0x636cc64dUL, 0x1001550bUL),
+    U64(0xd8210befUL, 0xd30efa5aUL), U64(0x3c47f7e0UL, 0x5401aa4eUL),
+    U64(0x8714a775UL, 0xe3e95c78UL), U64(0x65acfaecUL, 0x34810a71UL),
+    U64(0xa8d9d153UL, 0x5ce3b396UL), U64(0x7f1839a7UL, 0x41a14d0dUL),
+    U64(0xd31045a8UL, 0x341ca07cUL), U64(0x1ede4811UL, 0x1209a050UL),
+    U64(0x83ea2b89UL, 0x2091e44dUL), U64(0x934aed0aUL, 0xab460432UL),
+    U64(0xa4e4b66bUL, 0x68b65d60UL), U64(0xf81da84dUL, 0x5617853fUL),
+    U64(0xce1de406UL, 0x42e3f4b9UL), U64(0x36251260UL, 0xab9d668eUL),
+    U64(0x80d2ae83UL, 0xe9ce78f3UL), U64(0xc1d72b7cUL, 0x6b426019UL),
+    U64(0xa1075a24UL, 0xe4421730UL), U64(0xb24cf65bUL, 0x8612f81fUL),
+    U64(0xc94930aeUL, 0x1d529cfcUL), U64(0xdee033f2UL, 0x6797b627UL),
+    U64(0xfb9b7cd9UL, 0xa4a7443cUL), U64(0x169840efUL, 0x017da3b1UL),
+    U64(0x9d412e08UL, 0x06e88aa5UL), U64(0x8e1f2895UL, 0x60ee864eUL),
+    U64(0xc491798aUL, 0x08a2ad4eUL), U64(0xf1a6f2baUL, 0xb92a27e2UL),
+    U64(0xf5b5d7ecUL, 0x8acb58a2UL), U64(0xae10af69UL, 0x6774b1dbUL),
+    U64(0x9991a6f3UL, 0xd6bf1765UL), U64(0xacca6da1UL, 0xe0a8ef29UL),
+    U64(0xbff610b0UL, 0xcc6edd3fUL), U64(0x17fd090aUL, 0x58d32af3UL),
+    U64(0xeff394dcUL, 0xff8a948eUL), U64(0xddfc4b4cUL, 0xef07f5b0UL),
+    U64(0x95f83d0aUL, 0x1fb69cd9UL), U64(0x4abdaf10UL, 0x1564f98eUL),
+    U64(0xbb764c4cUL, 0xa7a4440fUL), U64(0x9d6d1ad4UL, 0x1abe37f1UL),
+    U64(0xea53df5fUL, 0xd18d5513UL), U64(0x84c86189UL, 0x216dc5edUL),
+    U64(0x92746b9bUL, 0xe2f8552cUL), U64(0x32fd3cf5UL, 0xb4e49bb4UL),
+    U64(0xb7118682UL, 0xdbb66a77UL), U64(0x3fbc8c33UL, 0x221dc2a1UL),
+    U64(0xe4d5e823UL, 0x92a40515UL), U64(0x0fabaf3fUL, 0xeaa5334aUL),
+    U64(0x8f05b116UL, 0x3ba6832dUL), U64(0x29cb4d87UL, 0xf2a7400eUL),
+    U64(0xb2c71d5bUL, 0xca9023f8UL), U64(0x743e20e9UL, 0xef511012UL),
+    U64(0xdf78e4b2UL, 0xbd342cf6UL), U64(0x914da924UL, 0x6b255416UL),
+    U64(0x8bab8eefUL, 0xb6409c1aUL), U64(0x1ad089b6UL, 0xc2f7548eUL),
+    U64(0xae9672abUL, 0xa3d0c320UL), U64(0xa184ac24UL, 0x73b529b1UL),
+    U64(0xda3c0f56UL, 0x8cc4f3e8UL), U64(0xc9e5d72dUL, 0x90a2741eUL),
+    U64(0x88658996UL, 0x17fb1871UL), U64(0x7e2fa67cUL, 0x7a658892UL),
+    U64(0xaa7eebfbUL, 0x9df9de8dUL), U64(0xddbb901bUL, 0x98feeab7UL),
+    U64(0xd51ea6faUL, 0x85785631UL), U64(0x552a7422UL, 0x7f3ea565UL),
+    U64(0x8533285cUL, 0x936b35deUL), U64(0xd53a8895UL, 0x8f87275fUL),
+    U64(0xa67ff273UL, 0xb8460356UL), U64(0x8a892abaUL, 0xf368f137UL),
+    U64(0xd01fef10UL, 0xa657842cUL), U64(0x2d2b7569UL, 0xb0432d85UL),
+    U64(0x8213f56aUL, 0x67f6b29bUL), U64(0x9c3b2962UL, 0x0e29fc73UL),
+    U64(0xa298f2c5UL, 0x01f45f42UL), U64(0x8349f3baUL, 0x91b47b8fUL),
+    U64(0xcb3f2f76UL, 0x42717713UL), U64(0x241c70a9UL, 0x36219a73UL),
+    U64(0xfe0efb53UL, 0xd30dd4d7UL), U64(0xed238cd3UL, 0x83aa0110UL),
+    U64(0x9ec95d14UL, 0x63e8a506UL), U64(0xf4363804UL, 0x324a40aaUL),
+    U64(0xc67bb459UL, 0x7ce2ce48UL), U64(0xb143c605UL, 0x3edcd0d5UL),
+    U64(0xf81aa16fUL, 0xdc1b81daUL), U64(0xdd94b786UL, 0x8e94050aUL),
+    U64(0x9b10a4e5UL, 0xe9913128UL), U64(0xca7cf2b4UL, 0x191c8326UL),
+    U64(0xc1d4ce1fUL, 0x63f57d72UL), U64(0xfd1c2f61UL, 0x1f63a3f0UL),
+    U64(0xf24a01a7UL, 0x3cf2dccfUL), U64(0xbc633b39UL, 0x673c8cecUL),
+    U64(0x976e4108UL, 0x8617ca01UL), U64(0xd5be0503UL, 0xe085d813UL),
+    U64(0xbd49d14aUL, 0xa79dbc82UL), U64(0x4b2d8644UL, 0xd8a74e18UL),
+    U64(0xec9c459dUL, 0x51852ba2UL), U64(0xddf8e7d6UL, 0x0ed1219eUL),
+    U64(0x93e1ab82UL, 0x52f33b45UL), U64(0xcabb90e5UL, 0xc942b503UL),
+    U64(0xb8da1662UL, 0xe7b00a17UL), U64(0x3d6a751fUL, 0x3b936243UL),
+    U64(0xe7109bfbUL, 0xa19c0c9dUL), U64(0x0cc51267UL, 0x0a783ad4UL),
+    U64(0x906a617dUL, 0x450187e2UL), U64(0x27fb2b80UL, 0x668b24c5UL),
+    U64(0xb484f9dcUL, 0x9641e9daUL), U64(0xb1f9f660UL, 0x802dedf6UL),
+    U64(0xe1a63853UL, 0xbbd26451UL), U64(0x5e7873f8UL, 0xa0396973UL),
+    U64(0x8d07e334UL, 0x55637eb2UL), U64(0xdb0b487bUL, 0x6423e1e8UL),
+    U64(0xb049dc01UL, 0x6abc5e5fUL), U64(0x91ce1a9aUL, 0x3d2cda62UL),
+    U64(0xdc5c5301UL, 0xc56b75f7UL), U64(0x7641a140UL, 0xcc7810fbUL),
+    U64(0x89b9b3e1UL, 0x1b6329baUL), U64(0xa9e904c8UL, 0x7fcb0a9dUL),
+    U64(0xac2820d9UL, 0x623bf429UL), U64(0x546345faUL, 0x9fbdcd44UL),
+    U64(0xd732290fUL, 0xbacaf133UL), U64(0xa97c1779UL, 0x47ad4095UL),
+    U64(0x867f59a9UL, 0xd4bed6c0UL), U64(0x49ed8eabUL, 0xcccc485dUL),
+    U64(0xa81f3014UL, 0x49ee8c70UL), U64(0x5c68f256UL, 0xbfff5a74UL),
+    U64(0xd226fc19UL, 0x5c6a2f8cUL), U64(0x73832eecUL, 0x6fff3111UL),
+    U64(0x83585d8fUL, 0xd9c25db7UL), U64(0xc831fd53UL, 0xc5ff7eabUL),
+    U64(0xa42e74f3UL, 0xd032f525UL), U64(0xba3e7ca8UL, 0xb77f5e55UL),
+    U64(0xcd3a1230UL, 0xc43fb26fUL), U64(0x28ce1bd2UL, 0xe55f35ebUL),
+    U64(0x80444b5eUL, 0x7aa7cf85UL), U64(0x7980d163UL, 0xcf5b81b3UL),
+    U64(0xa0555e36UL, 0x1951c366UL), U64(0xd7e105bcUL, 0xc332621fUL),
+    U64(0xc86ab5c3UL, 0x9fa63440UL), U64(0x8dd9472bUL, 0xf3fefaa7UL),
+    U64(0xfa856334UL, 0x878fc150UL), U64(0xb14f98f6UL, 0xf0feb951UL),
+    U64(0x9c935e00UL, 0xd4b9d8d2UL), U64(0x6ed1bf9aUL, 0x569f33d3UL),
+    U64(0xc3b83581UL, 0x09e84f07UL), U64(0x0a862f80UL, 0xec4700c8UL),
+    U64(0xf4a642e1UL, 0x4c6262c8UL), U64(0xcd27bb61UL, 0x2758c0faUL),
+    U64(0x98e7e9ccUL, 0xcfbd7dbdUL), U64(0x8038d51cUL, 0xb897789cUL),
+    U64(0xbf21e440UL, 0x03acdd2cUL), U64(0xe0470a63UL, 0xe6bd56c3UL),
+    U64(0xeeea5d50UL, 0x04981478UL), U64(0x1858ccfcUL, 0xe06cac74UL),
+    U64(0x95527a52UL, 0x02df0ccbUL), U64(0x0f37801eUL, 0x0c43ebc8UL),
+    U64(0xbaa718e6UL, 0x8396cffdUL), U64(0xd3056025UL, 0x8f54e6baUL),
+    U64(0xe950df20UL, 0x247c83fdUL), U64(0x47c6b82eUL, 0xf32a2069UL),
+    U64(0x91d28b74UL, 0x16cdd27eUL), U64(0x4cdc331dUL, 0x57fa5441UL),
+    U64(0xb6472e51UL, 0x1c81471dUL), U64(0xe0133fe4UL, 0xadf8e952UL),
+    U64(0xe3d8f9e5UL, 0x63a198e5UL), U64(0x58180fddUL, 0xd97723a6UL),
+    U64(0x8e679c2fUL, 0x5e44ff8fUL), U64(0x570f09eaUL, 0xa7ea7648UL)
+};
+
+static void multiply_128(const json_uint a, const json_uint b, json_uint* const high, json_uint* const low) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ unsigned __int128 product = (unsigned __int128)a * b;
+    *high = (json_uint)(product >> 64);
+    *low = (json_uint)product;
+#else
+    json_uint a_lo = a & 0xffffffffUL, a_hi = a >> 32;
+    json_uint b_lo = b & 0xffffffffUL, b_hi = b >> 32;
+    json_uint lo_lo = a_lo * b_lo, lo_hi = a_lo * b_hi;
+    json_uint hi_lo = a_hi * b_lo, hi_hi = a_hi * b_hi;
+    json_uint middle = (lo_lo >> 32) + (lo_hi & 0xffffffffUL) + (hi_lo & 0xffffffffUL);
+
+    *low = (middle << 32) | (lo_lo & 0xffffffffUL);
+    *high = hi_hi + (lo_hi >> 32) + (hi_lo >> 32) + (middle >> 32);
+#endif
+}
+
+static int leading_zeroes(json_uint value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(value);
+#else
+    int count = 0;
+
+    while (!(value & U64(0x80000000UL, 0))) {
+        value <<= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+static double double_from_bits(const json_uint mantissa, const json_uint exponent, const bool negative) {
+    json_uint bits = mantissa | (exponent << 52) | ((json_uint)negative << 63);
+    double d;
+
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+/*
+ * mantissa * 10^exponent, correctly rounded with the Eisel-Lemire algorithm.
+ * mantissa must not be 0 and exponent must be within the power table.
+ * Returns false in the rare cases it can't decide how to round.
+ */
+static bool eisel_lemire(json_uint mantissa, const long exponent, const bool negative, double* const out) {
+    const json_uint *power = &powers_of_five[2 * (exponent - POWER_OF_FIVE_MIN)];
+    json_uint upper, lower, low_upper, low_lower, upper_bit, middle;
+    long binary_exponent;
+    int lz;
+
+    lz = leading_zeroes(mantissa);
+    mantissa <<= lz;
+
+    multiply_128(mantissa, power[0], &upper, &lower);
+
+    /* the truncated product may be one too small, look at the low half of the power */
+    if ((upper & 0x1ff) == 0x1ff && lower + mantissa < lower) {
+        multiply_128(mantissa, power[1], &low_upper, &low_lower);
+        middle = lower + low_upper;
+        if (middle < lower)
+            ++upper;
+        if (middle + 1 == 0 && (upper & 0x1ff) == 0x1ff && low_lower + mantissa < low_lower)
+            return false;
+        lower = middle;
+    }
+
+    upper_bit = upper >> 63;
+    mantissa = upper >> (upper_bit + 9);
+    lz += (int)(1 ^ upper_bit);
+
+    /* 1024 + 63 + floor(log2(5^exponent)) + exponent, 152170 / 2^16 being about log2(5) */
+    binary_exponent = (((152170L + 65536L) * exponent) >> 16) + 1024 + 63 - lz;
+
+    if (binary_exponent <= 0) {
+        /* subnormal, or too small for even that */
+        if (-binary_exponent + 1 >= 64) {
+            *out = double_from_bits(0, 0, negative);
+            return true;
+        }
+        mantissa >>= -binary_exponent + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        *out = double_from_bits(mantissa & ~((json_uint)1 << 52),
+                                mantissa < ((json_uint)1 << 52) ? 0 : 1, negative);
+        return true;
+    }
+
+    /* exactly halfway, round to even */
+    if (lower <= 1 && exponent >= -4 && exponent <= 23 && (mantissa & 3) == 1 &&
+        (mantissa << (upper_bit + 64 - 53 - 2)) == upper)
+        mantissa &= ~(json_uint)1;
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+
+    if (mantissa >= ((json_uint)1 << 53)) {
+        mantissa = (json_uint)1 << 52;
+        ++binary_exponent;
+    }
+
+    if (binary_exponent > 2046)
+        return false; /* infinite, let strtod have the final word */
+
+    *out = double_from_bits(mantissa & ~((json_uint)1 << 52), (json_uint)binary_exponent, negative);
+    return true;
+}
+
+/*
+ * Enough significant digits to round any double correctly: the halfway
+ * points between doubles have at most 767. Past them, all that matters is
+ * whether any digit isn't zero.
+ */
+#define NUMBER_FALLBACK_DIGITS 770
+
+/* exponents are counted up to this, far past infinite or zero, and add up without overflowing */
+#define NUMBER_FALLBACK_EXPONENT (LONG_MAX / 4)
+
+/*
+ * The slow path, for inputs the fast ones can't round. The number was
+ * already validated. It is rewritten as integer digits and an exponent,
+ * without a decimal point, so strtod reads it the same in every locale.
+ * Digits past NUMBER_FALLBACK_DIGITS are folded into one that is 0 or 1.
+ */
+static double number_fallback(const char *p, const size_t length) {
+    char buffer[NUMBER_FALLBACK_DIGITS + 32];
+    const char *cur = p;
+    size_t used = 0, digits = 0;
+    long exponent = 0, explicit_exponent = 0;
+    bool fraction = false, sticky = false, exponent_negative;
+
+    if (PEEK(cur) == '-')
+        buffer[used++] = *cur++;
+
+    for (; IN_BOUNDS(cur) && (IS_DIGIT(*cur) || *cur == '.'); ++cur) {
+        if (*cur == '.') {
+            fraction = true;
+        } else if (digits == 0 && *cur == '0') {
+            /* leading zeroes only move the point */
+            if (fraction && exponent > -NUMBER_FALLBACK_EXPONENT)
+                --exponent;
+        } else if (digits < NUMBER_FALLBACK_DIGITS) {
+            buffer[used++] = *cur;
+            ++digits;
+            exponent -= fraction;
+        } else {
+            sticky |= *cur != '0';
+            if (!fraction && exponent < NUMBER_FALLBACK_EXPONENT)
+                ++exponent;
+        }
+    }
+
+    if (digits == 0)
+        buffer[used++] = '0';
+    if (sticky) {
+        buffer[used++] = '1';
+        --exponent;
+    }
+
+    if (PEEK(cur) == 'e' || PEEK(cur) == 'E') {
+        ++cur;
+        exponent_negative = PEEK(cur) == '-';
+        if (PEEK(cur) == '-' || PEEK(cur) == '+')
+            ++cur;
+        for (; IN_BOUNDS(cur) && IS_DIGIT(*cur); ++cur) {
+            if (explicit_exponent < NUMBER_FALLBACK_EXPONENT)
+                explicit_exponent = explicit_exponent * 10 + (*cur - '0');
+        }
+        exponent += exponent_negative ? -explicit_exponent : explicit_exponent;
+    }
+
+    sprintf(buffer + used, "e%ld", exponent);
+    return strtod(buffer, NULL);
+}
+
+static double number_to_double(const char *p, const size_t length, const json_uint mantissa,
+                               const long exponent, const bool negative, const bool truncated) {
+    double number, upper_bound;
+
+    if (mantissa == 0)
+        return negative ? -0.0 : 0.0;
+
+    /* both mantissa and 10^exponent are exact, so one operation rounds correctly */
+#if NUMBER_EVAL_METHOD == 0
+    if (!truncated && mantissa <= ((json_uint)1 << 53) && exponent >= -22 && exponent <= 22) {
+        number = (double)mantissa;
+        if (exponent < 0)
+            number /= exact_powers_of_ten[-exponent];
+        else
+            number *= exact_powers_of_ten[exponent];
+        return negative ? -number : number;
+    }
+#endif
+
+    if (exponent < POWER_OF_FIVE_MIN)
+        return negative ? -0.0 : 0.0;
+
+    if (exponent <= POWER_OF_FIVE_MAX && eisel_lemire(mantissa, exponent, negative, &number)) {
+        /* dropped digits put the real value between mantissa and mantissa + 1 */
+        if (!truncated ||
+            (eisel_lemire(mantissa + 1, exponent, negative, &upper_bound) && upper_bound == number))
+            return number;
+    }
+
+    return number_fallback(p, length);
+}
+
+size_t number_parse(const char *p, const size_t length, struct JsonNumber* const out) {
+    const char *cur = p;
+    json_uint mantissa = 0;
+    long exponent = 0, explicit_exponent = 0;
+    int digits = 0;
+    bool negative = false, truncated = false, integer = true, exponent_negative;
+
+    if (PEEK(cur) == '-') {
+        negative = true;
+        ++cur;
+    }
+
+    if (PEEK(cur) == '0') {
+        ++cur;
+        if (IS_DIGIT(PEEK(cur)))
+            return 0; /* no leading zeroes */
+    } else if (IS_DIGIT(PEEK(cur))) {
+        for (; IN_BOUNDS(cur) && IS_DIGIT(*cur); ++cur) {
+            if (digits < NUMBER_MAX_DIGITS) {
+                mantissa = mantissa * 10 + (*cur - '0');
+                ++digits;
+            } else {
+                ++exponent;
+                truncated |= *cur != '0';
+            }
+        }
+    } else {
+        return 0;
+    }
+
+    if (PEEK(cur) == '.') {
+        integer = false;
+        ++cur;
+        if (!IS_DIGIT(PEEK(cur)))
+            return 0;
+        for (; IN_BOUNDS(cur) && IS_DIGIT(*cur); ++cur) {
+            if (digits < NUMBER_MAX_DIGITS) {
+                mantissa = mantissa * 10 + (*cur - '0');
+                --exponent;
+                /* zeroes in front of the first significant digit don't count */
+                if (mantissa != 0)
+                    ++digits;
+            } else {
+                truncated |= *cur != '0';
+            }
+        }
+    }
+
+    if (PEEK(cur) == 'e' || PEEK(cur) == 'E') {
+        integer = false;
+        ++cur;
+        exponent_negative = PEEK(cur) == '-';
+        if (exponent_negative || PEEK(cur) == '+')
+            ++cur;
+        if (!IS_DIGIT(PEEK(cur)))
+            return 0;
+        for (; IN_BOUNDS(cur) && IS_DIGIT(*cur); ++cur) {
+            /* anything this big is zero or infinity already */
+            if (explicit_exponent < 100000)
+                explicit_exponent = explicit_exponent * 10 + (*cur - '0');
+        }
+        exponent += exponent_negative ? -explicit_exponent : explicit_exponent;
+    }
+
+    /* -0 stays a double, to keep its sign */
+    if (integer && exponent == 0 && (digits > 0 || !negative)) {
+        if (!negative && mantissa <= U64(0x7fffffffUL, 0xffffffffUL)) {
+            out->integer = true;
+            out->as.integer = (json_int)mantissa;
+            return cur - p;
+        }
+        if (negative && mantissa <= U64(0x80000000UL, 0)) {
+            out->integer = true;
+            out->as.integer = -(json_int)(mantissa - 1) - 1;
+            return cur - p;
+        }
+    }
+
+    out->integer = false;
+    out->as.number = number_to_double(p, cur - p, mantissa, exponent, negative, truncated);
+    return cur - p;
+}
+
+/*
+ * Formatting, shortest digits first with Grisu3. It works on 64-bit
+ * floating point values of its own, f * 2^e, and finds the fewest digits
+ * that lie within the rounding boundaries of the double. In the rare cases
+ * the limited precision leaves it unsure, it gives up and printf decides.
+ */
+
+struct DiyFp {
+    json_uint f;
+    int e;
+};
+
+/* the product rounded to 64 bits */
+static struct DiyFp diy_multiply(const struct DiyFp a, const struct DiyFp b) {
+    struct DiyFp product;
+    json_uint low;
+
+    multiply_128(a.f, b.f, &product.f, &low);
+    product.f += low >> 63;
+    product.e = a.e + b.e + 64;
+    return product;
+}
+
+static struct DiyFp diy_normalize(struct DiyFp value) {
+    int shift = leading_zeroes(value.f);
+
+    value.f <<= shift;
+    value.e -= shift;
+    return value;
+}
+
+/*
+ * Move the last digit down while that brings the digits closer to w, then
+ * check the result is certain to be inside the boundaries. All distances
+ * are in units of the last digit's fraction.
+ */
+static bool grisu_round_weed(char* const digits, const int length, const json_uint too_high_to_w,
+                             const json_uint unsafe_interval, json_uint rest, const json_uint ten_kappa,
+                             const json_uint unit) {
+    json_uint small_distance = too_high_to_w - unit;
+    json_uint big_distance = too_high_to_w + unit;
+
+    while (rest < small_distance && unsafe_interval - rest >= ten_kappa &&
+           (rest + ten_kappa < small_distance ||
+            small_distance - rest >= rest + ten_kappa - small_distance)) {
+        --digits[length - 1];
+        rest += ten_kappa;
+    }
+
+    /* the other end of w's uncertainty would round differently */
+    if (rest < big_distance && unsafe_interval - rest >= ten_kappa &&
+        (rest + ten_kappa < big_distance ||
+         big_distance - rest > rest + ten_kappa - big_distance))
+        return false;
+
+    return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+}
+
+/* generate digits of w until they are within low and high, the exponent of the last one goes into kappa */
+static bool grisu_digits(const struct DiyFp low, const struct DiyFp w, const struct DiyFp high,
+                         char* const digits, int* const length, int* const kappa) {
+    json_uint unit = 1, one = (json_uint)1 << -w.e;
+    json_uint too_low = low.f - unit, too_high = high.f + unit;
+    json_uint unsafe_interval = too_high - too_low;
+    json_uint fractionals = too_high & (one - 1), rest;
+    unsigned long integrals = (unsigned long)(too_high >> -w.e), divisor = 1;
+
+    *kappa = 1;
+    while (integrals / divisor >= 10) {
+        divisor *= 10;
+        ++*kappa;
+    }
+
+    *length = 0;
+    while (*kappa > 0) {
+        digits[(*length)++] = (char)('0' + integrals / divisor);
+        integrals %= divisor;
+        --*kappa;
+
+        rest = ((json_uint)integrals << -w.e) + fractionals;
+        if (rest < unsafe_interval)
+            return grisu_round_weed(digits, *length, too_high - w.f, unsafe_interval, rest,
+                                    (json_uint)divisor << -w.e, unit);
+        divisor /= 10;
+    }
+
+    for (;;) {
+        fractionals *= 10;
+        unit *= 10;
+        unsafe_interval *= 10;
+
+        digits[(*length)++] = (char)('0' + (int)(fractionals >> -w.e));
+        fractionals &= one - 1;
+        --*kappa;
+
+        if (fractionals < unsafe_interval)
+            return grisu_round_weed(digits, *length, (too_high - w.f) * unit, unsafe_interval,
+                                    fractionals, one, unit);
+    }
+}
+
+/* the shortest digits of a positive number, which is digits * 10^exponent */
+static bool grisu3(const double number, char* const digits, int* const length, int* const exponent) {
+    struct DiyFp w, plus, minus, power;
+    const json_uint *five;
+    json_uint bits;
+    long q, minimum;
+    int kappa, biased;
+    bool lower_closer;
+
+    memcpy(&bits, &number, sizeof(bits));
+    biased = (int)(bits >> 52 & 0x7ff);
+    w.f = bits & (((json_uint)1 << 52) - 1);
+    w.e = biased == 0 ? -1074 : biased - 1075;
+
+    /* the boundaries are halfway to the neighbours, the one below is closer at powers of two */
+    lower_closer = w.f == 0 && biased > 1;
+    if (biased != 0)
+        w.f |= (json_uint)1 << 52;
+
+    plus.f = (w.f << 1) + 1;
+    plus.e = w.e - 1;
+    minus.f = lower_closer ? (w.f << 2) - 1 : (w.f << 1) - 1;
+    minus.e = lower_closer ? w.e - 2 : w.e - 1;
+
+    plus = diy_normalize(plus);
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+    w = diy_normalize(w);
+
+    /* scale by 10^q so that w's binary exponent lands between -60 and -32 */
+    minimum = -60 - (w.e + 64);
+    q = ((minimum + 63) * 78913L) / 262144L;
+    while ((((152170L + 65536L) * q) >> 16) - 63 < minimum)
+        ++q;
+    while ((((152170L + 65536L) * (q - 1)) >> 16) - 63 >= minimum)
+        --q;
+    if (q < POWER_OF_FIVE_MIN || q > POWER_OF_FIVE_MAX)
+        return false;
+
+    five = &powers_of_five[2 * (q - POWER_OF_FIVE_MIN)];
+    power.f = five[0] + (five[1] >> 63);
+    power.e = (int)((((152170L + 65536L) * q) >> 16) - 63);
+
+    if (!grisu_digits(diy_multiply(minus, power), diy_multiply(w, power), diy_multiply(plus, power),
+                      digits, length, &kappa))
+        return false;
+
+    *exponent = kappa - (int)q;
+    return true;
+}
+
+/* the shortest digits printf finds, for the numbers grisu3 gives up on */
+static void number_format_fallback(const double number, char* const digits, int* const length,
+                                   int* const exponent) {
+    char printed[40];
+    int precision, i;
+
+    /* any decimal of up to 15 digits survives the trip through a normal double */
+    for (precision = number < 2.2250738585072014e-308 ? 1 : 15; precision < 17; ++precision) {
+        sprintf(printed, "%.*e", precision - 1, number);
+        if (strtod(printed, NULL) == number)
+            break;
+    }
+    if (precision == 17)
+        sprintf(printed, "%.16e", number);
+
+    /* d.ddde-x, whatever the locale's decimal point is */
+    *length = 0;
+    for (i = 0; printed[i] != 'e'; ++i) {
+        if (IS_DIGIT(printed[i]))
+            digits[(*length)++] = printed[i];
+    }
+    *exponent = atoi(&printed[i + 1]) - (*length - 1);
+}
+
+/* write the digits of value at out, returning how many there are */
+static int number_format_digits(char* const out, json_uint value) {
+    char digits[24];
+    int length = 0, i;
+
+    do {
+        digits[length++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    for (i = 0; i < length; ++i)
+        out[i] = digits[length - 1 - i];
+    return length;
+}
+
+size_t number_format(const double number, char* const out) {
+    static const double exact = 9007199254740992.0; /* 2^53 */
+    double magnitude = number;
+    char digits[24], *cur = out;
+    int length, exponent, point;
+    json_uint bits;
+
+    memcpy(&bits, &number, sizeof(bits));
+    if (bits >> 63) {
+        *cur++ = '-';
+        magnitude = -number;
+    }
+
+    /* whole numbers are common and easy */
+    if (magnitude < exact && magnitude == (double)(json_uint)magnitude) {
+        length = number_format_digits(digits, (json_uint)magnitude);
+        exponent = 0;
+    } else if (!grisu3(magnitude, digits, &length, &exponent)) {
+        number_format_fallback(magnitude, digits, &length, &exponent);
+    }
+
+    while (length > 1 && digits[length - 1] == '0') {
+        --length;
+        ++exponent;
+    }
+
+    /* the decimal point goes after the first point digits, like printf's %g would put it */
+    point = length + exponent;
+
+    if (point > 0 && point <= 17) {
+        if (length <= point) {
+            memcpy(cur, digits, length);
+            memset(cur + length, '0', point - length);
+            cur += point;
+            *cur++ = '.';
+            *cur++ = '0';
+        } else {
+            memcpy(cur, digits, point);
+            cur[point] = '.';
+            memcpy(cur + point + 1, digits + point, length - point);
+            cur += length + 1;
+        }
+    } else if (point <= 0 && point > -4) {
+        *cur++ = '0';
+        *cur++ = '.';
+        memset(cur, '0', -point);
+        memcpy(cur - point, digits, length);
+        cur += length - point;
+    } else {
+        *cur++ = digits[0];
+        if (length > 1) {
+            *cur++ = '.';
+            memcpy(cur, digits + 1, length - 1);
+            cur += length - 1;
+        }
+        *cur++ = 'e';
+        if (point - 1 < 0)
+            *cur++ = '-';
+        cur += number_format_digits(cur, (json_uint)(point - 1 < 0 ? 1 - point : point - 1));
+    }
+
+    *cur = '\0';
+    return (size_t)(cur - out);
+}
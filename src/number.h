@@ -0,0 +1,64 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JSON_NUMBER_H
+#define JSON_NUMBER_H
+
+#include "types.h"
+
+#include <stddef.h>
+
+/* a parsed number, integers that fit a json_int are kept exact */
+struct JsonNumber {
+    bool integer; /* whether as.integer or as.number is set */
+    union {
+        double number;
+        json_int integer;
+    } as;
+};
+
+/*
+ * Parse the json number at p into out, reading at most length bytes
+ * ((size_t)-1 if p is NUL-terminated). Integers that fit a json_int stay
+ * integers, everything else becomes a correctly rounded double. Exactly the
+ * json grammar is accepted, independent of the current locale.
+ *
+ * Returns the amount of bytes consumed, or 0 if p doesn't start with a
+ * valid json number.
+ */
+size_t number_parse(const char *p, const size_t length, struct JsonNumber* const out);
+
+/* the most number_format writes, terminator included */
+#define NUMBER_FORMAT_MAX 32
+
+/*
+ * Write the finite number at out, NUL-terminated, in the fewest digits that
+ * read back as exactly the same double. There's always a fraction or an
+ * exponent, so the text doesn't read back as an integer. Returns the
+ * length of the text.
+ */
+size_t number_format(const double number, char* const out);
+
+#endif /* JSON_NUMBER_H */
@@ -27,16 +27,34 @@
  * JSONFC, an easy to use and portable json parser for C.
  */
 
+/* files are mapped into memory where the system has mmap */
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+# define JSON_MMAP
+# ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L
+# endif
+#endif
+
 #include "types.h"
 #include "parser.h"
+#include "number.h"
+#include "scan.h"
+#include "index.h"
+#include "stats.h"
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+#ifdef JSON_MMAP
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
 
 /*
  * TODO: carriage return support
- * TODO: unicode support
- * FIXME: deallocate everything on failure
  */
 
 /* set this to true if you want colored output */
@@ -45,51 +63,122 @@ bool json_print_double_quoted = false;
 bool json_print_key_as_string = false;
 
 
-/* forwards */
-static bool parse_as_value(struct JsonParser *parser, struct Value* const out);
+/*
+ * The stream either ends after length bytes or, if length is
+ * PARSER_NUL_TERMINATED, at its terminator. The terminated kind is scanned
+ * with the faster unbounded kernels and never needs a strlen.
+ */
+#define PARSER_NUL_TERMINATED ((size_t)-1)
+#define AT_END(p) ((p).idx >= (p).length || \
+                   ((p).length == PARSER_NUL_TERMINATED && (p).stream[(p).idx] == '\0'))
 
-void parser_construct(struct JsonParser* const parser, char* const stream) {
+/* everything but head */
+static void parser_init(struct JsonParser* const parser, char* const stream,
+                        const size_t length, struct Arena* const arena) {
     parser->stream = stream;
     parser->idx = 0;
-    parser->line = 1;
-    parser->column = 1;
-    parser->head = malloc(sizeof(struct Value));
+    parser->length = length;
+    parser->error = NULL;
+    parser->arena = arena;
+    parser->in_situ = false;
+    parser->no_nul = false;
+    parser->keys = NULL;
+    parser->handler = NULL;
+    parser->scratch = NULL;
+    parser->scratch_allocated = 0;
+    parser->sizes = NULL;
+    parser->sizes_count = 0;
+    parser->nesting = parser->local_nesting;
+    parser->depth = 0;
+    parser->nesting_allocated = PARSER_LOCAL_DEPTH;
+    parser->max_depth = JSON_MAX_DEPTH_DEFAULT;
+    parser->head = NULL;
 }
 
-static bool parser_advance(struct JsonParser* const parser, const size_t amount) {
-    size_t i;
+static void parser_construct_in(struct JsonParser* const parser, char* const stream,
+                                const size_t length, struct Arena* const arena) {
+    parser_init(parser, stream, length, arena);
+    parser->head = arena_alloc(arena, sizeof(struct Value));
+}
 
-    for (i = 0; i < amount; ++i) {
-        switch (CURRENT_CHAR(*parser)) {
-        case '\0':
-            return false;
-        case '\n':
-            ++parser->line;
-            parser->column = 1;
-            break;
-        default:
-            ++parser->column;
-            break;
-        }
-        ++parser->idx;
-    }
+void parser_construct(struct JsonParser* const parser, char* const stream) {
+    parser_construct_in(parser, stream, PARSER_NUL_TERMINATED, NULL);
+}
 
-    return true;
+static void parser_destruct(struct JsonParser* const parser) {
+    json_free(ARENA_ALLOCATOR(parser->arena), parser->scratch);
+    parser->scratch = NULL;
+    parser->scratch_allocated = 0;
+
+    if (parser->nesting != parser->local_nesting)
+        json_free(ARENA_ALLOCATOR(parser->arena), parser->nesting);
+    parser->nesting = parser->local_nesting;
+    parser->depth = 0;
+    parser->nesting_allocated = PARSER_LOCAL_DEPTH;
+}
+
+#define parser_advance(parser, amount) ((parser)->idx += (amount))
+
+/* remember why parsing failed, the innermost failure is the interesting one */
+static bool parser_fail(struct JsonParser* const parser, const char* const reason) {
+    if (parser->error == NULL)
+        parser->error = reason;
+    return false;
 }
 
+/* call a handler callback if it is set, returning false from it aborts the parse */
+#define EMIT(parser, callback, arguments) \
+    ((parser)->handler->callback == NULL || \
+     (STATS_START(JSON_STATS_HANDLER), \
+      STATS_STOP_WITH(JSON_STATS_HANDLER, (parser)->handler->callback arguments)) || \
+     parser_fail((parser), "aborted by handler"))
+
 static bool parser_clean(struct JsonParser* const parser) {
-    size_t start = parser->idx;
+    const char *cur = parser->stream + parser->idx;
+    size_t amount;
 
-    while (CURRENT_CHAR(*parser) == ' '  || CURRENT_CHAR(*parser) == '\n' ||
-           CURRENT_CHAR(*parser) == '\t' || CURRENT_CHAR(*parser) == '\r')
-        parser_advance(parser, 1);
+    STATS_START(JSON_STATS_WHITESPACE);
+    amount = parser->length == PARSER_NUL_TERMINATED ? scan_whitespace(cur) :
+             scan_whitespace_n(cur, parser->length - parser->idx);
+    STATS_STOP(JSON_STATS_WHITESPACE);
+    STATS_ADD(whitespace_bytes, amount);
 
-    if (start == parser->idx)
+    if (amount == 0)
         return false; /* didn't clean anything */
 
+    parser_advance(parser, amount);
+    return true;
+}
+
+/* make room for size bytes in the scratch buffer escaped strings are decoded into */
+static bool parser_reserve_scratch(struct JsonParser* const parser, const size_t size) {
+    size_t allocated = parser->scratch_allocated ? parser->scratch_allocated : 64;
+    char *scratch;
+
+    if (size <= parser->scratch_allocated)
+        return true;
+
+    while (allocated < size)
+        allocated *= 2;
+
+    STATS_ADD(scratch_reallocs, parser->scratch_allocated != 0);
+    scratch = json_realloc(ARENA_ALLOCATOR(parser->arena), parser->scratch, allocated);
+    if (scratch == NULL)
+        return parser_fail(parser, "out of memory");
+
+    parser->scratch = scratch;
+    parser->scratch_allocated = allocated;
     return true;
 }
 
+static size_t parser_scan_string(const struct JsonParser* const parser) {
+    const char *cur = parser->stream + parser->idx;
+
+    if (parser->length == PARSER_NUL_TERMINATED)
+        return scan_string(cur);
+    return scan_string_n(cur, parser->length - parser->idx);
+}
+
 static bool match(struct JsonParser* const parser, const char *const stream) {
     size_t i;
 
@@ -97,252 +186,928 @@ static bool match(struct JsonParser* const parser, const char *const stream) {
         if (stream[i] != CHAR_AT(*parser, i))
             return false;
 
+    STATS_ADD(literals, 1);
+    STATS_ADD(literal_bytes, i);
     parser_advance(parser, i);
     return true;
 }
 
-static bool parse_as_number(struct JsonParser* const parser, double* const out) {
-    /* FIXME: this function shouldn't support extended bases */
-    char *end;
-    double number = strtod(&CURRENT_CHAR(*parser), &end);
+static bool parse_as_number(struct JsonParser* const parser) {
+    struct JsonNumber number;
+    size_t length;
 
-    if (end == &CURRENT_CHAR(*parser) && number == 0)
-        return false;
+    STATS_START(JSON_STATS_NUMBERS);
+    length = number_parse(parser->stream + parser->idx, parser->length - parser->idx, &number);
+    STATS_STOP(JSON_STATS_NUMBERS);
 
-    parser_advance(parser, end - &CURRENT_CHAR(*parser));
-    *out = number;
+    if (length == 0)
+        return parser_fail(parser, "invalid number");
 
-    return true;
+    STATS_ADD(numbers, 1);
+    STATS_ADD(number_bytes, length);
+
+    parser_advance(parser, length);
+
+    /* integers go to on_number as doubles if there's no on_int */
+    if (number.integer && parser->handler->on_int != NULL)
+        return EMIT(parser, on_int, (parser->handler->context, number.as.integer));
+    if (number.integer)
+        number.as.number = (double)number.as.integer;
+    return EMIT(parser, on_number, (parser->handler->context, number.as.number));
 }
 
-static bool parse_as_string(struct JsonParser* const parser, char** const out, const bool allow_escapes) {
-    size_t write_idx, len;
-    write_idx = 0;
-    len = 12;
+/* take the run of plain string characters at idx, failing at the first byte that isn't UTF-8 */
+static bool parser_take_run(struct JsonParser* const parser, const size_t run) {
+    const size_t valid = scan_utf8_n(parser->stream + parser->idx, run);
 
-    if (CURRENT_CHAR(*parser) != '"')
-        return false;
+    parser_advance(parser, valid);
+    return valid == run || parser_fail(parser, "invalid UTF-8");
+}
+
+/*
+ * Deal with whatever ended a run of plain string characters. Returns '"' at
+ * the end of the string, '\\' after decoding an escape into decoded (up to
+ * 4 bytes of it, as many as decoded_length says) and advancing past it, and
+ * '\0' if the string is invalid.
+ */
+static char parse_string_stop(struct JsonParser* const parser, char* const decoded,
+                              size_t* const decoded_length) {
+    size_t consumed;
+
+    if (CURRENT_CHAR(*parser) == '"')
+        return '"';
+
+    if (AT_END(*parser)) {
+        parser_fail(parser, "unterminated string");
+        return '\0';
+    }
+
+    if (CURRENT_CHAR(*parser) != '\\') {
+        parser_fail(parser, "control character in string");
+        return '\0';
+    }
+
+    if (CHAR_AT(*parser, 1) == 'u') {
+        /* a terminator stops the escape as any other byte that isn't a hex digit would */
+        consumed = scan_unicode(parser->stream + parser->idx + 1, parser->length - parser->idx - 1,
+                                decoded, decoded_length);
+    } else {
+        *decoded = scan_escape(CHAR_AT(*parser, 1));
+        *decoded_length = 1;
+        consumed = *decoded != '\0';
+    }
+
+    if (consumed == 0) {
+        parser_fail(parser, "invalid escape");
+        return '\0';
+    }
+
+    if (parser->no_nul && *decoded_length == 1 && *decoded == '\0') {
+        parser_fail(parser, "NUL character in string");
+        return '\0';
+    }
+
+    STATS_ADD(escapes, 1);
+
+    parser_advance(parser, 1 + consumed);
+    return '\\';
+}
+
+/* decode the string where it is in the stream, it only ever gets shorter */
+static bool parse_as_string_in_situ(struct JsonParser* const parser, const char** const out,
+                                    size_t* const length) {
+    char *string, *write, *run_start;
+    char decoded[4];
+    size_t run, decoded_length;
+    char stop;
+
+    parser_advance(parser, 1); /* advance '"' */
+    string = write = parser->stream + parser->idx;
+
+    for (;;) {
+        run_start = parser->stream + parser->idx;
+        run = parser_scan_string(parser);
+        if (!parser_take_run(parser, run))
+            return false;
+
+        /* nothing has to move until the first escape */
+        if (write != run_start)
+            memmove(write, run_start, run);
+        write += run;
+
+        stop = parse_string_stop(parser, decoded, &decoded_length);
+        if (stop == '"')
+            break;
+        if (stop == '\0')
+            return false;
+        memcpy(write, decoded, decoded_length);
+        write += decoded_length;
+    }
 
     parser_advance(parser, 1);
-    *out = malloc(len * sizeof(char));
+    *write = '\0';
+    *out = string;
+    *length = write - string;
+    return true;
+}
 
-    if (*out == NULL)
+/*
+ * Strings without escapes are handed out right from the stream, the rest
+ * are decoded into the scratch buffer. Either way the result is only valid
+ * until the next string is parsed.
+ */
+static bool parse_as_string_copy(struct JsonParser* const parser, const char** const out,
+                                 size_t* const length) {
+    const char *run_start;
+    size_t write_idx, run, decoded_length;
+    char stop;
+
+    parser_advance(parser, 1); /* advance '"' */
+    run_start = parser->stream + parser->idx;
+    run = parser_scan_string(parser);
+    if (!parser_take_run(parser, run))
         return false;
 
-    while (CURRENT_CHAR(*parser) != '"') {
-        if (write_idx >= len) {
-            len += 8;
-            *out = realloc(*out, len * sizeof(char));
-            if (*out == NULL)
-                return false;
-        }
-        if (CURRENT_CHAR(*parser) == '\\') {
-            if (!allow_escapes)
-                return false;
-            switch (CHAR_AT(*parser, 1)) {
-            case '\\': (*out)[write_idx] = '\\'; break;
-            case '/': (*out)[write_idx] = '/'; break;
-            case '"': (*out)[write_idx] = '"'; break;
-            case 'b': (*out)[write_idx] = '\b'; break;
-            case 'f': (*out)[write_idx] = '\f'; break;
-            case 'n': (*out)[write_idx] = '\n'; break;
-            case 'r': (*out)[write_idx] = '\r'; break;
-            case 't': (*out)[write_idx] = '\t'; break;
-            default: return false;
-            }
-            parser_advance(parser, 2);
-            ++write_idx;
-            continue;
-        }
+    if (CURRENT_CHAR(*parser) == '"') {
+        parser_advance(parser, 1);
+        *out = run_start;
+        *length = run;
+        return true;
+    }
 
-        if (CURRENT_CHAR(*parser) == '\n')
+    for (write_idx = 0;;) {
+        /* room for the run, a decoded escape and the terminator */
+        if (!parser_reserve_scratch(parser, write_idx + run + 5))
             return false;
 
-        if (CURRENT_CHAR(*parser) == '\0')
+        memcpy(parser->scratch + write_idx, run_start, run);
+        write_idx += run;
+
+        stop = parse_string_stop(parser, &parser->scratch[write_idx], &decoded_length);
+        if (stop == '"')
+            break;
+        if (stop == '\0')
             return false;
+        write_idx += decoded_length;
 
-        (*out)[write_idx] = CURRENT_CHAR(*parser);
-        parser_advance(parser, 1);
-        ++write_idx;
+        /* copy everything up to the next quote, escape or control character at once */
+        run_start = parser->stream + parser->idx;
+        run = parser_scan_string(parser);
+        if (!parser_take_run(parser, run))
+            return false;
     }
 
     parser_advance(parser, 1);
-    *out = realloc(*out, write_idx * sizeof(char));
+    parser->scratch[write_idx] = '\0';
+    *out = parser->scratch;
+    *length = write_idx;
     return true;
 }
 
-static bool parse_as_array(struct JsonParser* const parser, struct Array** const out) {
-    struct Array *array;
-    struct Value tmp_val;
+/* parse the string at idx, in situ if that's how parser parses */
+static bool parse_as_string(struct JsonParser* const parser, const char** const out,
+                            size_t* const length) {
+    const size_t start = parser->idx;
+    bool parsed;
 
-    if (CURRENT_CHAR(*parser) != '[')
-        return false;
+    STATS_START(JSON_STATS_STRINGS);
+    parsed = parser->in_situ ? parse_as_string_in_situ(parser, out, length) :
+                               parse_as_string_copy(parser, out, length);
+    STATS_STOP(JSON_STATS_STRINGS);
 
-    parser_advance(parser, 1);
-    array = malloc(sizeof(struct Array));
+    STATS_ADD(strings, 1);
+    STATS_ADD(string_bytes, parser->idx - start);
+    return parsed;
+}
 
-    if (array == NULL)
+/* parse a key along with the ':' after it, the value is up next */
+static bool parse_as_key(struct JsonParser* const parser) {
+    const char *key;
+    size_t key_length;
+
+    if (CURRENT_CHAR(*parser) != '"')
+        return parser_fail(parser, "expected a string key");
+
+    if (!parse_as_string(parser, &key, &key_length))
         return false;
 
-    array_construct(array);
+    if (!EMIT(parser, on_key, (parser->handler->context, key, key_length)))
+        return false;
 
-    while (CURRENT_CHAR(*parser) != ']') {
-        if (parser_clean(parser))
-            continue;
+    parser_clean(parser);
 
-        if (CURRENT_CHAR(*parser) == '\0')
-            return false;
+    if (CURRENT_CHAR(*parser) != ':')
+        return parser_fail(parser, "expected ':'");
 
-        if (!parse_as_value(parser, &tmp_val))
-            return false;
+    parser_advance(parser, 1);
+    return true;
+}
 
-        if (CURRENT_CHAR(*parser) == ',') {
-            parser_advance(parser, 1);
-            parser_clean(parser);
-            if (CURRENT_CHAR(*parser) == ']')
-                return false;
+/* remember that a container closed by close just opened */
+static bool parser_nest(struct JsonParser* const parser, const char close) {
+    size_t allocated = parser->nesting_allocated * 2;
+    char *nesting;
+
+    if (parser->depth >= parser->nesting_allocated) {
+        if (parser->nesting == parser->local_nesting) {
+            nesting = json_alloc(ARENA_ALLOCATOR(parser->arena), allocated);
+            if (nesting != NULL)
+                memcpy(nesting, parser->local_nesting, sizeof(parser->local_nesting));
+        } else {
+            nesting = json_realloc(ARENA_ALLOCATOR(parser->arena), parser->nesting, allocated);
         }
-        array_push(array, tmp_val);
+
+        if (nesting == NULL)
+            return parser_fail(parser, "out of memory");
+
+        STATS_ADD(nesting_reallocs, 1);
+        parser->nesting = nesting;
+        parser->nesting_allocated = allocated;
     }
 
-    parser_advance(parser, 1); /* advance ']' */
-    *out = array;
+    parser->nesting[parser->depth++] = close;
     return true;
 }
 
-static bool parse_as_object(struct JsonParser* const parser, struct Object **out) {
-    struct Object *obj;
-    char *tmp_key;
-    struct Value tmp_val;
-
-    if (CURRENT_CHAR(*parser) != '{')
-        return false;
+/*
+ * Parse a value along with the whitespace around it. The first byte alone
+ * decides what the value can be, so nothing is parsed on the off chance
+ * that it matches.
+ *
+ * Nesting doesn't recurse: parser->nesting holds the closing bracket of
+ * every container that is open, so how deep a document goes only costs a
+ * byte per level, up to parser->max_depth levels.
+ */
+static bool parse_as_value(struct JsonParser* const parser) {
+    const size_t base = parser->depth;
+    const char *string;
+    size_t length;
+    char close;
 
-    parser_advance(parser, 1);
-    obj = malloc(sizeof(struct Object));
+    for (;;) {
+        parser_clean(parser);
 
-    if (obj == NULL)
-        return false;
+        switch (CURRENT_CHAR(*parser)) {
+        case '"':
+            if (!parse_as_string(parser, &string, &length) ||
+                !EMIT(parser, on_string, (parser->handler->context, string, length)))
+                return false;
+            break;
+        case '[':
+            if (parser->depth >= parser->max_depth)
+                return parser_fail(parser, "nested too deeply");
 
-    object_construct(obj);
+            STATS_ADD(arrays, 1);
+            STATS_MAX(max_depth, parser->depth + 1);
+            parser_advance(parser, 1);
+            if (!EMIT(parser, on_array_start, (parser->handler->context)))
+                return false;
 
-    while (CURRENT_CHAR(*parser) != '}') {
-        if (parser_clean(parser))
-            continue;
+            parser_clean(parser);
+            if (CURRENT_CHAR(*parser) != ']') {
+                if (!parser_nest(parser, ']'))
+                    return false;
+                continue;
+            }
 
-        if (CURRENT_CHAR(*parser) == '\0')
-            return false;
+            parser_advance(parser, 1);
+            if (!EMIT(parser, on_array_end, (parser->handler->context)))
+                return false;
+            break;
+        case '{':
+            if (parser->depth >= parser->max_depth)
+                return parser_fail(parser, "nested too deeply");
 
-        if (!parse_as_string(parser, &tmp_key, false))
-            return false;
+            STATS_ADD(objects, 1);
+            STATS_MAX(max_depth, parser->depth + 1);
+            parser_advance(parser, 1);
+            if (!EMIT(parser, on_object_start, (parser->handler->context)))
+                return false;
 
-        parser_clean(parser);
+            parser_clean(parser);
+            if (CURRENT_CHAR(*parser) != '}') {
+                if (!parser_nest(parser, '}') || !parse_as_key(parser))
+                    return false;
+                continue;
+            }
 
-        if (CURRENT_CHAR(*parser) != ':')
-            return false;
+            parser_advance(parser, 1);
+            if (!EMIT(parser, on_object_end, (parser->handler->context)))
+                return false;
+            break;
+        case '-':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            if (!parse_as_number(parser))
+                return false;
+            break;
+        case 'n':
+            if (!match(parser, "null"))
+                return parser_fail(parser, "invalid literal");
+            if (!EMIT(parser, on_null, (parser->handler->context)))
+                return false;
+            break;
+        case 't':
+            if (!match(parser, "true"))
+                return parser_fail(parser, "invalid literal");
+            if (!EMIT(parser, on_bool, (parser->handler->context, true)))
+                return false;
+            break;
+        case 'f':
+            if (!match(parser, "false"))
+                return parser_fail(parser, "invalid literal");
+            if (!EMIT(parser, on_bool, (parser->handler->context, false)))
+                return false;
+            break;
+        case '\0':
+            if (AT_END(*parser))
+                return parser_fail(parser, "unexpected end of input");
+            /* fall through */
+        default:
+            return parser_fail(parser, "unexpected character"); /* can't be the start of anything :^( */
+        }
 
-        parser_advance(parser, 1);
-        parser_clean(parser);
+        /* a value just ended, close every container that ends with it */
+        for (;;) {
+            parser_clean(parser);
 
-        if (!parse_as_value(parser, &tmp_val))
-            return false;
+            if (parser->depth == base)
+                return true;
 
-        object_set(obj, tmp_key, &tmp_val);
-        parser_clean(parser);
+            close = parser->nesting[parser->depth - 1];
+            if (CURRENT_CHAR(*parser) != close)
+                break;
 
-        if (CURRENT_CHAR(*parser) == ',') {
             parser_advance(parser, 1);
+            --parser->depth;
+            if (close == ']' ? !EMIT(parser, on_array_end, (parser->handler->context)) :
+                               !EMIT(parser, on_object_end, (parser->handler->context)))
+                return false;
+        }
+
+        if (CURRENT_CHAR(*parser) != ',')
+            return parser_fail(parser, close == ']' ? "expected ',' or ']'" : "expected ',' or '}'");
+        parser_advance(parser, 1);
+
+        if (close == '}') {
             parser_clean(parser);
-            if (CURRENT_CHAR(*parser) == '}')
+            if (!parse_as_key(parser))
                 return false;
         }
     }
+}
+
+/* parse a whole document, nothing but whitespace may follow the value */
+static bool parse_root(struct JsonParser* const parser) {
+    if (!parse_as_value(parser))
+        return false;
+
+    if (!AT_END(*parser))
+        return parser_fail(parser, "trailing characters after the value");
 
-    parser_advance(parser, 1);
-    parser_clean(parser);
-    *out = obj;
     return true;
 }
 
-static bool parse_as_null(struct JsonParser* const parser) {
-    if (match(parser, "null"))
-        return true;
-    return false;
+/*
+ * The tree builder, a handler that turns events into values. Containers are
+ * linked into their parent as soon as they start, so on failure everything
+ * built so far hangs off parser->head.
+ */
+
+#define DOM_LOCAL_DEPTH 32
+
+struct DomBuilder {
+    struct JsonParser *parser;
+    bool has_root;
+    /* the containers currently open, innermost last */
+    struct Value *stack;
+    size_t depth, allocated;
+    struct Value local_stack[DOM_LOCAL_DEPTH];
+    /* the key the next value of the innermost object goes under, interned if parser->keys is set */
+    char *key;
+    size_t key_length;
+    size_t next_size; /* which of parser->sizes the next container gets */
+};
+
+static void dom_builder_construct(struct DomBuilder* const builder, struct JsonParser* const parser) {
+    builder->parser = parser;
+    builder->has_root = false;
+    builder->stack = builder->local_stack;
+    builder->depth = 0;
+    builder->allocated = DOM_LOCAL_DEPTH;
+    builder->key = NULL;
+    builder->next_size = 0;
+}
+
+/* release whatever a failed parse left behind */
+static void dom_builder_destruct(struct DomBuilder* const builder, const bool failed) {
+    struct Arena *arena = builder->parser->arena;
+
+    if (builder->stack != builder->local_stack)
+        json_free(ARENA_ALLOCATOR(arena), builder->stack);
+
+    if (builder->key != NULL && !builder->parser->in_situ && builder->parser->keys == NULL)
+        arena_free(arena, builder->key);
+
+    if (failed && builder->has_root && !ARENA_BULK(arena))
+        value_release_in(builder->parser->head, arena);
+}
+
+/* copy a string out of the parser, unless it already lives in the stream */
+static char *dom_string(struct DomBuilder* const builder, const char* const string, const size_t length) {
+    char *copy;
+
+    if (builder->parser->in_situ)
+        return (char *)string;
+
+    copy = arena_alloc(builder->parser->arena, length + 1);
+    if (copy == NULL)
+        return NULL;
+
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    return copy;
 }
 
-static bool parse_as_bool(struct JsonParser* const parser, bool* const out) {
-    if (match(parser, "true")) {
-        *out = true;
+static bool dom_insert(struct DomBuilder* const builder, struct Value* const value) {
+    struct Value *top;
+
+    if (builder->depth == 0) {
+        *builder->parser->head = *value;
+        builder->has_root = true;
         return true;
     }
-    if (match(parser, "false")) {
-        *out = false;
+
+    top = &builder->stack[builder->depth - 1];
+
+    if (VALUE_TYPE(top) == Array) {
+        if (array_push(VALUE_ARRAY(top), *value))
+            return true;
+    } else if (builder->parser->keys != NULL ? object_set_interned(VALUE_OBJECT(top), builder->key, value) :
+               object_set_owned(VALUE_OBJECT(top), builder->key, builder->key_length, value)) {
+        builder->key = NULL;
         return true;
     }
-    return false;
+
+    if (!ARENA_BULK(builder->parser->arena))
+        value_release_in(value, builder->parser->arena);
+    return parser_fail(builder->parser, "out of memory");
 }
 
-static bool parse_as_value(struct JsonParser *parser, struct Value* const out) {
-    struct Value tmp;
-    parser_clean(parser);
-    if (parse_as_number(parser, &out->as.number)) out->type = Number;
-    else if (parse_as_string(parser, &out->as.string, true)) out->type = String;
-    else if (parse_as_array(parser, &out->as.array)) out->type = Array;
-    else if (parse_as_object(parser, &out->as.object)) out->type = Object;
-    else if (parse_as_null(parser)) out->type = Null;
-    else if (parse_as_bool(parser, &out->as.bool_)) out->type = Bool;
-    else return false; /* failed to parse as anything :^( */
-    parser_clean(parser);
+static bool dom_open(struct DomBuilder* const builder, struct Value* const container) {
+    const struct JsonAllocator *allocator = ARENA_ALLOCATOR(builder->parser->arena);
+    struct Value *stack;
+
+    if (!dom_insert(builder, container))
+        return false;
+
+    if (builder->depth >= builder->allocated) {
+        if (builder->stack == builder->local_stack) {
+            stack = json_alloc(allocator, builder->allocated * 2 * sizeof(struct Value));
+            if (stack != NULL)
+                memcpy(stack, builder->local_stack, sizeof(builder->local_stack));
+        } else {
+            stack = json_realloc(allocator, builder->stack, builder->allocated * 2 * sizeof(struct Value));
+        }
+
+        if (stack == NULL)
+            return parser_fail(builder->parser, "out of memory");
+
+        builder->stack = stack;
+        builder->allocated *= 2;
+    }
+
+    builder->stack[builder->depth++] = *container;
+    return true;
+}
+
+/* the exact size of the container that opens next, 0 if it isn't known */
+static size_t dom_next_size(struct DomBuilder* const builder) {
+    const struct JsonParser *parser = builder->parser;
+
+    return builder->next_size < parser->sizes_count ? parser->sizes[builder->next_size++] : 0;
+}
+
+static bool dom_on_array_start(void *context) {
+    struct DomBuilder *builder = context;
+    struct Array *array = arena_alloc(builder->parser->arena, sizeof(struct Array));
+    struct Value value;
+
+    if (array == NULL)
+        return parser_fail(builder->parser, "out of memory");
+
+    /* it isn't in the tree yet, so nothing else would free it */
+    array_construct_in(array, builder->parser->arena);
+    if (!array_reserve(array, dom_next_size(builder))) {
+        arena_free(builder->parser->arena, array);
+        return parser_fail(builder->parser, "out of memory");
+    }
+
+    VALUE_SET_ARRAY(&value, array);
+    return dom_open(builder, &value);
+}
+
+static bool dom_on_object_start(void *context) {
+    struct DomBuilder *builder = context;
+    struct Object *object = arena_alloc(builder->parser->arena, sizeof(struct Object));
+    struct Value value;
+
+    if (object == NULL)
+        return parser_fail(builder->parser, "out of memory");
+
+    object_construct_interned(object, builder->parser->arena, builder->parser->keys);
+    if (!object_reserve(object, dom_next_size(builder))) {
+        arena_free(builder->parser->arena, object);
+        return parser_fail(builder->parser, "out of memory");
+    }
+
+    VALUE_SET_OBJECT(&value, object);
+    return dom_open(builder, &value);
+}
 
-    if (parse_as_number(parser, &tmp.as.number))       return false;
-    if (parse_as_string(parser, &tmp.as.string, true)) return false;
-    if (parse_as_array(parser, &tmp.as.array))         return false;
-    if (parse_as_object(parser, &tmp.as.object))       return false;
-    if (parse_as_null(parser))                         return false;
-    if (parse_as_bool(parser, &tmp.as.bool_))          return false;
+static bool dom_on_end(void *context) {
+    struct DomBuilder *builder = context;
+
+    --builder->depth;
     return true;
 }
 
-struct Value *parse(char* const stream) {
+static bool dom_on_key(void *context, const char *key, size_t length) {
+    struct DomBuilder *builder = context;
+
+    if (builder->parser->keys != NULL)
+        builder->key = (char *)key_table_intern(builder->parser->keys, key, length);
+    else
+        builder->key = dom_string(builder, key, length);
+    builder->key_length = length;
+    return builder->key != NULL || parser_fail(builder->parser, "out of memory");
+}
+
+static bool dom_on_string(void *context, const char *string, size_t length) {
+    struct DomBuilder *builder = context;
+    struct Value value;
+
+    char *copy = dom_string(builder, string, length);
+
+    if (copy == NULL)
+        return parser_fail(builder->parser, "out of memory");
+
+    VALUE_SET_STRING(&value, copy);
+    return dom_insert(builder, &value);
+}
+
+static bool dom_on_number(void *context, double number) {
+    struct Value value;
+
+    VALUE_SET_NUMBER(&value, number);
+    return dom_insert(context, &value);
+}
+
+static bool dom_on_int(void *context, json_int integer) {
+    struct Value value;
+
+    VALUE_SET_INT(&value, integer);
+    return dom_insert(context, &value);
+}
+
+static bool dom_on_bool(void *context, bool b) {
+    struct Value value;
+
+    VALUE_SET_BOOL(&value, b);
+    return dom_insert(context, &value);
+}
+
+static bool dom_on_null(void *context) {
+    struct Value value;
+
+    VALUE_SET_NULL(&value);
+    return dom_insert(context, &value);
+}
+
+/*
+ * Parse into parser->head. A root is a whole document, otherwise parsing
+ * stops after the first value and the whitespace following it.
+ */
+static bool parse_tree(struct JsonParser* const parser, const bool root) {
+    struct DomBuilder builder;
+    struct JsonHandler handler;
+    bool parsed;
+
+    dom_builder_construct(&builder, parser);
+    parser->no_nul = true;
+
+    handler.context = &builder;
+    handler.on_object_start = dom_on_object_start;
+    handler.on_object_end = dom_on_end;
+    handler.on_array_start = dom_on_array_start;
+    handler.on_array_end = dom_on_end;
+    handler.on_key = dom_on_key;
+    handler.on_string = dom_on_string;
+    handler.on_number = dom_on_number;
+    handler.on_int = dom_on_int;
+    handler.on_bool = dom_on_bool;
+    handler.on_null = dom_on_null;
+    parser->handler = &handler;
+
+    STATS_START(JSON_STATS_PARSE);
+    parsed = root ? parse_root(parser) : parse_as_value(parser);
+    STATS_STOP(JSON_STATS_PARSE);
+
+    dom_builder_destruct(&builder, !parsed);
+    parser_destruct(parser);
+    return parsed;
+}
+
+/* fill error in, only now is the line and column of the failure worked out */
+void error_construct(struct JsonError* const error, const char* const stream,
+                     const size_t offset, const char* const reason) {
+    size_t line_start = offset;
+
+    if (error == NULL)
+        return;
+
+    while (line_start > 0 && stream[line_start - 1] != '\n')
+        --line_start;
+
+    error->offset = offset;
+    error->line = 1 + scan_newlines(stream, line_start);
+    error->column = 1 + offset - line_start;
+    error->reason = reason;
+}
+
+static void parser_error(const struct JsonParser* const parser, struct JsonError* const error) {
+    error_construct(error, parser->stream, parser->idx,
+                    parser->error != NULL ? parser->error : "out of memory");
+}
+
+static struct Value *parse_heap(char* const stream, const size_t length, struct Arena* const arena,
+                                const size_t max_depth, struct JsonError* const error) {
     struct JsonParser parser;
-    parser_construct(&parser, stream);
+    parser_construct_in(&parser, stream, length, arena);
+    parser.max_depth = max_depth;
 
-    if (!parse_as_value(&parser, parser.head))
+    if (parser.head == NULL) {
+        parser_error(&parser, error);
         return NULL;
+    }
+
+    if (!parse_tree(&parser, true)) {
+        parser_error(&parser, error);
+        arena_free(arena, parser.head);
+        return NULL;
+    }
 
     return parser.head;
 }
 
-struct Value *parse_file(char* const filename) {
-    FILE *fd = fopen(filename, "r");
-    size_t file_size;
+struct Value *parse(char* const stream, struct JsonError* const error) {
+    return parse_heap(stream, PARSER_NUL_TERMINATED, NULL, JSON_MAX_DEPTH_DEFAULT, error);
+}
+
+struct Value *parse_in(char* const stream, struct Arena* const arena, struct JsonError* const error) {
+    return parse_heap(stream, PARSER_NUL_TERMINATED, arena, JSON_MAX_DEPTH_DEFAULT, error);
+}
+
+struct Value *parse_n(const char* const buffer, const size_t length, struct JsonError* const error) {
+    return parse_n_depth(buffer, length, JSON_MAX_DEPTH_DEFAULT, error);
+}
+
+struct Value *parse_n_depth(const char* const buffer, const size_t length, const size_t max_depth,
+                            struct JsonError* const error) {
+    /* only in situ parsing writes to the stream */
+    return parse_heap((char *)buffer, length, NULL, max_depth, error);
+}
+
+bool parse_events(char* const stream, const struct JsonHandler* const handler,
+                  struct JsonError* const error) {
+    struct JsonParser parser;
+    bool parsed;
+
+    parser_init(&parser, stream, PARSER_NUL_TERMINATED, NULL);
+    parser.handler = handler;
+
+    STATS_START(JSON_STATS_PARSE);
+    parsed = parse_root(&parser);
+    STATS_STOP(JSON_STATS_PARSE);
+    if (!parsed)
+        parser_error(&parser, error);
+
+    parser_destruct(&parser);
+    return parsed;
+}
+
+void document_construct(struct JsonDocument* const doc) {
+    document_construct_with(doc, NULL);
+}
+
+void document_construct_with(struct JsonDocument* const doc, const struct JsonAllocator* const allocator) {
+    arena_construct_with(&doc->arena, allocator);
+    doc->root = NULL;
+    doc->presize = false;
+    doc->max_depth = JSON_MAX_DEPTH_DEFAULT;
+    doc->keys = NULL;
+}
+
+static struct Value *document_parse(struct JsonDocument* const doc, char* const stream, const size_t length,
+                                   const bool in_situ, struct JsonError* const error) {
+    struct JsonParser parser;
+    size_t *sizes = NULL, count;
+    bool parsed;
+
+    parser_construct_in(&parser, stream, length, &doc->arena);
+    parser.in_situ = in_situ;
+    parser.max_depth = doc->max_depth;
+    parser.keys = doc->keys;
+
+    /* a document the sizes can't be found for is broken, the parser says how */
+    STATS_START(JSON_STATS_PRESIZE);
+    if (doc->presize && json_index_sizes(stream, length == PARSER_NUL_TERMINATED ? strlen(stream) : length,
+                                         &sizes, &count, NULL)) {
+        parser.sizes = sizes;
+        parser.sizes_count = count;
+    }
+    STATS_STOP(JSON_STATS_PRESIZE);
+
+    parsed = parser.head != NULL && parse_tree(&parser, true);
+    free(sizes);
+
+    if (!parsed) {
+        parser_error(&parser, error);
+        arena_free(&doc->arena, parser.head);
+        return NULL;
+    }
+
+    doc->root = parser.head;
+    return doc->root;
+}
+
+struct Value *parse_document(struct JsonDocument* const doc, char* const stream,
+                             struct JsonError* const error) {
+    document_reset(doc);
+    return document_parse(doc, stream, PARSER_NUL_TERMINATED, false, error);
+}
+
+struct Value *parse_document_in_situ(struct JsonDocument* const doc, char* const stream,
+                                     struct JsonError* const error) {
+    document_reset(doc);
+    return document_parse(doc, stream, PARSER_NUL_TERMINATED, true, error);
+}
+
+struct Value *parse_document_next(struct JsonDocument* const doc, const char* const buffer,
+                                  const size_t length, size_t* const consumed,
+                                  struct JsonError* const error) {
+    struct JsonParser parser;
+
+    parser_construct_in(&parser, (char *)buffer, length, &doc->arena);
+    parser.max_depth = doc->max_depth;
+    parser.keys = doc->keys;
+
+    if (parser.head == NULL || !parse_tree(&parser, false)) {
+        parser_error(&parser, error);
+        return NULL;
+    }
+
+    *consumed = parser.idx;
+    doc->root = parser.head;
+    return doc->root;
+}
+
+void document_reset(struct JsonDocument* const doc) {
+    arena_reset(&doc->arena);
+    doc->root = NULL;
+}
+
+void document_dealloc(struct JsonDocument* const doc) {
+    arena_dealloc(&doc->arena);
+    doc->root = NULL;
+}
+
+#ifdef JSON_MMAP
+
+/* map a whole file into memory read-only, release it with unmap_file */
+char *map_file(char* const filename, size_t* const length, struct JsonError* const error) {
+    int fd = open(filename, O_RDONLY);
+    struct stat info;
+    void *buffer;
+
+    if (fd < 0) {
+        error_construct(error, "", 0, "can't open file");
+        return NULL;
+    }
+
+    if (fstat(fd, &info) != 0 || info.st_size < 0 || (off_t)(size_t)info.st_size != info.st_size) {
+        close(fd);
+        error_construct(error, "", 0, "can't read file");
+        return NULL;
+    }
+
+    *length = (size_t)info.st_size;
+
+    /* empty files can't be mapped */
+    if (*length == 0) {
+        close(fd);
+        return "";
+    }
+
+    buffer = mmap(NULL, *length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); /* the mapping holds on to the file */
+
+    if (buffer == MAP_FAILED) {
+        error_construct(error, "", 0, "can't read file");
+        return NULL;
+    }
+
+    /* the parser goes through the file front to back, once */
+    posix_madvise(buffer, *length, POSIX_MADV_SEQUENTIAL);
+    return buffer;
+}
+
+void unmap_file(char* const buffer, const size_t length) {
+    if (length != 0)
+        munmap(buffer, length);
+}
+
+#else
+
+/* read a whole file into memory, release it with unmap_file */
+char *map_file(char* const filename, size_t* const length, struct JsonError* const error) {
+    FILE *fd = fopen(filename, "rb");
+    long file_size;
     char *buffer;
-    struct Value *result;
 
     /* failed to open file */
-    if (fd == NULL)
+    if (fd == NULL) {
+        error_construct(error, "", 0, "can't open file");
         return NULL;
+    }
 
     /* move to end and get the index at the end (get filesize) */
-    fseek(fd, 0, SEEK_END);
-    file_size = ftell(fd);
+    if (fseek(fd, 0, SEEK_END) != 0 || (file_size = ftell(fd)) < 0) {
+        fclose(fd);
+        error_construct(error, "", 0, "can't read file");
+        return NULL;
+    }
 
-    /* allocate a big enough buffer */
+    /* allocate a big enough buffer, malloc(0) may return NULL */
     buffer = malloc(sizeof(char) * (file_size + 1));
     if (buffer == NULL) {
         fclose(fd);
+        error_construct(error, "", 0, "out of memory");
         return NULL;
     }
 
     /* go back to the start, so we can start reading */
     fseek(fd, 0, SEEK_SET);
 
-    fread(buffer, 1, file_size, fd);
-    result = parse(buffer);
+    if (fread(buffer, 1, file_size, fd) != (size_t)file_size) {
+        fclose(fd);
+        free(buffer);
+        error_construct(error, "", 0, "can't read file");
+        return NULL;
+    }
+
+    fclose(fd);
+    *length = (size_t)file_size;
+    return buffer;
+}
 
-    /* free buffer */
+void unmap_file(char* const buffer, const size_t length) {
+    (void)length;
     free(buffer);
+}
+
+#endif /* JSON_MMAP */
 
+struct Value *parse_file(char* const filename, struct JsonError* const error) {
+    struct Value *result;
+    size_t length;
+    char *buffer = map_file(filename, &length, error);
+
+    if (buffer == NULL)
+        return NULL;
+
+    result = parse_n(buffer, length, error);
+
+    unmap_file(buffer, length);
+    return result;
+}
+
+struct Value *parse_document_file(struct JsonDocument* const doc, char* const filename,
+                                  struct JsonError* const error) {
+    struct Value *result;
+    size_t length;
+    char *buffer;
+
+    document_reset(doc);
+
+    buffer = map_file(filename, &length, error);
+    if (buffer == NULL)
+        return NULL;
+
+    /* the file is gone once parsed, so everything is copied into the document */
+    result = document_parse(doc, buffer, length, false, error);
+
+    unmap_file(buffer, length);
     return result;
 }
 
@@ -352,10 +1117,31 @@ void print_number(const double number) {
     if (json_print_colored) printf("\033[0m");
 }
 
+void print_int(const json_int integer) {
+    /* printf has no portable conversion for json_int, so do it by hand */
+    char digits[24];
+    size_t i = sizeof(digits);
+    json_uint magnitude = integer < 0 ? (json_uint)0 - (json_uint)integer : (json_uint)integer;
+
+    digits[--i] = '\0';
+    do {
+        digits[--i] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (integer < 0)
+        digits[--i] = '-';
+
+    if (json_print_colored) printf("\033[34;1m");
+    printf("%s", &digits[i]);
+    if (json_print_colored) printf("\033[0m");
+}
+
 void print_string(const char *string) {
+    const char quote = json_print_double_quoted ? '"' : '\'';
+
     if (json_print_colored) printf("\033[32m");
 
-    printf("%c", json_print_double_quoted ? '"' : '\'');
+    printf("%c", quote);
     for (; *string; ++string) {
         switch (*string) {
         case '\\': printf("\\\\"); break;
@@ -364,11 +1150,18 @@ void print_string(const char *string) {
         case '\n': printf("\\n"); break;
         case '\r': printf("\\r"); break;
         case '\t': printf("\\t"); break;
-        default: printf("%c", *string);
+        default:
+            /* the rest of the control characters only go as \u escapes, UTF-8 goes as it is */
+            if (*string == quote)
+                printf("\\%c", quote);
+            else if ((unsigned char)*string < 0x20)
+                printf("\\u%04x", (unsigned char)*string);
+            else
+                printf("%c", *string);
         }
     }
 
-    printf("%c", json_print_double_quoted ? '"' : '\'');
+    printf("%c", quote);
     if (json_print_colored) printf("\033[0m");
 }
 
@@ -396,36 +1189,35 @@ void print_array(const struct Array *array) {
 }
 
 void print_object(const struct Object *object) {
-    struct Node *node;
-    size_t printed, i;
+    const struct Node *node;
+    size_t i;
 
-    printed = 0;
     printf("{ ");
-    for (i = 0; i < object->allocated; ++i) {
-        for (node = object->buckets[i]; node != NULL; node = node->next) {
-            if (json_print_key_as_string)
-                print_string(node->key);
-            else
-                printf("%s", node->key);
+    for (i = 0; i < object->pairs; ++i) {
+        node = &object->nodes[i];
 
-            printf(": ");
-            print_value(&node->value);
-            ++printed;
-            if (printed < object->pairs)
-                printf(", ");
-        }
+        if (json_print_key_as_string)
+            print_string(node->key);
+        else
+            printf("%s", node->key);
+
+        printf(": ");
+        print_value(&node->value);
+        if (i + 1 < object->pairs)
+            printf(", ");
     }
     printf(" }");
 }
 
 void print_value(const struct Value *val) {
-    switch (val->type) {
-    case Number: print_number(val->as.number); break;
-    case String: print_string(val->as.string); break;
-    case Array: print_array(val->as.array); break;
-    case Object: print_object(val->as.object); break;
+    switch (VALUE_TYPE(val)) {
+    case Number: print_number(VALUE_NUMBER(val)); break;
+    case String: print_string(VALUE_STRING(val)); break;
+    case Array: print_array(VALUE_ARRAY(val)); break;
+    case Object: print_object(VALUE_OBJECT(val)); break;
     case Null: print_null(); break;
-    case Bool: print_bool(val->as.bool_); break;
+    case Bool: print_bool(VALUE_BOOL(val)); break;
+    case Int: print_int(VALUE_INT(val)); break;
     }
 }
 
@@ -30,29 +30,194 @@
 
 #include <stddef.h>
 
-#define CURRENT_CHAR(p) ((p).stream[(p).idx])
-#define CHAR_AT(p, i) ((p).stream[(p).idx + (i)])
+/* everything past the end of the stream reads as '\0' */
+#define CURRENT_CHAR(p) ((p).idx < (p).length ? (p).stream[(p).idx] : '\0')
+#define CHAR_AT(p, i) ((p).idx + (i) < (p).length ? (p).stream[(p).idx + (i)] : '\0')
 
 /* TODO: order this as a struct */
 extern bool json_print_colored;
 extern bool json_print_double_quoted;
 extern bool json_print_key_as_string;
 
+/*
+ * Callbacks for parse_events, every one of them may be NULL. Returning
+ * false from a callback stops the parse. Strings and keys are length bytes
+ * long, aren't necessarily NUL-terminated and are only valid during the
+ * call. Integers go to on_number if there's no on_int.
+ */
+struct JsonHandler {
+    void *context; /* passed to every callback */
+    bool (*on_object_start)(void *context);
+    bool (*on_object_end)(void *context);
+    bool (*on_array_start)(void *context);
+    bool (*on_array_end)(void *context);
+    bool (*on_key)(void *context, const char *key, size_t length);
+    bool (*on_string)(void *context, const char *string, size_t length);
+    bool (*on_number)(void *context, double number);
+    bool (*on_int)(void *context, json_int integer);
+    bool (*on_bool)(void *context, bool b);
+    bool (*on_null)(void *context);
+};
+
+/* how deep arrays and objects may nest, unless told otherwise */
+#ifndef JSON_MAX_DEPTH_DEFAULT
+# define JSON_MAX_DEPTH_DEFAULT 1024
+#endif
+
+/* nesting up to this deep needs no allocation */
+#define PARSER_LOCAL_DEPTH 32
+
 struct JsonParser {
     char *stream;
-    size_t idx, line, column;
+    size_t idx, length; /* nothing at or past length is ever read, (size_t)-1 if NUL-terminated */
     struct Value *head;
+    struct Arena *arena;
+    const char *error; /* why parsing stopped at idx, NULL while all is well */
+    bool in_situ; /* decode strings inside stream instead of copying them out */
+    bool no_nul; /* fail at \u0000, strings in a tree end at the first NUL */
+    struct KeyTable *keys; /* where keys are interned instead of being copied, or NULL */
+    const struct JsonHandler *handler;
+    char *scratch; /* escaped strings are decoded here */
+    size_t scratch_allocated;
+    /* the exact size of every container in the order they open, or NULL */
+    const size_t *sizes;
+    size_t sizes_count;
+    /* the closing bracket of every container that is open, innermost last */
+    char *nesting;
+    size_t depth, nesting_allocated, max_depth;
+    char local_nesting[PARSER_LOCAL_DEPTH];
+};
+
+/*
+ * Where and why parsing failed. Lines and columns start at 1 and are only
+ * worked out once a parse fails, offset is the byte index into the stream.
+ */
+struct JsonError {
+    size_t offset, line, column;
+    const char *reason;
+};
+
+/*
+ * A parsed document whose whole tree is allocated from one arena.
+ * document_dealloc frees the tree in one go, document_reset does the same
+ * but keeps memory around so the document can be reused for the next parse.
+ *
+ * With presize set, a quick pass over the stream first counts what every
+ * array and object will hold, so each is allocated once at its exact size
+ * instead of growing. That pays off for big containers, where growing
+ * leaves every outgrown copy behind in the arena.
+ *
+ * Arrays and objects nesting deeper than max_depth fail to parse, which
+ * is JSON_MAX_DEPTH_DEFAULT to start with.
+ *
+ * With keys set, the keys of every object are interned in that table
+ * instead of being copied into the arena, in situ too. Any number of
+ * documents may share a table, as long as it outlives them all and they're
+ * parsed on one thread. Streams whose documents all use the same few keys
+ * then store each key once, and objects compare keys by pointer.
+ */
+struct JsonDocument {
+    struct Arena arena;
+    struct Value *root;
+    bool presize;
+    size_t max_depth;
+    struct KeyTable *keys; /* NULL to start with */
 };
 
 void parser_construct(struct JsonParser* const parser, char* const stream);
 
-struct Value *parse(char* const stream);
+/* fill error in for a failure at offset into stream, error may be NULL */
+void error_construct(struct JsonError* const error, const char* const stream,
+                     const size_t offset, const char* const reason);
 
-struct Value *parse_file(char* const filename);
+/*
+ * error may be NULL, it is only written to when NULL is returned. Strings
+ * in a tree are NUL-terminated, so every parse into one fails at a \u0000
+ * escape rather than cut the string short there. parse_events, the tape
+ * and the cursors pass such strings on along with their length.
+ */
+struct Value *parse(char* const stream, struct JsonError* const error);
+
+/*
+ * Parse stream into arena. With a heap arena every allocation goes to its
+ * allocator, and the tree is freed with value_dealloc_in.
+ */
+struct Value *parse_in(char* const stream, struct Arena* const arena, struct JsonError* const error);
+
+/*
+ * Parse the first length bytes of buffer, which doesn't need to be
+ * NUL-terminated. Nothing past them is read and buffer isn't modified.
+ */
+struct Value *parse_n(const char* const buffer, const size_t length, struct JsonError* const error);
+
+/* like parse_n, with arrays and objects nesting at most max_depth deep */
+struct Value *parse_n_depth(const char* const buffer, const size_t length, const size_t max_depth,
+                            struct JsonError* const error);
+
+/*
+ * Parse stream without building anything, reporting what is found to
+ * handler instead. Memory use doesn't depend on the size of the document.
+ */
+bool parse_events(char* const stream, const struct JsonHandler* const handler,
+                  struct JsonError* const error);
+
+void document_construct(struct JsonDocument* const doc);
+
+/* a document whose arena takes its memory from allocator */
+void document_construct_with(struct JsonDocument* const doc, const struct JsonAllocator* const allocator);
+
+struct Value *parse_document(struct JsonDocument* const doc, char* const stream,
+                             struct JsonError* const error);
+
+/*
+ * Like parse_document, but strings and keys are decoded inside stream and
+ * point right into it, so none of them is allocated. stream is modified and
+ * must outlive the document. Escapes decoded before a failure may throw the
+ * error line off.
+ */
+struct Value *parse_document_in_situ(struct JsonDocument* const doc, char* const stream,
+                                     struct JsonError* const error);
+
+/*
+ * Parse the first of the documents in the first length bytes of buffer into
+ * doc, without resetting it first: the documents parsed into doc before are
+ * kept. consumed is set to the amount of bytes the document and the
+ * whitespace after it took up. Documents are usually separated by
+ * whitespace, but need not be where the end of one is unambiguous, as in
+ * {"a":1}{"b":2}. buffer isn't modified, and doc->presize is ignored.
+ */
+struct Value *parse_document_next(struct JsonDocument* const doc, const char* const buffer,
+                                  const size_t length, size_t* const consumed,
+                                  struct JsonError* const error);
+
+/* map filename into memory and parse it into doc */
+struct Value *parse_document_file(struct JsonDocument* const doc, char* const filename,
+                                  struct JsonError* const error);
+
+void document_reset(struct JsonDocument* const doc);
+
+void document_dealloc(struct JsonDocument* const doc);
+
+/*
+ * Where the system allows it the file is mapped into memory read-only and
+ * parsed right there, so it's never copied.
+ */
+struct Value *parse_file(char* const filename, struct JsonError* const error);
+
+/*
+ * Map a whole file into memory read-only (or read it in, where the system
+ * can't map files), the buffer isn't NUL-terminated. Give it back with
+ * unmap_file.
+ */
+char *map_file(char* const filename, size_t* const length, struct JsonError* const error);
+
+void unmap_file(char* const buffer, const size_t length);
 
 /* printing functions */
 void print_number(const double number);
 
+void print_int(const json_int integer);
+
 void print_string(const char *string);
 
 void print_null(void);
@@ -0,0 +1,588 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "push.h"
+#include "number.h"
+#include "scan.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* whitespace may come before the tokens of every state up to PUSH_STRING */
+enum PushState {
+    PUSH_VALUE,        /* a value has to come next */
+    PUSH_ARRAY_FIRST,  /* right after '[', a value or ']' */
+    PUSH_OBJECT_FIRST, /* right after '{', a key or '}' */
+    PUSH_KEY,          /* after ',' in an object */
+    PUSH_COLON,        /* after a key */
+    PUSH_AFTER_VALUE,  /* ',' or the end of the innermost container */
+    PUSH_DONE,         /* the document is complete, only whitespace may follow */
+    PUSH_STRING,       /* inside a string that is being copied to the token */
+    PUSH_ESCAPE,       /* the last chunk ended in the middle of an escape */
+    PUSH_NUMBER,       /* inside a number */
+    PUSH_LITERAL,      /* inside true, false or null */
+    PUSH_FAILED
+};
+
+#define IS_NUMBER_CHAR(c) (((c) >= '0' && (c) <= '9') || (c) == '-' || (c) == '+' || \
+                           (c) == '.' || (c) == 'e' || (c) == 'E')
+
+static bool push_fail(struct JsonPushParser* const parser, const char* const reason) {
+    if (parser->state != PUSH_FAILED) {
+        parser->state = PUSH_FAILED;
+        parser->error.reason = reason;
+        parser->error.offset = 0;
+    }
+    return false;
+}
+
+/* report the failure at the start of the token, which may be in an earlier chunk */
+static bool push_fail_token(struct JsonPushParser* const parser, const char* const reason) {
+    if (parser->state != PUSH_FAILED) {
+        push_fail(parser, reason);
+        parser->error.offset = parser->token_offset + 1;
+    }
+    return false;
+}
+
+/* why anything but what the state waits for is an error, the same reasons the parser gives */
+static const char *push_expected(const struct JsonPushParser* const parser) {
+    switch (parser->state) {
+    case PUSH_OBJECT_FIRST:
+    case PUSH_KEY:
+        return "expected a string key";
+    case PUSH_COLON:
+        return "expected ':'";
+    case PUSH_AFTER_VALUE:
+        return parser->stack[parser->depth - 1] == '[' ? "expected ',' or ']'" : "expected ',' or '}'";
+    case PUSH_DONE:
+        return "trailing characters after the value";
+    default:
+        return "unexpected end of input";
+    }
+}
+
+/* call a handler callback if it is set, returning false from it aborts the parse */
+#define EMIT(parser, callback, arguments) \
+    ((parser)->handler->callback == NULL || (parser)->handler->callback arguments || \
+     push_fail((parser), "aborted by handler"))
+
+void json_push_parser_construct(struct JsonPushParser* const parser, const struct JsonHandler* const handler) {
+    parser->handler = handler;
+    parser->state = PUSH_VALUE;
+    parser->stack = NULL;
+    parser->depth = 0;
+    parser->stack_allocated = 0;
+    parser->max_depth = JSON_MAX_DEPTH_DEFAULT;
+    parser->token = NULL;
+    parser->token_length = 0;
+    parser->token_allocated = 0;
+    parser->token_is_key = false;
+    parser->literal = NULL;
+    parser->literal_matched = 0;
+    parser->token_offset = 0;
+    parser->checked = 0;
+    parser->checked_offset = 0;
+    parser->escape_length = 0;
+    parser->offset = 0;
+    parser->line = 0;
+    parser->line_start = 0;
+    parser->error.offset = 0;
+    parser->error.line = 0;
+    parser->error.column = 0;
+    parser->error.reason = NULL;
+}
+
+void json_push_parser_dealloc(struct JsonPushParser* const parser) {
+    free(parser->stack);
+    free(parser->token);
+    parser->stack = NULL;
+    parser->token = NULL;
+}
+
+/* add length bytes to the token, keeping it NUL-terminated */
+static bool push_token_append(struct JsonPushParser* const parser, const char* const data, const size_t length) {
+    size_t allocated = parser->token_allocated ? parser->token_allocated : 64;
+    char *token;
+
+    if (parser->token_length + length + 1 > parser->token_allocated) {
+        while (allocated < parser->token_length + length + 1)
+            allocated *= 2;
+
+        token = realloc(parser->token, allocated);
+        if (token == NULL)
+            return push_fail(parser, "out of memory");
+
+        parser->token = token;
+        parser->token_allocated = allocated;
+    }
+
+    memcpy(parser->token + parser->token_length, data, length);
+    parser->token_length += length;
+    parser->token[parser->token_length] = '\0';
+    return true;
+}
+
+static bool push_value_done(struct JsonPushParser* const parser) {
+    parser->state = parser->depth == 0 ? PUSH_DONE : PUSH_AFTER_VALUE;
+    return true;
+}
+
+static bool push_open(struct JsonPushParser* const parser, const char container) {
+    size_t allocated;
+    char *stack;
+
+    if (parser->depth >= parser->stack_allocated) {
+        allocated = parser->stack_allocated ? parser->stack_allocated * 2 : 32;
+        stack = realloc(parser->stack, allocated);
+        if (stack == NULL)
+            return push_fail(parser, "out of memory");
+
+        parser->stack = stack;
+        parser->stack_allocated = allocated;
+    }
+
+    parser->stack[parser->depth++] = container;
+
+    if (container == '[') {
+        parser->state = PUSH_ARRAY_FIRST;
+        return EMIT(parser, on_array_start, (parser->handler->context));
+    }
+    parser->state = PUSH_OBJECT_FIRST;
+    return EMIT(parser, on_object_start, (parser->handler->context));
+}
+
+static bool push_close(struct JsonPushParser* const parser) {
+    if (parser->stack[--parser->depth] == '[') {
+        if (!EMIT(parser, on_array_end, (parser->handler->context)))
+            return false;
+    } else if (!EMIT(parser, on_object_end, (parser->handler->context))) {
+        return false;
+    }
+
+    return push_value_done(parser);
+}
+
+/*
+ * Check what came into the buffered string raw since the last check, which
+ * is done whenever a run of raw bytes ends. What escapes decode to is valid
+ * UTF-8 already.
+ */
+static bool push_check_utf8(struct JsonPushParser* const parser) {
+    const size_t unchecked = parser->token_length - parser->checked;
+    const size_t valid = scan_utf8_n(parser->token + parser->checked, unchecked);
+
+    if (valid != unchecked) {
+        parser->token_offset = parser->checked_offset + valid;
+        return push_fail_token(parser, "invalid UTF-8");
+    }
+
+    parser->checked = parser->token_length;
+    return true;
+}
+
+static bool push_string(struct JsonPushParser* const parser, const char* const string, const size_t length) {
+    if (string == parser->token && !push_check_utf8(parser))
+        return false;
+
+    if (parser->token_is_key) {
+        parser->state = PUSH_COLON;
+        return EMIT(parser, on_key, (parser->handler->context, string, length));
+    }
+
+    return EMIT(parser, on_string, (parser->handler->context, string, length)) &&
+           push_value_done(parser);
+}
+
+/*
+ * A string just started at chunk[*idx]. One that ends within the chunk and
+ * has no escapes is handed out right from it, anything else is copied into
+ * the token as it arrives.
+ */
+static bool push_string_start(struct JsonPushParser* const parser, const char* const chunk,
+                              const size_t length, size_t* const idx) {
+    size_t run = scan_string_n(chunk + *idx, length - *idx), valid;
+
+    if (*idx + run < length && chunk[*idx + run] == '"') {
+        valid = scan_utf8_n(chunk + *idx, run);
+        if (valid != run) {
+            *idx += valid;
+            return push_fail(parser, "invalid UTF-8");
+        }
+
+        *idx += run + 1;
+        return push_string(parser, chunk + *idx - run - 1, run);
+    }
+
+    parser->token_length = 0;
+    parser->checked = 0;
+    parser->checked_offset = parser->offset + *idx;
+    parser->state = PUSH_STRING;
+    if (!push_token_append(parser, chunk + *idx, run))
+        return false;
+
+    *idx += run;
+    return true;
+}
+
+/* how long the escape is, as far as its first length bytes tell */
+static size_t push_escape_length(const char* const escape, const size_t length) {
+    if (escape[0] != 'u')
+        return 1;
+    if (length < 5)
+        return 5;
+
+    /* a high surrogate, the escaped low one has to come along */
+    if ((escape[1] | 0x20) == 'd' &&
+        ((escape[2] >= '8' && escape[2] <= '9') || (escape[2] | 0x20) == 'a' || (escape[2] | 0x20) == 'b'))
+        return 11;
+    return 5;
+}
+
+/* gather the escape after a backslash, which may go on in the next chunk, and decode it once it's all there */
+static bool push_escape(struct JsonPushParser* const parser, const char* const chunk,
+                        const size_t length, size_t* const idx) {
+    char decoded[4];
+    size_t written;
+
+    while (*idx < length) {
+        parser->escape[parser->escape_length++] = chunk[(*idx)++];
+        if (parser->escape_length < push_escape_length(parser->escape, parser->escape_length))
+            continue;
+
+        if (parser->escape[0] == 'u') {
+            if (scan_unicode(parser->escape, parser->escape_length, decoded, &written) == 0)
+                return push_fail_token(parser, "invalid escape");
+        } else {
+            decoded[0] = scan_escape(parser->escape[0]);
+            written = 1;
+            if (decoded[0] == '\0')
+                return push_fail_token(parser, "invalid escape");
+        }
+
+        parser->state = PUSH_STRING;
+        if (!push_token_append(parser, decoded, written))
+            return false;
+
+        parser->checked = parser->token_length;
+        parser->checked_offset = parser->offset + *idx;
+        return true;
+    }
+
+    return true;
+}
+
+/*
+ * The number's text must be followed by a byte that can't be part of it.
+ * Like the parser, take the longest number the text starts with, and fail
+ * on whatever is left over as the byte after a value.
+ */
+static bool push_number(struct JsonPushParser* const parser, const char* const text, const size_t length) {
+    struct JsonNumber number;
+    size_t consumed = number_parse(text, length, &number);
+
+    if (consumed == 0)
+        return push_fail_token(parser, "invalid number");
+
+    if (number.integer && parser->handler->on_int != NULL) {
+        if (!EMIT(parser, on_int, (parser->handler->context, number.as.integer)))
+            return false;
+    } else {
+        if (number.integer)
+            number.as.number = (double)number.as.integer;
+        if (!EMIT(parser, on_number, (parser->handler->context, number.as.number)))
+            return false;
+    }
+
+    push_value_done(parser);
+    if (consumed == length)
+        return true;
+
+    parser->token_offset += consumed;
+    return push_fail_token(parser, push_expected(parser));
+}
+
+static bool push_literal(struct JsonPushParser* const parser) {
+    switch (parser->literal[0]) {
+    case 'n':
+        if (!EMIT(parser, on_null, (parser->handler->context)))
+            return false;
+        break;
+    case 't':
+        if (!EMIT(parser, on_bool, (parser->handler->context, true)))
+            return false;
+        break;
+    default:
+        if (!EMIT(parser, on_bool, (parser->handler->context, false)))
+            return false;
+    }
+
+    return push_value_done(parser);
+}
+
+/* a value starts at chunk[*idx] */
+static bool push_value(struct JsonPushParser* const parser, const char* const chunk,
+                       const size_t length, size_t* const idx) {
+    switch (chunk[*idx]) {
+    case '"':
+        ++*idx;
+        parser->token_is_key = false;
+        return push_string_start(parser, chunk, length, idx);
+    case '[':
+    case '{':
+        if (parser->depth >= parser->max_depth)
+            return push_fail(parser, "nested too deeply");
+        ++*idx;
+        return push_open(parser, chunk[*idx - 1]);
+    case '-':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+        parser->token_offset = parser->offset + *idx;
+        parser->token_length = 0;
+        parser->state = PUSH_NUMBER;
+        return true;
+    case 'n':
+        parser->literal = "null";
+        break;
+    case 't':
+        parser->literal = "true";
+        break;
+    case 'f':
+        parser->literal = "false";
+        break;
+    default:
+        return push_fail(parser, "unexpected character");
+    }
+
+    parser->token_offset = parser->offset + *idx;
+    parser->literal_matched = 0;
+    parser->state = PUSH_LITERAL;
+    return true;
+}
+
+/* run the state machine over the chunk, *idx is left where it stopped */
+static bool push_run(struct JsonPushParser* const parser, const char* const chunk,
+                     const size_t length, size_t* const idx) {
+    size_t run;
+    char closer;
+
+    while (*idx < length) {
+        if (parser->state < PUSH_STRING) {
+            *idx += scan_whitespace_n(chunk + *idx, length - *idx);
+            if (*idx == length)
+                break;
+        }
+
+        switch (parser->state) {
+        case PUSH_VALUE:
+            if (!push_value(parser, chunk, length, idx))
+                return false;
+            break;
+
+        case PUSH_ARRAY_FIRST:
+        case PUSH_OBJECT_FIRST:
+            closer = parser->state == PUSH_ARRAY_FIRST ? ']' : '}';
+            if (chunk[*idx] == closer) {
+                ++*idx;
+                if (!push_close(parser))
+                    return false;
+            } else {
+                parser->state = parser->state == PUSH_ARRAY_FIRST ? PUSH_VALUE : PUSH_KEY;
+            }
+            break;
+
+        case PUSH_KEY:
+            if (chunk[*idx] != '"')
+                return push_fail(parser, push_expected(parser));
+            ++*idx;
+            parser->token_is_key = true;
+            if (!push_string_start(parser, chunk, length, idx))
+                return false;
+            break;
+
+        case PUSH_COLON:
+            if (chunk[*idx] != ':')
+                return push_fail(parser, push_expected(parser));
+            ++*idx;
+            parser->state = PUSH_VALUE;
+            break;
+
+        case PUSH_AFTER_VALUE:
+            closer = parser->stack[parser->depth - 1] == '[' ? ']' : '}';
+            if (chunk[*idx] == ',') {
+                ++*idx;
+                parser->state = closer == ']' ? PUSH_VALUE : PUSH_KEY;
+            } else if (chunk[*idx] == closer) {
+                ++*idx;
+                if (!push_close(parser))
+                    return false;
+            } else {
+                return push_fail(parser, push_expected(parser));
+            }
+            break;
+
+        case PUSH_DONE:
+            return push_fail(parser, push_expected(parser));
+
+        case PUSH_STRING:
+            run = scan_string_n(chunk + *idx, length - *idx);
+            if (!push_token_append(parser, chunk + *idx, run))
+                return false;
+            *idx += run;
+
+            if (*idx == length)
+                break;
+            if (chunk[*idx] == '"') {
+                ++*idx;
+                if (!push_string(parser, parser->token, parser->token_length))
+                    return false;
+            } else if (!push_check_utf8(parser)) {
+                return false;
+            } else if (chunk[*idx] != '\\') {
+                return push_fail(parser, "control character in string");
+            } else {
+                parser->token_offset = parser->offset + *idx;
+                parser->escape_length = 0;
+                ++*idx;
+                parser->state = PUSH_ESCAPE;
+            }
+            break;
+
+        case PUSH_ESCAPE:
+            if (!push_escape(parser, chunk, length, idx))
+                return false;
+            break;
+
+        case PUSH_NUMBER:
+            for (run = 0; *idx + run < length && IS_NUMBER_CHAR(chunk[*idx + run]); ++run)
+                ;
+
+            /* the number may go on in the next chunk */
+            if (*idx + run == length || parser->token_length != 0) {
+                if (!push_token_append(parser, chunk + *idx, run))
+                    return false;
+                *idx += run;
+                if (*idx == length)
+                    break;
+                if (!push_number(parser, parser->token, parser->token_length))
+                    return false;
+            } else {
+                if (!push_number(parser, chunk + *idx, run))
+                    return false;
+                *idx += run;
+            }
+            break;
+
+        case PUSH_LITERAL:
+            for (; *idx < length && parser->literal[parser->literal_matched] != '\0'; ++*idx) {
+                if (chunk[*idx] != parser->literal[parser->literal_matched])
+                    return push_fail_token(parser, "invalid literal");
+                ++parser->literal_matched;
+            }
+            if (parser->literal[parser->literal_matched] == '\0' && !push_literal(parser))
+                return false;
+            break;
+
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* fill in where the parse failed, the offset is already there if it was a token */
+static void push_error(struct JsonPushParser* const parser, const size_t offset) {
+    if (parser->error.offset == 0)
+        parser->error.offset = offset;
+    else
+        --parser->error.offset;
+
+    parser->error.line = 1 + parser->line;
+    parser->error.column = 1 + parser->error.offset - parser->line_start;
+}
+
+/* account for the first length bytes of chunk in the line count */
+static void push_count_lines(struct JsonPushParser* const parser, const char* const chunk, const size_t length) {
+    size_t newlines = scan_newlines(chunk, length);
+    size_t i = length;
+
+    if (newlines == 0)
+        return;
+
+    while (chunk[i - 1] != '\n')
+        --i;
+
+    parser->line += newlines;
+    parser->line_start = parser->offset + i;
+}
+
+bool json_push_parser_feed(struct JsonPushParser* const parser, const char* const chunk, const size_t length) {
+    size_t idx = 0;
+
+    if (parser->state == PUSH_FAILED)
+        return false;
+
+    if (!push_run(parser, chunk, length, &idx)) {
+        push_count_lines(parser, chunk, idx);
+        push_error(parser, parser->offset + idx);
+        return false;
+    }
+
+    push_count_lines(parser, chunk, length);
+    parser->offset += length;
+    return true;
+}
+
+bool json_push_parser_finish(struct JsonPushParser* const parser) {
+    switch (parser->state) {
+    case PUSH_DONE:
+        return true;
+    case PUSH_FAILED:
+        return false;
+    case PUSH_NUMBER:
+        /* a number is only known to be over once something follows it */
+        if (push_number(parser, parser->token, parser->token_length) && parser->depth == 0)
+            return true;
+        push_fail(parser, push_expected(parser));
+        break;
+    case PUSH_STRING:
+        if (push_check_utf8(parser))
+            push_fail(parser, "unterminated string");
+        break;
+    case PUSH_ESCAPE:
+        /* the input ends in the middle of an escape */
+        push_fail_token(parser, "invalid escape");
+        break;
+    case PUSH_LITERAL:
+        push_fail_token(parser, "invalid literal");
+        break;
+    default:
+        push_fail(parser, push_expected(parser));
+    }
+
+    push_error(parser, parser->offset);
+    return false;
+}
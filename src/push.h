@@ -0,0 +1,90 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JSON_PUSH_H
+#define JSON_PUSH_H
+
+#include "parser.h"
+
+#include <stddef.h>
+
+/*
+ * A parser that is fed the document a chunk at a time, in whatever pieces
+ * it arrives in, and reports what it finds to a struct JsonHandler as soon
+ * as each part is complete. Everything, including strings, numbers and
+ * escapes, may be split between chunks. Only the token split by a chunk
+ * boundary is ever buffered, so memory use is bounded by the longest string
+ * or number rather than by the document.
+ *
+ * Arrays and objects nesting deeper than max_depth fail as they do with the
+ * parser, which also bounds the stack. It is JSON_MAX_DEPTH_DEFAULT to
+ * start with, set it before the first feed to change it.
+ *
+ * Events carry the same guarantees as with parse_events.
+ */
+struct JsonPushParser {
+    const struct JsonHandler *handler;
+    int state;
+    /* the containers currently open, '[' or '{', innermost last */
+    char *stack;
+    size_t depth, stack_allocated, max_depth;
+    /* a string or number that didn't fit the chunk it started in */
+    char *token;
+    size_t token_length, token_allocated;
+    bool token_is_key;
+    /* the literal being matched and how much of it was matched already */
+    const char *literal;
+    size_t literal_matched;
+    size_t token_offset; /* where the current number, literal or escape started */
+    /*
+     * How much of a buffered string is known to be UTF-8, and where the
+     * byte after that is in the document. The token holds nothing but the
+     * bytes that came in raw past checked.
+     */
+    size_t checked, checked_offset;
+    /* an escape split between chunks, without its backslash */
+    char escape[11];
+    size_t escape_length;
+    /* where the current chunk starts in the document */
+    size_t offset, line, line_start;
+    /* filled in once feeding fails */
+    struct JsonError error;
+};
+
+void json_push_parser_construct(struct JsonPushParser* const parser, const struct JsonHandler* const handler);
+
+/*
+ * Parse the next length bytes of the document. Returns false once the
+ * document is known to be invalid or a callback stopped the parse, after
+ * which parser->error says why and every further call fails.
+ */
+bool json_push_parser_feed(struct JsonPushParser* const parser, const char* const chunk, const size_t length);
+
+/* tell the parser the document ended, fails if it isn't complete */
+bool json_push_parser_finish(struct JsonPushParser* const parser);
+
+void json_push_parser_dealloc(struct JsonPushParser* const parser);
+
+#endif /* JSON_PUSH_H */
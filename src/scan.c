@@ -0,0 +1,621 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "scan.h"
+
+#include <string.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__) && \
+    (defined(__x86_64__) || defined(__i386__))
+# define SCAN_X86
+# include <immintrin.h>
+#endif
+
+/* the vector kernels knowingly read past the terminator, within its block */
+#if defined(__SANITIZE_ADDRESS__)
+# define SCAN_NO_SANITIZE __attribute__((no_sanitize_address))
+#elif defined(__clang__) && defined(__has_feature)
+# if __has_feature(address_sanitizer)
+#  define SCAN_NO_SANITIZE __attribute__((no_sanitize_address))
+# endif
+#endif
+#ifndef SCAN_NO_SANITIZE
+# define SCAN_NO_SANITIZE
+#endif
+
+enum {
+    SCAN_WHITESPACE = 1, /* ' ', '\t', '\n', '\r' */
+    SCAN_STRING_STOP = 2 /* '"', '\\', control characters */
+};
+
+static const unsigned char scan_class[256] = {
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 2, 2, 3, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    1, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0
+    /* everything from 0x60 up is zero */
+};
+
+/*
+ * Validating UTF-8 one sequence at a time, the range of the second byte of
+ * a sequence rules out overlong forms, surrogates and too big code points.
+ * The vector kernels fall back on it to find where exactly an error is.
+ */
+static size_t scan_utf8_n_scalar(const char *p, size_t length) {
+    const unsigned char *cur = (const unsigned char *)p, *end = cur + length;
+    unsigned char low, high;
+#ifndef SCAN_X86
+    json_uint word;
+#endif
+    size_t need, i;
+
+    while (cur < end) {
+        /* ascii goes by 16 or 8 bytes at a time */
+        if (*cur < 0x80) {
+#ifdef SCAN_X86
+            for (++cur; end - cur >= 16; cur += 16) {
+                if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)cur)) != 0)
+                    break;
+            }
+#else
+            for (++cur; end - cur >= 8; cur += 8) {
+                memcpy(&word, cur, 8);
+                if (word & ((json_uint)0x80808080UL << 32 | 0x80808080UL))
+                    break;
+            }
+#endif
+            while (cur < end && *cur < 0x80)
+                ++cur;
+            continue;
+        }
+
+        low = 0x80;
+        high = 0xbf;
+        if (*cur < 0xc2) {
+            break;
+        } else if (*cur < 0xe0) {
+            need = 1;
+        } else if (*cur < 0xf0) {
+            need = 2;
+            if (*cur == 0xe0)
+                low = 0xa0;
+            else if (*cur == 0xed)
+                high = 0x9f;
+        } else if (*cur < 0xf5) {
+            need = 3;
+            if (*cur == 0xf0)
+                low = 0x90;
+            else if (*cur == 0xf4)
+                high = 0x8f;
+        } else {
+            break;
+        }
+
+        if ((size_t)(end - cur) <= need || cur[1] < low || cur[1] > high)
+            break;
+        for (i = 2; i <= need; ++i)
+            if ((cur[i] & 0xc0) != 0x80)
+                break;
+        if (i <= need)
+            break;
+
+        cur += need + 1;
+    }
+
+    return (const char *)cur - p;
+}
+
+#ifndef SCAN_X86
+
+static size_t scan_whitespace_scalar(const char *p) {
+    const unsigned char *cur = (const unsigned char *)p;
+
+    while (scan_class[*cur] & SCAN_WHITESPACE)
+        ++cur;
+    return (const char *)cur - p;
+}
+
+static size_t scan_string_scalar(const char *p) {
+    const unsigned char *cur = (const unsigned char *)p;
+
+    while (!(scan_class[*cur] & SCAN_STRING_STOP))
+        ++cur;
+    return (const char *)cur - p;
+}
+
+static size_t scan_string_n_scalar(const char *p, size_t length) {
+    const unsigned char *cur = (const unsigned char *)p, *end = cur + length;
+
+    while (cur < end && !(scan_class[*cur] & SCAN_STRING_STOP))
+        ++cur;
+    return (const char *)cur - p;
+}
+
+#else
+
+/* bit i is set if byte i of the block is whitespace */
+#define SSE2_WHITESPACE_MASK(x) ((unsigned)_mm_movemask_epi8(_mm_or_si128( \
+    _mm_or_si128(_mm_cmpeq_epi8((x), _mm_set1_epi8(' ')), _mm_cmpeq_epi8((x), _mm_set1_epi8('\t'))), \
+    _mm_or_si128(_mm_cmpeq_epi8((x), _mm_set1_epi8('\n')), _mm_cmpeq_epi8((x), _mm_set1_epi8('\r'))))))
+
+/* bit i is set if byte i of the block ends an unescaped string run */
+#define SSE2_STRING_STOP_MASK(x) ((unsigned)_mm_movemask_epi8(_mm_or_si128( \
+    _mm_or_si128(_mm_cmpeq_epi8((x), _mm_set1_epi8('"')), _mm_cmpeq_epi8((x), _mm_set1_epi8('\\'))), \
+    _mm_cmpeq_epi8(_mm_max_epu8((x), _mm_set1_epi8(0x1f)), _mm_set1_epi8(0x1f)))))
+
+#define AVX2_WHITESPACE_MASK(x) ((unsigned)_mm256_movemask_epi8(_mm256_or_si256( \
+    _mm256_or_si256(_mm256_cmpeq_epi8((x), _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8((x), _mm256_set1_epi8('\t'))), \
+    _mm256_or_si256(_mm256_cmpeq_epi8((x), _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8((x), _mm256_set1_epi8('\r'))))))
+
+#define AVX2_STRING_STOP_MASK(x) ((unsigned)_mm256_movemask_epi8(_mm256_or_si256( \
+    _mm256_or_si256(_mm256_cmpeq_epi8((x), _mm256_set1_epi8('"')), _mm256_cmpeq_epi8((x), _mm256_set1_epi8('\\'))), \
+    _mm256_cmpeq_epi8(_mm256_max_epu8((x), _mm256_set1_epi8(0x1f)), _mm256_set1_epi8(0x1f)))))
+
+/*
+ * Every kernel starts at the aligned block holding p and throws away the
+ * bits of the bytes in front of p. The terminator always stops the scan,
+ * so no block past the one holding it is ever loaded.
+ */
+
+SCAN_NO_SANITIZE
+static size_t scan_whitespace_sse2(const char *p) {
+    const char *block = (const char *)((size_t)p & ~(size_t)15);
+    unsigned mask;
+
+    mask = ~SSE2_WHITESPACE_MASK(_mm_load_si128((const __m128i *)block)) & (0xffffu << (p - block)) & 0xffffu;
+    while (mask == 0) {
+        block += 16;
+        mask = ~SSE2_WHITESPACE_MASK(_mm_load_si128((const __m128i *)block)) & 0xffffu;
+    }
+    return block + __builtin_ctz(mask) - p;
+}
+
+SCAN_NO_SANITIZE
+static size_t scan_string_sse2(const char *p) {
+    const char *block = (const char *)((size_t)p & ~(size_t)15);
+    unsigned mask;
+
+    mask = SSE2_STRING_STOP_MASK(_mm_load_si128((const __m128i *)block)) & (0xffffu << (p - block));
+    while (mask == 0) {
+        block += 16;
+        mask = SSE2_STRING_STOP_MASK(_mm_load_si128((const __m128i *)block));
+    }
+    return block + __builtin_ctz(mask) - p;
+}
+
+SCAN_NO_SANITIZE __attribute__((target("avx2")))
+static size_t scan_whitespace_avx2(const char *p) {
+    const char *block = (const char *)((size_t)p & ~(size_t)31);
+    unsigned mask;
+
+    mask = ~AVX2_WHITESPACE_MASK(_mm256_load_si256((const __m256i *)block)) & (0xffffffffu << (p - block));
+    while (mask == 0) {
+        block += 32;
+        mask = ~AVX2_WHITESPACE_MASK(_mm256_load_si256((const __m256i *)block));
+    }
+    return block + __builtin_ctz(mask) - p;
+}
+
+SCAN_NO_SANITIZE __attribute__((target("avx2")))
+static size_t scan_string_avx2(const char *p) {
+    const char *block = (const char *)((size_t)p & ~(size_t)31);
+    unsigned mask;
+
+    mask = AVX2_STRING_STOP_MASK(_mm256_load_si256((const __m256i *)block)) & (0xffffffffu << (p - block));
+    while (mask == 0) {
+        block += 32;
+        mask = AVX2_STRING_STOP_MASK(_mm256_load_si256((const __m256i *)block));
+    }
+    return block + __builtin_ctz(mask) - p;
+}
+
+/* the bounded kernels can't lean on a terminator, so they load unaligned blocks */
+
+static size_t scan_string_n_sse2(const char *p, size_t length) {
+    const char *cur = p, *end = p + length;
+    unsigned mask;
+
+    for (; end - cur >= 16; cur += 16) {
+        mask = SSE2_STRING_STOP_MASK(_mm_loadu_si128((const __m128i *)cur));
+        if (mask != 0)
+            return cur + __builtin_ctz(mask) - p;
+    }
+
+    while (cur < end && !(scan_class[(unsigned char)*cur] & SCAN_STRING_STOP))
+        ++cur;
+    return cur - p;
+}
+
+__attribute__((target("avx2")))
+static size_t scan_string_n_avx2(const char *p, size_t length) {
+    const char *cur = p, *end = p + length;
+    unsigned mask;
+
+    for (; end - cur >= 32; cur += 32) {
+        mask = AVX2_STRING_STOP_MASK(_mm256_loadu_si256((const __m256i *)cur));
+        if (mask != 0)
+            return cur + __builtin_ctz(mask) - p;
+    }
+
+    return cur - p + scan_string_n_sse2(cur, end - cur);
+}
+
+/*
+ * UTF-8 validation 32 bytes at a time, after Keiser and Lemire's
+ * "Validating UTF-8 In Less Than One Instruction Per Byte". Every byte is
+ * looked up by its high nibble and by both nibbles of the byte before it,
+ * the three flag sets only share a bit where that pair of bytes can't
+ * follow each other. The flags that say a continuation is missing or too
+ * many are then checked against where 3 and 4 byte sequences need them.
+ */
+#define UTF8_TOO_SHORT 0x01 /* a lead or ascii where a continuation should be */
+#define UTF8_TOO_LONG 0x02 /* a continuation after ascii */
+#define UTF8_OVERLONG_3 0x04
+#define UTF8_TOO_LARGE 0x08
+#define UTF8_SURROGATE 0x10
+#define UTF8_OVERLONG_2 0x20
+#define UTF8_TOO_LARGE_1000 0x40
+#define UTF8_OVERLONG_4 0x40
+#define UTF8_TWO_CONTS 0x80 /* two continuations in a row, fine within a 3 or 4 byte sequence */
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+#define UTF8_TABLE(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p) _mm256_setr_epi8( \
+    (char)(a), (char)(b), (char)(c), (char)(d), (char)(e), (char)(f), (char)(g), (char)(h), \
+    (char)(i), (char)(j), (char)(k), (char)(l), (char)(m), (char)(n), (char)(o), (char)(p), \
+    (char)(a), (char)(b), (char)(c), (char)(d), (char)(e), (char)(f), (char)(g), (char)(h), \
+    (char)(i), (char)(j), (char)(k), (char)(l), (char)(m), (char)(n), (char)(o), (char)(p))
+
+#define AVX2_HIGH_NIBBLES(x) _mm256_and_si256(_mm256_srli_epi16((x), 4), _mm256_set1_epi8(0x0f))
+
+__attribute__((target("avx2")))
+static size_t scan_utf8_n_avx2(const char *p, size_t length) {
+    const __m256i byte_1_high = UTF8_TABLE(
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+        UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+        UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4);
+    const __m256i byte_1_low = UTF8_TABLE(
+        UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+        UTF8_CARRY | UTF8_OVERLONG_2,
+        UTF8_CARRY,
+        UTF8_CARRY,
+        UTF8_CARRY | UTF8_TOO_LARGE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000);
+    const __m256i byte_2_high = UTF8_TABLE(
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 |
+            UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+    /* a block ending in these bytes ends in the middle of a sequence */
+    const __m256i incomplete = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        (char)(0xf0 - 1), (char)(0xe0 - 1), (char)(0xc0 - 1));
+    const char *cur = p, *end = p + length, *back;
+    __m256i input, previous = _mm256_setzero_si256(), shifted, prev1, error, continuations;
+
+    for (; end - cur >= 32; cur += 32) {
+        input = _mm256_loadu_si256((const __m256i *)cur);
+
+        if (_mm256_movemask_epi8(input) == 0) {
+            error = _mm256_subs_epu8(previous, incomplete);
+        } else {
+            /* the bytes 1, 2 and 3 before each one, reaching back into the previous block */
+            shifted = _mm256_permute2x128_si256(previous, input, 0x21);
+            prev1 = _mm256_alignr_epi8(input, shifted, 15);
+
+            error = _mm256_and_si256(_mm256_and_si256(
+                _mm256_shuffle_epi8(byte_1_high, AVX2_HIGH_NIBBLES(prev1)),
+                _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, _mm256_set1_epi8(0x0f)))),
+                _mm256_shuffle_epi8(byte_2_high, AVX2_HIGH_NIBBLES(input)));
+
+            /* the high bit is set where the byte 2 back leads 3 bytes or more, or the one 3 back 4 */
+            continuations = _mm256_or_si256(
+                _mm256_subs_epu8(_mm256_alignr_epi8(input, shifted, 14), _mm256_set1_epi8((char)(0xe0 - 0x80))),
+                _mm256_subs_epu8(_mm256_alignr_epi8(input, shifted, 13), _mm256_set1_epi8((char)(0xf0 - 0x80))));
+            error = _mm256_xor_si256(error, _mm256_and_si256(continuations, _mm256_set1_epi8((char)0x80)));
+        }
+
+        if (!_mm256_testz_si256(error, error))
+            break;
+        previous = input;
+    }
+
+    /* start over on the sequence that runs into the rest, which may be the one that's wrong */
+    back = cur;
+    while (back > p && cur - back < 3 && ((unsigned char)back[-1] & 0xc0) == 0x80)
+        --back;
+    if (back > p && (unsigned char)back[-1] >= 0xc0)
+        --back;
+
+    return back - p + scan_utf8_n_scalar(back, end - back);
+}
+
+#endif /* SCAN_X86 */
+
+static size_t scan_whitespace_init(const char *p);
+static size_t scan_string_init(const char *p);
+static size_t scan_string_n_init(const char *p, size_t length);
+static size_t scan_utf8_n_init(const char *p, size_t length);
+
+static size_t (*scan_whitespace_impl)(const char *p) = scan_whitespace_init;
+static size_t (*scan_string_impl)(const char *p) = scan_string_init;
+static size_t (*scan_string_n_impl)(const char *p, size_t length) = scan_string_n_init;
+static size_t (*scan_utf8_n_impl)(const char *p, size_t length) = scan_utf8_n_init;
+
+/* pick the best kernels this CPU supports, racing threads pick the same ones */
+static void scan_select(void) {
+#ifdef SCAN_X86
+    if (__builtin_cpu_supports("avx2")) {
+        scan_whitespace_impl = scan_whitespace_avx2;
+        scan_string_impl = scan_string_avx2;
+        scan_string_n_impl = scan_string_n_avx2;
+        scan_utf8_n_impl = scan_utf8_n_avx2;
+    } else {
+        scan_whitespace_impl = scan_whitespace_sse2;
+        scan_string_impl = scan_string_sse2;
+        scan_string_n_impl = scan_string_n_sse2;
+        scan_utf8_n_impl = scan_utf8_n_scalar;
+    }
+#else
+    scan_whitespace_impl = scan_whitespace_scalar;
+    scan_string_impl = scan_string_scalar;
+    scan_string_n_impl = scan_string_n_scalar;
+    scan_utf8_n_impl = scan_utf8_n_scalar;
+#endif
+}
+
+static size_t scan_whitespace_init(const char *p) {
+    scan_select();
+    return scan_whitespace_impl(p);
+}
+
+static size_t scan_string_init(const char *p) {
+    scan_select();
+    return scan_string_impl(p);
+}
+
+static size_t scan_string_n_init(const char *p, size_t length) {
+    scan_select();
+    return scan_string_n_impl(p, length);
+}
+
+static size_t scan_utf8_n_init(const char *p, size_t length) {
+    scan_select();
+    return scan_utf8_n_impl(p, length);
+}
+
+size_t scan_whitespace(const char *p) {
+    size_t i;
+
+    /* most runs are a newline and a little indentation, don't bother the vector unit */
+    for (i = 0; i < 8; ++i) {
+        if (!(scan_class[(unsigned char)p[i]] & SCAN_WHITESPACE))
+            return i;
+    }
+    return i + scan_whitespace_impl(p + i);
+}
+
+size_t scan_string(const char *p) {
+    return scan_string_impl(p);
+}
+
+size_t scan_whitespace_n(const char *p, size_t length) {
+    const char *cur = p, *end = p + length;
+#ifdef SCAN_X86
+    unsigned mask;
+
+    for (; cur < end && cur - p < 8; ++cur) {
+        if (!(scan_class[(unsigned char)*cur] & SCAN_WHITESPACE))
+            return cur - p;
+    }
+
+    for (; end - cur >= 16; cur += 16) {
+        mask = ~SSE2_WHITESPACE_MASK(_mm_loadu_si128((const __m128i *)cur)) & 0xffffu;
+        if (mask != 0)
+            return cur + __builtin_ctz(mask) - p;
+    }
+#endif
+
+    while (cur < end && (scan_class[(unsigned char)*cur] & SCAN_WHITESPACE))
+        ++cur;
+    return cur - p;
+}
+
+size_t scan_string_n(const char *p, size_t length) {
+    return scan_string_n_impl(p, length);
+}
+
+void scan_block(const char *p, struct ScanBlock* const block) {
+#ifdef SCAN_X86
+    __m128i chunk, folded, brackets;
+    int i;
+
+    block->quotes = block->backslashes = block->whitespace = block->operators = block->brackets = 0;
+    block->controls = block->non_ascii = 0;
+
+    for (i = 0; i < 64; i += 16) {
+        chunk = _mm_loadu_si128((const __m128i *)(p + i));
+        /* '[' and ']' only differ from '{' and '}' in bit 5 */
+        folded = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+        brackets = _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                                _mm_cmpeq_epi8(folded, _mm_set1_epi8('}')));
+
+        block->quotes |= (json_uint)(unsigned)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'))) << i;
+        block->backslashes |= (json_uint)(unsigned)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))) << i;
+        block->whitespace |= (json_uint)SSE2_WHITESPACE_MASK(chunk) << i;
+        block->brackets |= (json_uint)(unsigned)_mm_movemask_epi8(brackets) << i;
+        block->operators |= (json_uint)(unsigned)_mm_movemask_epi8(_mm_or_si128(brackets,
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(':')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8(','))))) << i;
+        /* unsigned chunk <= 0x1f */
+        block->controls |= (json_uint)(unsigned)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_min_epu8(chunk, _mm_set1_epi8(0x1f)), chunk)) << i;
+        block->non_ascii |= (json_uint)(unsigned)_mm_movemask_epi8(chunk) << i;
+    }
+#else
+    json_uint bit;
+    int i;
+
+    block->quotes = block->backslashes = block->whitespace = block->operators = block->brackets = 0;
+    block->controls = block->non_ascii = 0;
+
+    for (i = 0; i < 64; ++i) {
+        bit = (json_uint)1 << i;
+        if ((unsigned char)p[i] < 0x20)
+            block->controls |= bit;
+        else if ((unsigned char)p[i] >= 0x80)
+            block->non_ascii |= bit;
+
+        switch (p[i]) {
+        case '"': block->quotes |= bit; break;
+        case '\\': block->backslashes |= bit; break;
+        case ' ': case '\t': case '\n': case '\r': block->whitespace |= bit; break;
+        case '{': case '}': case '[': case ']': block->operators |= bit; block->brackets |= bit; break;
+        case ':': case ',': block->operators |= bit; break;
+        default: break;
+        }
+    }
+#endif
+}
+
+size_t scan_utf8_n(const char *p, size_t length) {
+    /* most strings are too short for the vector kernel to pay off */
+    if (length < 64)
+        return scan_utf8_n_scalar(p, length);
+    return scan_utf8_n_impl(p, length);
+}
+
+char scan_escape(const char escape) {
+    switch (escape) {
+    case '\\': return '\\';
+    case '/': return '/';
+    case '"': return '"';
+    case 'b': return '\b';
+    case 'f': return '\f';
+    case 'n': return '\n';
+    case 'r': return '\r';
+    case 't': return '\t';
+    default: return '\0';
+    }
+}
+
+size_t scan_newlines(const char *p, size_t length) {
+    const char *end = p + length;
+    const char *newline;
+    size_t count = 0;
+
+#ifdef SCAN_X86
+    __m128i newlines = _mm_set1_epi8('\n');
+
+    for (; end - p >= 16; p += 16) {
+        count += __builtin_popcount(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), newlines)));
+    }
+#endif
+
+    while ((newline = memchr(p, '\n', end - p)) != NULL) {
+        ++count;
+        p = newline + 1;
+    }
+
+    return count;
+}
+
+/* the value of the 4 hex digits at p, -1 if they aren't, stopping at the first one that isn't */
+static long scan_hex4(const char *p) {
+    long value = 0;
+    int i;
+
+    for (i = 0; i < 4; ++i) {
+        if (p[i] >= '0' && p[i] <= '9')
+            value = value * 16 + (p[i] - '0');
+        else if ((p[i] | 0x20) >= 'a' && (p[i] | 0x20) <= 'f')
+            value = value * 16 + ((p[i] | 0x20) - 'a' + 10);
+        else
+            return -1;
+    }
+    return value;
+}
+
+size_t scan_unicode(const char *p, size_t length, char* const out, size_t* const written) {
+    long code_point, low;
+    size_t consumed = 5;
+
+    if (length < 5 || p[0] != 'u' || (code_point = scan_hex4(p + 1)) < 0)
+        return 0;
+
+    /* a high surrogate only makes sense along with a low one */
+    if (code_point >= 0xdc00 && code_point <= 0xdfff)
+        return 0;
+    if (code_point >= 0xd800 && code_point <= 0xdbff) {
+        if (length < 11 || p[5] != '\\' || p[6] != 'u' || (low = scan_hex4(p + 7)) < 0xdc00 || low > 0xdfff)
+            return 0;
+        code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+        consumed = 11;
+    }
+
+    if (code_point < 0x80) {
+        out[0] = (char)code_point;
+        *written = 1;
+    } else if (code_point < 0x800) {
+        out[0] = (char)(0xc0 | code_point >> 6);
+        out[1] = (char)(0x80 | (code_point & 0x3f));
+        *written = 2;
+    } else if (code_point < 0x10000) {
+        out[0] = (char)(0xe0 | code_point >> 12);
+        out[1] = (char)(0x80 | (code_point >> 6 & 0x3f));
+        out[2] = (char)(0x80 | (code_point & 0x3f));
+        *written = 3;
+    } else {
+        out[0] = (char)(0xf0 | code_point >> 18);
+        out[1] = (char)(0x80 | (code_point >> 12 & 0x3f));
+        out[2] = (char)(0x80 | (code_point >> 6 & 0x3f));
+        out[3] = (char)(0x80 | (code_point & 0x3f));
+        *written = 4;
+    }
+
+    return consumed;
+}
@@ -0,0 +1,91 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JSON_SCAN_H
+#define JSON_SCAN_H
+
+#include "types.h"
+
+#include <stddef.h>
+
+/*
+ * Block-at-a-time scanning kernels for the parser's hottest loops. They use
+ * AVX2 or SSE2 when the CPU has them (picked at runtime on first use) and a
+ * table driven scalar loop everywhere else.
+ *
+ * The input of the unbounded kernels must be NUL-terminated. Their vector
+ * versions read whole aligned blocks, which may go past the terminator but
+ * never cross into the next page. The _n kernels read nothing past length.
+ */
+
+/* length of the run of json whitespace starting at p */
+size_t scan_whitespace(const char *p);
+
+/* length of the run starting at p that holds no '"', '\\' or control character */
+size_t scan_string(const char *p);
+
+/* same as scan_whitespace, stopping after at most length bytes */
+size_t scan_whitespace_n(const char *p, size_t length);
+
+/* same as scan_string, stopping after at most length bytes */
+size_t scan_string_n(const char *p, size_t length);
+
+/* number of '\n' bytes in the first length bytes of p, reads nothing past them */
+size_t scan_newlines(const char *p, size_t length);
+
+/* bit i of every mask says something about byte i of a 64 byte block */
+struct ScanBlock {
+    json_uint quotes, backslashes, whitespace;
+    json_uint operators; /* '{', '}', '[', ']', ':' and ',' */
+    json_uint brackets; /* just '{', '}', '[' and ']' */
+    json_uint controls; /* bytes below 0x20, whitespace among them */
+    json_uint non_ascii; /* bytes from 0x80 up */
+};
+
+/* classify the 64 bytes at p, all of which must be readable */
+void scan_block(const char *p, struct ScanBlock* const block);
+
+/*
+ * Length of the longest prefix of p that is well-formed UTF-8, made of whole
+ * sequences only: no overlong forms, surrogates or code points past
+ * U+10FFFF. Reads nothing past length. Long runs are checked 32 bytes at a
+ * time where the CPU has AVX2.
+ */
+size_t scan_utf8_n(const char *p, size_t length);
+
+/* the byte a backslash followed by escape stands for, '\0' if that isn't an escape */
+char scan_escape(const char escape);
+
+/*
+ * Decode the \u escape whose 'u' is at p into the UTF-8 of its code point,
+ * up to 4 bytes written to out. A high surrogate is decoded along with the
+ * escaped low one that has to follow it, a low one on its own is invalid.
+ * Returns how many bytes from p on the escape takes up, 5 or 11, and sets
+ * written; 0 if it's invalid. Reads nothing past length or past the first
+ * byte that doesn't fit, and is done reading before it writes.
+ */
+size_t scan_unicode(const char *p, size_t length, char* const out, size_t* const written);
+
+#endif /* JSON_SCAN_H */
@@ -0,0 +1,102 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "stats.h"
+
+#include <string.h>
+#include <time.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+# include <intrin.h>
+#endif
+
+#ifdef JSON_STATS
+
+JSON_STATS_THREAD struct JsonStatsState json_stats_state;
+
+bool json_stats_stop(const enum JsonStatsPhase phase, const bool result) {
+    json_stats_state.stats.cycles[phase] += json_stats_cycles() - json_stats_state.started[phase];
+    return result;
+}
+
+#endif
+
+void json_stats_get(struct JsonStats* const stats) {
+#ifdef JSON_STATS
+    *stats = json_stats_state.stats;
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+void json_stats_reset(void) {
+#ifdef JSON_STATS
+    memset(&json_stats_state, 0, sizeof(json_stats_state));
+#endif
+}
+
+void json_stats_add(struct JsonStats* const total, const struct JsonStats* const stats) {
+    size_t i;
+
+    total->whitespace_bytes += stats->whitespace_bytes;
+    total->string_bytes += stats->string_bytes;
+    total->number_bytes += stats->number_bytes;
+    total->literal_bytes += stats->literal_bytes;
+    total->strings += stats->strings;
+    total->escapes += stats->escapes;
+    total->numbers += stats->numbers;
+    total->literals += stats->literals;
+    total->arrays += stats->arrays;
+    total->objects += stats->objects;
+    if (stats->max_depth > total->max_depth)
+        total->max_depth = stats->max_depth;
+    total->object_lookups += stats->object_lookups;
+    total->object_probes += stats->object_probes;
+    if (stats->object_probe_max > total->object_probe_max)
+        total->object_probe_max = stats->object_probe_max;
+    total->array_reallocs += stats->array_reallocs;
+    total->object_reallocs += stats->object_reallocs;
+    total->object_reindexes += stats->object_reindexes;
+    total->scratch_reallocs += stats->scratch_reallocs;
+    total->nesting_reallocs += stats->nesting_reallocs;
+
+    for (i = 0; i < JSON_STATS_PHASES; ++i)
+        total->cycles[i] += stats->cycles[i];
+}
+
+json_uint json_stats_cycles(void) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+    json_uint cycles;
+
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(cycles));
+    return cycles;
+#else
+    return (json_uint)clock();
+#endif
+}
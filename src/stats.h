@@ -0,0 +1,116 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JSON_STATS_H
+#define JSON_STATS_H
+
+#include "types.h"
+
+/* the phases of a parse that are timed */
+enum JsonStatsPhase {
+    JSON_STATS_PARSE, /* all of it, from the first byte to the last */
+    JSON_STATS_PRESIZE, /* counting container sizes first, see JsonDocument.presize */
+    JSON_STATS_WHITESPACE,
+    JSON_STATS_STRINGS, /* keys included */
+    JSON_STATS_NUMBERS,
+    JSON_STATS_HANDLER, /* inside handler callbacks, building the tree when parsing one */
+    JSON_STATS_PHASES
+};
+
+/*
+ * What the parser did, to find out why a document parses slowly. Only
+ * counted when built with JSON_STATS defined, otherwise the counting
+ * compiles away and every count reads 0. Counts are kept per thread and
+ * add up over every parse since json_stats_reset.
+ */
+struct JsonStats {
+    /* bytes of input in each kind of token, strings and keys with their quotes */
+    json_uint whitespace_bytes, string_bytes, number_bytes, literal_bytes;
+    json_uint strings, escapes, numbers, literals;
+    json_uint arrays, objects, max_depth;
+    /* object lookups, and the pairs or index slots each one looked at */
+    json_uint object_lookups, object_probes, object_probe_max;
+    /* growing memory that was already there */
+    json_uint array_reallocs, object_reallocs, object_reindexes, scratch_reallocs, nesting_reallocs;
+    /* cycles spent in each phase, as counted by json_stats_cycles */
+    json_uint cycles[JSON_STATS_PHASES];
+};
+
+/* copy what was counted in this thread into stats */
+void json_stats_get(struct JsonStats* const stats);
+
+/* start counting from zero in this thread */
+void json_stats_reset(void);
+
+/* add stats to total, e.g. to sum up several threads */
+void json_stats_add(struct JsonStats* const total, const struct JsonStats* const stats);
+
+/*
+ * A cycle counter: the time stamp counter on x86, the virtual counter on
+ * AArch64 and clock() anywhere else. Only differences mean anything.
+ */
+json_uint json_stats_cycles(void);
+
+#ifdef JSON_STATS
+
+# if __STDC_VERSION__ >= 201112L
+#  define JSON_STATS_THREAD _Thread_local
+# elif defined(__GNUC__) || defined(__clang__)
+#  define JSON_STATS_THREAD __thread
+# elif defined(_MSC_VER)
+#  define JSON_STATS_THREAD __declspec(thread)
+# else
+#  define JSON_STATS_THREAD /* shared by every thread */
+# endif
+
+struct JsonStatsState {
+    struct JsonStats stats;
+    json_uint started[JSON_STATS_PHASES];
+};
+
+extern JSON_STATS_THREAD struct JsonStatsState json_stats_state;
+
+bool json_stats_stop(const enum JsonStatsPhase phase, const bool result);
+
+# define STATS_ADD(field, amount) (json_stats_state.stats.field += (amount))
+# define STATS_MAX(field, value) \
+    ((value) > json_stats_state.stats.field ? (void)(json_stats_state.stats.field = (value)) : (void)0)
+# define STATS_START(phase) (json_stats_state.started[phase] = json_stats_cycles())
+# define STATS_STOP(phase) ((void)json_stats_stop((phase), true))
+/* stop timing phase, evaluating to result */
+# define STATS_STOP_WITH(phase, result) json_stats_stop((phase), (result))
+
+#else
+
+/* what would have been counted is still evaluated, so it doesn't go unused */
+# define STATS_ADD(field, amount) ((void)(amount))
+# define STATS_MAX(field, value) ((void)(value))
+# define STATS_START(phase) ((void)0)
+# define STATS_STOP(phase) ((void)0)
+# define STATS_STOP_WITH(phase, result) (result)
+
+#endif /* JSON_STATS */
+
+#endif /* JSON_STATS_H */
@@ -0,0 +1,272 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tape.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TAPE_WORD(type, payload) (((json_uint)(unsigned char)(type) << 56) | (json_uint)(payload))
+
+/* builds a tape out of parse events */
+struct TapeBuilder {
+    struct JsonTape *tape;
+    size_t open; /* the innermost open container plus one, 0 at the top */
+    bool out_of_memory;
+};
+
+void tape_construct(struct JsonTape* const tape) {
+    tape->words = NULL;
+    tape->length = 0;
+    tape->allocated = 0;
+    tape->strings = NULL;
+    tape->strings_length = 0;
+    tape->strings_allocated = 0;
+}
+
+void tape_dealloc(struct JsonTape* const tape) {
+    free(tape->words);
+    free(tape->strings);
+    tape_construct(tape);
+}
+
+static bool tape_push(struct TapeBuilder* const builder, const json_uint word) {
+    struct JsonTape *tape = builder->tape;
+    size_t allocated;
+    json_uint *words;
+
+    if (tape->length >= tape->allocated) {
+        allocated = tape->allocated ? tape->allocated * 2 : 256;
+        words = realloc(tape->words, allocated * sizeof(json_uint));
+        if (words == NULL) {
+            builder->out_of_memory = true;
+            return false;
+        }
+        tape->words = words;
+        tape->allocated = allocated;
+    }
+
+    tape->words[tape->length++] = word;
+    return true;
+}
+
+static bool tape_on_start(struct TapeBuilder* const builder, const char type) {
+    /* until it's closed, the container links to the one it's in */
+    if (!tape_push(builder, TAPE_WORD(type, builder->open)))
+        return false;
+
+    builder->open = builder->tape->length;
+    return true;
+}
+
+static bool tape_on_end(struct TapeBuilder* const builder, const char type) {
+    struct JsonTape *tape = builder->tape;
+    size_t start = builder->open - 1;
+
+    builder->open = TAPE_PAYLOAD(tape->words[start]);
+    if (!tape_push(builder, TAPE_WORD(type, start)))
+        return false;
+
+    tape->words[start] = TAPE_WORD(TAPE_TYPE(tape->words[start]), tape->length);
+    return true;
+}
+
+static bool tape_on_object_start(void *context) {
+    return tape_on_start(context, '{');
+}
+
+static bool tape_on_object_end(void *context) {
+    return tape_on_end(context, '}');
+}
+
+static bool tape_on_array_start(void *context) {
+    return tape_on_start(context, '[');
+}
+
+static bool tape_on_array_end(void *context) {
+    return tape_on_end(context, ']');
+}
+
+static bool tape_on_string(void *context, const char *string, size_t length) {
+    struct TapeBuilder *builder = context;
+    struct JsonTape *tape = builder->tape;
+    size_t needed = tape->strings_length + sizeof(size_t) + length + 1;
+    size_t allocated;
+    char *strings;
+
+    if (needed > tape->strings_allocated) {
+        allocated = tape->strings_allocated ? tape->strings_allocated : 4096;
+        while (allocated < needed)
+            allocated *= 2;
+
+        strings = realloc(tape->strings, allocated);
+        if (strings == NULL) {
+            builder->out_of_memory = true;
+            return false;
+        }
+        tape->strings = strings;
+        tape->strings_allocated = allocated;
+    }
+
+    memcpy(tape->strings + tape->strings_length, &length, sizeof(size_t));
+    memcpy(tape->strings + tape->strings_length + sizeof(size_t), string, length);
+    tape->strings[needed - 1] = '\0';
+
+    if (!tape_push(builder, TAPE_WORD('"', tape->strings_length + sizeof(size_t))))
+        return false;
+
+    tape->strings_length = needed;
+    return true;
+}
+
+static bool tape_on_number(void *context, double number) {
+    json_uint word;
+
+    memcpy(&word, &number, sizeof(word));
+    return tape_push(context, TAPE_WORD('d', 0)) && tape_push(context, word);
+}
+
+static bool tape_on_int(void *context, json_int integer) {
+    return tape_push(context, TAPE_WORD('l', 0)) && tape_push(context, (json_uint)integer);
+}
+
+static bool tape_on_bool(void *context, bool b) {
+    return tape_push(context, TAPE_WORD(b ? 't' : 'f', 0));
+}
+
+static bool tape_on_null(void *context) {
+    return tape_push(context, TAPE_WORD('n', 0));
+}
+
+bool tape_parse(struct JsonTape* const tape, char* const stream, struct JsonError* const error) {
+    struct TapeBuilder builder;
+    struct JsonHandler handler;
+
+    /* whatever was allocated for the last document is reused */
+    tape->length = 0;
+    tape->strings_length = 0;
+
+    builder.tape = tape;
+    builder.open = 0;
+    builder.out_of_memory = false;
+
+    handler.context = &builder;
+    handler.on_object_start = tape_on_object_start;
+    handler.on_object_end = tape_on_object_end;
+    handler.on_array_start = tape_on_array_start;
+    handler.on_array_end = tape_on_array_end;
+    handler.on_key = tape_on_string;
+    handler.on_string = tape_on_string;
+    handler.on_number = tape_on_number;
+    handler.on_int = tape_on_int;
+    handler.on_bool = tape_on_bool;
+    handler.on_null = tape_on_null;
+
+    if (!parse_events(stream, &handler, error)) {
+        if (builder.out_of_memory && error != NULL)
+            error->reason = "out of memory";
+        tape->length = 0;
+        tape->strings_length = 0;
+        return false;
+    }
+
+    return true;
+}
+
+enum ValueType tape_type(const struct JsonTape* const tape, const size_t at) {
+    switch (TAPE_TYPE(tape->words[at])) {
+    case '{': return Object;
+    case '[': return Array;
+    case '"': return String;
+    case 'l': return Int;
+    case 'd': return Number;
+    case 't': case 'f': return Bool;
+    case 'n': return Null;
+    default: return 0;
+    }
+}
+
+size_t tape_skip(const struct JsonTape* const tape, const size_t at) {
+    switch (TAPE_TYPE(tape->words[at])) {
+    case '{':
+    case '[':
+        return TAPE_PAYLOAD(tape->words[at]);
+    case 'l':
+    case 'd':
+        return at + 2;
+    default:
+        return at + 1;
+    }
+}
+
+double tape_number(const struct JsonTape* const tape, const size_t at) {
+    double number;
+
+    if (TAPE_TYPE(tape->words[at]) == 'l')
+        return (double)(json_int)tape->words[at + 1];
+
+    memcpy(&number, &tape->words[at + 1], sizeof(number));
+    return number;
+}
+
+json_int tape_int(const struct JsonTape* const tape, const size_t at) {
+    return (json_int)tape->words[at + 1];
+}
+
+bool tape_bool(const struct JsonTape* const tape, const size_t at) {
+    return TAPE_TYPE(tape->words[at]) == 't';
+}
+
+const char *tape_string(const struct JsonTape* const tape, const size_t at, size_t* const length) {
+    const char *string = tape->strings + TAPE_PAYLOAD(tape->words[at]);
+
+    if (length != NULL)
+        memcpy(length, string - sizeof(size_t), sizeof(size_t));
+    return string;
+}
+
+void tape_iterate(const struct JsonTape* const tape, const size_t at, struct TapeIterator* const iterator) {
+    iterator->tape = tape;
+    iterator->at = at + 1;
+    iterator->end = TAPE_PAYLOAD(tape->words[at]) - 1;
+    iterator->object = TAPE_TYPE(tape->words[at]) == '{';
+}
+
+bool tape_iterator_done(const struct TapeIterator* const iterator) {
+    return iterator->at >= iterator->end;
+}
+
+void tape_iterator_next(struct TapeIterator* const iterator) {
+    iterator->at = tape_skip(iterator->tape, tape_iterator_value(iterator));
+}
+
+size_t tape_iterator_value(const struct TapeIterator* const iterator) {
+    /* keys are a single word */
+    return iterator->object ? iterator->at + 1 : iterator->at;
+}
+
+const char *tape_iterator_key(const struct TapeIterator* const iterator, size_t* const length) {
+    return tape_string(iterator->tape, iterator->at, length);
+}
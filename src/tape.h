@@ -0,0 +1,103 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JSON_TAPE_H
+#define JSON_TAPE_H
+
+#include "parser.h"
+
+#include <stddef.h>
+
+/*
+ * A read-only document laid out flat: one array of 64-bit words, the tape,
+ * and one buffer holding every string. Walking it is a sequential scan and
+ * freeing it takes two frees.
+ *
+ * Each value starts with a word whose top byte says what it is and whose
+ * other 56 bits depend on that:
+ *
+ *   '{' '['   the position right after the matching '}' or ']' word
+ *   '}' ']'   the position of the matching '{' or '['
+ *   '"'       where the string starts in strings, a size_t length precedes it
+ *   'l' 'd'   nothing, the next word holds the json_int or the double
+ *   'n' 't' 'f'
+ *
+ * An object's contents alternate between key strings and values, in
+ * document order with duplicate keys kept. Values
+ * are referred to by their position in the tape, the root is at 0.
+ */
+struct JsonTape {
+    json_uint *words;
+    size_t length, allocated;
+    char *strings;
+    size_t strings_length, strings_allocated;
+};
+
+#define TAPE_TYPE(word) ((char)((word) >> 56))
+#define TAPE_PAYLOAD(word) ((size_t)((word) & (((json_uint)1 << 56) - 1)))
+
+/* goes through the values of a container, or the pairs of an object */
+struct TapeIterator {
+    const struct JsonTape *tape;
+    size_t at, end;
+    bool object;
+};
+
+void tape_construct(struct JsonTape* const tape);
+
+/* parse stream into tape, replacing anything that was in it before */
+bool tape_parse(struct JsonTape* const tape, char* const stream, struct JsonError* const error);
+
+void tape_dealloc(struct JsonTape* const tape);
+
+/* the type of the value at at */
+enum ValueType tape_type(const struct JsonTape* const tape, const size_t at);
+
+/* the position right after the value at at */
+size_t tape_skip(const struct JsonTape* const tape, const size_t at);
+
+double tape_number(const struct JsonTape* const tape, const size_t at);
+
+json_int tape_int(const struct JsonTape* const tape, const size_t at);
+
+bool tape_bool(const struct JsonTape* const tape, const size_t at);
+
+/* a NUL-terminated string, length may be NULL */
+const char *tape_string(const struct JsonTape* const tape, const size_t at, size_t* const length);
+
+/* start going through the array or object at at */
+void tape_iterate(const struct JsonTape* const tape, const size_t at, struct TapeIterator* const iterator);
+
+bool tape_iterator_done(const struct TapeIterator* const iterator);
+
+void tape_iterator_next(struct TapeIterator* const iterator);
+
+/* the current value, for objects the value of the current pair */
+size_t tape_iterator_value(const struct TapeIterator* const iterator);
+
+/* the key of the current pair of an object */
+const char *tape_iterator_key(const struct TapeIterator* const iterator, size_t* const length);
+
+#endif /* JSON_TAPE_H */
@@ -25,59 +25,215 @@
 
 #include "types.h"
 #include "parser.h"
+#include "stats.h"
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
-void value_dealloc(struct Value *value) {
-    switch (value->type) {
+#ifdef JSON_NAN_BOXING
+
+const enum ValueType value_box_types[8] = {
+    Number, String, Array, Object, Null, Bool, Int, 0
+};
+
+void value_set_int(struct Value* const value, const json_int integer) {
+    json_int limit = (json_int)1 << 47;
+
+    if (integer >= -limit && integer < limit)
+        value->box.bits = NANBOX(6, (json_uint)integer & NANBOX_PAYLOAD);
+    else
+        VALUE_SET_NUMBER(value, (double)integer);
+}
+
+#endif
+
+/* a container being torn down, and how many of its children are gone */
+struct ReleaseFrame {
+    struct Value container;
+    size_t next;
+};
+
+#define RELEASE_LOCAL_DEPTH 32
+
+/* free what a container holds besides its children, and the container itself */
+static void container_free(struct Value* const container) {
+    struct Array *array;
+    struct Object *obj;
+
+    if (VALUE_TYPE(container) == Array) {
+        array = VALUE_ARRAY(container);
+        arena_free(array->arena, array->arr_dump);
+        arena_free(array->arena, array);
+    } else {
+        obj = VALUE_OBJECT(container);
+        arena_free(obj->arena, obj->nodes);
+        arena_free(obj->arena, obj->index);
+        arena_free(obj->arena, obj);
+    }
+}
+
+/* whether value is a container that is freed piece by piece */
+static bool container_owned(const struct Value* const value) {
+    if (VALUE_TYPE(value) == Array)
+        return !ARENA_BULK(VALUE_ARRAY(value)->arena);
+    if (VALUE_TYPE(value) == Object)
+        return !ARENA_BULK(VALUE_OBJECT(value)->arena);
+    return false;
+}
+
+/*
+ * Tear the tree under value down depth first without recursing, with a
+ * stack of the containers on the way down. Should the stack fail to grow,
+ * the subtree that didn't fit is released by a nested call instead.
+ */
+void value_release_in(struct Value *value, struct Arena* const arena) {
+    const struct JsonAllocator *allocator = ARENA_ALLOCATOR(arena);
+    struct ReleaseFrame local_stack[RELEASE_LOCAL_DEPTH], *stack = local_stack, *grown, *top;
+    size_t depth = 0, allocated = RELEASE_LOCAL_DEPTH;
+    struct Arena *owner;
+    struct Value *child;
+    struct Array *array;
+    struct Object *obj;
+
+    switch (VALUE_TYPE(value)) {
     case Number:
+    case Int:
     case Null:
     case Bool:
         break;
     case String:
-        free(value->as.string);
+        arena_free(arena, VALUE_STRING(value));
         break;
     case Array:
-        array_dealloc(value->as.array);
-        break;
     case Object:
-        object_dealloc(value->as.object);
+        if (!container_owned(value))
+            break;
+        stack[0].container = *value;
+        stack[0].next = 0;
+        depth = 1;
         break;
     default:
         return;
     }
 
-    value->type = 0;
-    free(value);
+    while (depth > 0) {
+        top = &stack[depth - 1];
+
+        if (VALUE_TYPE(&top->container) == Array) {
+            array = VALUE_ARRAY(&top->container);
+            owner = array->arena;
+            child = top->next < array->written ? &array->arr_dump[top->next] : NULL;
+        } else {
+            obj = VALUE_OBJECT(&top->container);
+            owner = obj->arena;
+            child = NULL;
+            if (top->next < obj->pairs) {
+                if (obj->keys == NULL)
+                    arena_free(owner, obj->nodes[top->next].key);
+                child = &obj->nodes[top->next].value;
+            }
+        }
+
+        if (child == NULL) {
+            container_free(&top->container);
+            --depth;
+            continue;
+        }
+
+        ++top->next;
+
+        if (VALUE_TYPE(child) == String) {
+            arena_free(owner, VALUE_STRING(child));
+        } else if (container_owned(child)) {
+            if (depth >= allocated) {
+                if (stack == local_stack) {
+                    grown = json_alloc(allocator, allocated * 2 * sizeof(struct ReleaseFrame));
+                    if (grown != NULL)
+                        memcpy(grown, local_stack, sizeof(local_stack));
+                } else {
+                    grown = json_realloc(allocator, stack, allocated * 2 * sizeof(struct ReleaseFrame));
+                }
+
+                if (grown == NULL) {
+                    value_release_in(child, owner);
+                    continue;
+                }
+
+                stack = grown;
+                allocated *= 2;
+            }
+
+            stack[depth].container = *child;
+            stack[depth].next = 0;
+            ++depth;
+        }
+    }
+
+    if (stack != local_stack)
+        json_free(allocator, stack);
+
+    VALUE_CLEAR(value);
 }
 
-void array_construct(struct Array *array) {
+void value_release(struct Value *value) {
+    value_release_in(value, NULL);
+}
+
+void value_dealloc_in(struct Value *value, struct Arena* const arena) {
+    value_release_in(value, arena);
+    arena_free(arena, value);
+}
+
+void value_dealloc(struct Value *value) {
+    value_dealloc_in(value, NULL);
+}
+
+void array_construct_in(struct Array *array, struct Arena* const arena) {
     array->allocated = 0;
     array->written = 0;
     array->arr_dump = NULL;
+    array->arena = arena;
+}
+
+void array_construct(struct Array *array) {
+    array_construct_in(array, NULL);
 }
 
 void array_dealloc(struct Array* const array) {
-    free(array->arr_dump);
-    free(array);
+    struct Value value;
+
+    /* arena memory is released with the arena itself */
+    VALUE_SET_ARRAY(&value, array);
+    value_release_in(&value, array->arena);
 }
 
-bool array_push(struct Array* const array, struct Value value) {
+bool array_reserve(struct Array* const array, const size_t count) {
     struct Value *tmp_heap;
 
-    if (array->written >= array->allocated) {
-        /* change allocation to be 8 blocks bigger and realloc to the new size */
-        array->allocated += 8;
-        tmp_heap = realloc(array->arr_dump, array->allocated * sizeof(struct Value));
+    if (count <= array->allocated)
+        return true;
 
-        if (tmp_heap == NULL) {
-            array->allocated -= 8;
-            return false;
-        }
+    STATS_ADD(array_reallocs, array->allocated != 0);
+    tmp_heap = arena_realloc(array->arena, array->arr_dump,
+                             array->allocated * sizeof(struct Value),
+                             count * sizeof(struct Value));
+    if (tmp_heap == NULL)
+        return false;
 
-        array->arr_dump = tmp_heap;
-    }
+    array->arr_dump = tmp_heap;
+    array->allocated = count;
+    return true;
+}
+
+bool array_push(struct Array* const array, struct Value value) {
+    /*
+     * double the allocation. growing by a constant would be quadratic,
+     * and in an arena every outgrown copy stays around until reset.
+     */
+    if (array->written >= array->allocated &&
+        !array_reserve(array, array->allocated ? array->allocated * 2 : 8))
+        return false;
 
     array->arr_dump[array->written] = value;
     ++array->written;
@@ -92,99 +248,420 @@ struct Value *array_at(const struct Array* const array, const size_t idx) {
 }
 
 
-static size_t object_hash(struct Object *obj, char* const to_hash) {
-    size_t value = 0;
-    char *cur_idx;
+/* word-at-a-time multiplicative hash, finished with a murmur3-style avalanche */
+#if ULONG_MAX > 0xffffffffUL
+# define HASH_MULTIPLIER 0x9e3779b97f4a7c15UL
+# define HASH_FINISH(h) ((h) ^= (h) >> 33, (h) *= 0xff51afd7ed558ccdUL, (h) ^= (h) >> 33)
+#else
+# define HASH_MULTIPLIER 0x9e3779b1UL
+# define HASH_FINISH(h) ((h) ^= (h) >> 16, (h) *= 0x85ebca6bUL, (h) ^= (h) >> 13)
+#endif
+
+static size_t object_hash(const char *key, size_t length) {
+    unsigned long hash = (unsigned long)length * HASH_MULTIPLIER;
+    unsigned long word;
+
+    for (; length >= sizeof(word); key += sizeof(word), length -= sizeof(word)) {
+        memcpy(&word, key, sizeof(word));
+        hash = (hash ^ word) * HASH_MULTIPLIER;
+        hash ^= hash >> 29;
+    }
 
-    for (cur_idx = to_hash; *cur_idx; ++cur_idx) {
-        value *= 256;
-        value += *cur_idx;
-        value %= obj->allocated;
+    if (length > 0) {
+        word = 0;
+        memcpy(&word, key, length);
+        hash = (hash ^ word) * HASH_MULTIPLIER;
     }
 
-    return value;
+    HASH_FINISH(hash);
+    return (size_t)hash;
 }
 
-void object_construct(struct Object *obj) {
-    obj->buckets = NULL;
+/* what every interned key is preceded by */
+struct InternedKey {
+    size_t hash, length;
+};
+
+#define INTERNED(key) ((const struct InternedKey *)(key) - 1)
+
+void object_construct_interned(struct Object *obj, struct Arena* const arena, struct KeyTable* const keys) {
+    obj->nodes = NULL;
+    obj->index = NULL;
     obj->allocated = 0;
     obj->pairs = 0;
+    obj->index_allocated = 0;
+    obj->arena = arena;
+    obj->keys = keys;
 }
 
-static void node_delete(struct Node *node) {
-    if (node == NULL)
-        return;
-    free(node->key);
-    node_delete(node->next);
-    free(node);
+void object_construct_in(struct Object *obj, struct Arena* const arena) {
+    object_construct_interned(obj, arena, NULL);
+}
+
+void object_construct(struct Object *obj) {
+    object_construct_in(obj, NULL);
 }
 
 void object_dealloc(struct Object *obj) {
-    size_t i;
-    for (i = 0; i < obj->allocated; ++i)
-        node_delete(obj->buckets[i]);
-    free(obj);
+    struct Value value;
+
+    /* arena memory is released with the arena itself */
+    VALUE_SET_OBJECT(&value, obj);
+    value_release_in(&value, obj->arena);
 }
 
-bool object_set(struct Object *obj, char *key, struct Value *value) {
+/*
+ * Find the index slot holding key, or the empty slot it would be inserted at.
+ * The index is open addressed with linear probing and is never full, so
+ * this always terminates.
+ */
+static size_t *object_index_find(const struct Object *obj, const char *key,
+                                 const size_t key_length, const size_t hash) {
+    size_t mask = obj->index_allocated - 1;
+    size_t i = hash & mask, probes;
+    const struct Node *node;
+
+    for (probes = 1;; i = (i + 1) & mask, ++probes) {
+        if (obj->index[i] == 0)
+            break;
+        node = &obj->nodes[obj->index[i] - 1];
+        if (node->key == key || (node->hash == hash && node->key_length == key_length &&
+                                 memcmp(node->key, key, key_length) == 0))
+            break;
+    }
+
+    STATS_ADD(object_lookups, 1);
+    STATS_ADD(object_probes, probes);
+    STATS_MAX(object_probe_max, probes);
+    return &obj->index[i];
+}
+
+/* (re)build the index with index_allocated slots */
+static bool object_reindex(struct Object *obj, const size_t index_allocated) {
+    size_t *index = arena_alloc(obj->arena, index_allocated * sizeof(size_t));
     struct Node *node;
-    struct Node *previous_node;
-    size_t hash_result;
+    size_t i;
 
-    if (!obj->buckets) {
-        obj->buckets = malloc(sizeof(struct Node *) * OBJECT_BUCKET_AMOUNT_DEFAULT);
-        if (obj->buckets == NULL)
-            return false;
-        obj->allocated = OBJECT_BUCKET_AMOUNT_DEFAULT;
+    if (index == NULL)
+        return false;
+
+    STATS_ADD(object_reindexes, 1);
+
+    /* small objects are searched linearly and don't have their hashes yet */
+    if (obj->index == NULL && obj->keys == NULL) {
+        for (i = 0; i < obj->pairs; ++i)
+            obj->nodes[i].hash = object_hash(obj->nodes[i].key, obj->nodes[i].key_length);
     }
 
-    hash_result = object_hash(obj, key);
-    node = obj->buckets[hash_result];
-    previous_node = NULL;
+    arena_free(obj->arena, obj->index);
+    memset(index, 0, index_allocated * sizeof(size_t));
+    obj->index = index;
+    obj->index_allocated = index_allocated;
+
+    for (i = 0; i < obj->pairs; ++i) {
+        node = &obj->nodes[i];
+        *object_index_find(obj, node->key, node->key_length, node->hash) = i + 1;
+    }
+
+    return true;
+}
+
+static struct Node *object_find(const struct Object *obj, const char *key,
+                                const size_t key_length, size_t* const hash_out) {
+    size_t i;
 
-    while (node != NULL) {
-        if (strcmp(key, node->key) == 0) {
-            /* deallocate value if already exists at key */
-            value_dealloc(&node->value);
-            node->value = *value;
-            return true;
+    if (obj->index == NULL) {
+        for (i = 0; i < obj->pairs; ++i) {
+            if (obj->nodes[i].key_length == key_length &&
+                memcmp(obj->nodes[i].key, key, key_length) == 0)
+                break;
         }
-        previous_node = node;
-        node = node->next;
+
+        /* every pair was compared, or the ones up to and including the match */
+        STATS_ADD(object_lookups, 1);
+        STATS_ADD(object_probes, i < obj->pairs ? i + 1 : i);
+        STATS_MAX(object_probe_max, i < obj->pairs ? i + 1 : i);
+        return i < obj->pairs ? &obj->nodes[i] : NULL;
+    }
+
+    *hash_out = object_hash(key, key_length);
+    i = *object_index_find(obj, key, key_length, *hash_out);
+    return i != 0 ? &obj->nodes[i - 1] : NULL;
+}
+
+/* like object_find, for a key interned in obj->keys, which is only ever equal to itself */
+static struct Node *object_find_interned(const struct Object *obj, const char *key) {
+    size_t i, mask, probes;
+
+    if (obj->index == NULL) {
+        for (i = 0; i < obj->pairs && obj->nodes[i].key != key; ++i)
+            ;
+
+        STATS_ADD(object_lookups, 1);
+        STATS_ADD(object_probes, i < obj->pairs ? i + 1 : i);
+        STATS_MAX(object_probe_max, i < obj->pairs ? i + 1 : i);
+        return i < obj->pairs ? &obj->nodes[i] : NULL;
     }
 
-    node = malloc(sizeof(struct Node));
+    /* object_index_find without the byte compares, every key in obj is interned too */
+    mask = obj->index_allocated - 1;
+    for (i = INTERNED(key)->hash & mask, probes = 1;
+         obj->index[i] != 0 && obj->nodes[obj->index[i] - 1].key != key; i = (i + 1) & mask)
+        ++probes;
+
+    STATS_ADD(object_lookups, 1);
+    STATS_ADD(object_probes, probes);
+    STATS_MAX(object_probe_max, probes);
+    return obj->index[i] != 0 ? &obj->nodes[obj->index[i] - 1] : NULL;
+}
+
+static void object_replace(struct Object *obj, struct Node *node, struct Value *value) {
+    /* deallocate value if already exists at key */
+    if (!ARENA_BULK(obj->arena))
+        value_release_in(&node->value, obj->arena);
+    node->value = *value;
+}
+
+bool object_reserve(struct Object *obj, const size_t count) {
+    struct Node *tmp_nodes;
+
+    if (count <= obj->allocated)
+        return true;
 
-    if (node == NULL)
+    STATS_ADD(object_reallocs, obj->allocated != 0);
+    tmp_nodes = arena_realloc(obj->arena, obj->nodes,
+                              obj->allocated * sizeof(struct Node),
+                              count * sizeof(struct Node));
+    if (tmp_nodes == NULL)
         return false;
 
-    node->key = malloc((strlen(key) + 1) * sizeof(char));
-    if (node->key == NULL)
+    obj->nodes = tmp_nodes;
+    obj->allocated = count;
+    return true;
+}
+
+/* append a pair whose key isn't in obj yet, the key is taken as is */
+static bool object_append(struct Object *obj, char *key, const size_t key_length,
+                          const size_t hash, struct Value *value) {
+    struct Node *node;
+    size_t index_allocated;
+
+    if (obj->pairs >= obj->allocated &&
+        !object_reserve(obj, obj->allocated ? obj->allocated * 2 : OBJECT_NODE_AMOUNT_DEFAULT))
         return false;
 
-    strcpy(node->key, key);
-    node->key[strlen(key)] = 0;
+    node = &obj->nodes[obj->pairs];
+    node->key = key;
+    node->key_length = key_length;
+    node->hash = hash;
     node->value = *value;
+    ++obj->pairs;
 
-    if (previous_node == NULL)
-        obj->buckets[hash_result] = node;
-    else
-        previous_node->next = node;
+    /*
+     * keep the index at most half full. a failed reindex only costs speed,
+     * the old index (or the linear search) still finds every pair.
+     */
+    if (obj->index == NULL) {
+        /* an object that was reserved for gets an index big enough for all of it */
+        if (obj->pairs > OBJECT_INDEX_THRESHOLD) {
+            index_allocated = OBJECT_INDEX_THRESHOLD * 4;
+            while (index_allocated < obj->allocated * 2)
+                index_allocated *= 2;
+            object_reindex(obj, index_allocated);
+        }
+    } else if (obj->pairs * 2 <= obj->index_allocated ||
+               !object_reindex(obj, obj->index_allocated * 2)) {
+        *object_index_find(obj, key, key_length, hash) = obj->pairs;
+    }
 
-    ++obj->pairs;
     return true;
 }
 
+bool object_set(struct Object *obj, char *key, struct Value *value) {
+    struct Node *node;
+    size_t key_length, hash;
+    const char *interned;
+    char *key_copy;
+
+    key_length = strlen(key);
+    if (obj->keys != NULL) {
+        interned = key_table_intern(obj->keys, key, key_length);
+        return interned != NULL && object_set_interned(obj, interned, value);
+    }
+
+    hash = 0;
+    node = object_find(obj, key, key_length, &hash);
+
+    if (node != NULL) {
+        object_replace(obj, node, value);
+        return true;
+    }
+
+    key_copy = arena_alloc(obj->arena, (key_length + 1) * sizeof(char));
+    if (key_copy == NULL)
+        return false;
+
+    memcpy(key_copy, key, key_length + 1);
+    if (!object_append(obj, key_copy, key_length, hash, value)) {
+        arena_free(obj->arena, key_copy);
+        return false;
+    }
+
+    return true;
+}
+
+bool object_set_owned(struct Object *obj, char *key, const size_t key_length, struct Value *value) {
+    struct Node *node;
+    size_t hash = 0;
+    const char *interned;
+
+    if (obj->keys != NULL) {
+        interned = key_table_intern(obj->keys, key, key_length);
+        if (interned == NULL || !object_set_interned(obj, interned, value))
+            return false;
+        arena_free(obj->arena, key);
+        return true;
+    }
+
+    node = object_find(obj, key, key_length, &hash);
+
+    if (node != NULL) {
+        object_replace(obj, node, value);
+        arena_free(obj->arena, key);
+        return true;
+    }
+
+    return object_append(obj, key, key_length, hash, value);
+}
+
+bool object_set_interned(struct Object *obj, const char *key, struct Value *value) {
+    struct Node *node = object_find_interned(obj, key);
+
+    if (node != NULL) {
+        object_replace(obj, node, value);
+        return true;
+    }
+
+    return object_append(obj, (char *)key, INTERNED(key)->length, INTERNED(key)->hash, value);
+}
+
 struct Value *object_get(struct Object *obj, char* key) {
     struct Node *node;
+    const char *interned;
+    size_t hash;
+
+    if (obj->keys != NULL) {
+        /* a key that was never interned can't be in the object */
+        interned = key_table_find(obj->keys, key, strlen(key));
+        node = interned != NULL ? object_find_interned(obj, interned) : NULL;
+    } else {
+        node = object_find(obj, key, strlen(key), &hash);
+    }
 
-    if (obj->buckets == NULL) /* not yet allocated (object_set wasn't yet called) */
-        return NULL;
-    for (node = obj->buckets[object_hash(obj, key)]; node != NULL; node = node->next) {
-        if (strcmp(key, node->key) == 0)
-            return &node->value;
+    return node != NULL ? &node->value : NULL;
+}
+
+struct Value *object_get_interned(struct Object *obj, const char *key) {
+    struct Node *node = object_find_interned(obj, key);
+
+    return node != NULL ? &node->value : NULL;
+}
+
+void key_table_construct(struct KeyTable* const table) {
+    key_table_construct_with(table, NULL);
+}
+
+void key_table_construct_with(struct KeyTable* const table, const struct JsonAllocator* const allocator) {
+    arena_construct_with(&table->arena, allocator);
+    table->slots = NULL;
+    table->count = 0;
+    table->allocated = 0;
+}
+
+void key_table_dealloc(struct KeyTable* const table) {
+    /* the slots come from the arena's allocator, so free them before it goes */
+    json_free(table->arena.allocator, (void *)table->slots);
+    arena_dealloc(&table->arena);
+    table->slots = NULL;
+    table->count = 0;
+    table->allocated = 0;
+}
+
+/* the slot holding key, or the empty slot it would go in, the table is never full */
+static const char **key_table_slot(const struct KeyTable* const table, const char* const key,
+                                   const size_t length, const size_t hash) {
+    size_t mask = table->allocated - 1, i;
+    const char *slot;
+
+    for (i = hash & mask;; i = (i + 1) & mask) {
+        slot = table->slots[i];
+        if (slot == NULL || slot == key ||
+            (INTERNED(slot)->hash == hash && INTERNED(slot)->length == length &&
+             memcmp(slot, key, length) == 0))
+            return &table->slots[i];
     }
+}
 
-    return NULL;
+/* double the slots, keys only move between slots and never in memory */
+static bool key_table_grow(struct KeyTable* const table) {
+    const char **old_slots = table->slots, *key;
+    size_t old_allocated = table->allocated, allocated, i;
+
+    allocated = old_allocated ? old_allocated * 2 : KEY_TABLE_SLOTS_DEFAULT;
+    table->slots = json_alloc(table->arena.allocator, allocated * sizeof(const char *));
+    if (table->slots == NULL) {
+        table->slots = old_slots;
+        return false;
+    }
+
+    for (i = 0; i < allocated; ++i)
+        table->slots[i] = NULL;
+    table->allocated = allocated;
+
+    for (i = 0; i < old_allocated; ++i) {
+        key = old_slots[i];
+        if (key != NULL)
+            *key_table_slot(table, key, INTERNED(key)->length, INTERNED(key)->hash) = key;
+    }
+
+    json_free(table->arena.allocator, (void *)old_slots);
+    return true;
+}
+
+const char *key_table_intern(struct KeyTable* const table, const char* const key, const size_t length) {
+    size_t hash = object_hash(key, length);
+    struct InternedKey *interned;
+    const char **slot;
+    char *copy;
+
+    if (table->allocated != 0) {
+        slot = key_table_slot(table, key, length, hash);
+        if (*slot != NULL)
+            return *slot;
+    }
+
+    /* keep the table at most half full */
+    if ((table->count + 1) * 2 > table->allocated && !key_table_grow(table))
+        return NULL;
+
+    interned = arena_alloc(&table->arena, sizeof(struct InternedKey) + length + 1);
+    if (interned == NULL)
+        return NULL;
+
+    interned->hash = hash;
+    interned->length = length;
+    copy = (char *)(interned + 1);
+    memcpy(copy, key, length);
+    copy[length] = '\0';
+
+    *key_table_slot(table, key, length, hash) = copy;
+    ++table->count;
+    return copy;
 }
 
+const char *key_table_find(const struct KeyTable* const table, const char* const key, const size_t length) {
+    if (table->allocated == 0)
+        return NULL;
+
+    return *key_table_slot(table, key, length, object_hash(key, length));
+}
@@ -26,6 +26,8 @@
 #ifndef JSON_TYPES_H
 #define JSON_TYPES_H
 
+#include "arena.h"
+
 #include <stddef.h>
 
 #if __STDC_VERSION__ >= 199901L
@@ -36,21 +38,52 @@
 # define false 0
 #endif
 
-#define OBJECT_BUCKET_AMOUNT_DEFAULT 8
+/* 64-bit integers, for numbers that don't fit a double exactly */
+#if __STDC_VERSION__ >= 199901L
+# include <stdint.h>
+typedef int64_t json_int;
+typedef uint64_t json_uint;
+#elif defined(_MSC_VER)
+typedef __int64 json_int;
+typedef unsigned __int64 json_uint;
+#elif defined(__GNUC__)
+__extension__ typedef long long json_int;
+__extension__ typedef unsigned long long json_uint;
+#else
+typedef long json_int; /* assumes long is 64 bits wide */
+typedef unsigned long json_uint;
+#endif
 
+#define OBJECT_NODE_AMOUNT_DEFAULT 4
+/* objects with more pairs than this get a hash index, must be a power of two */
+#define OBJECT_INDEX_THRESHOLD 16
+/* how many keys a key table makes room for to start with, must be a power of two */
+#define KEY_TABLE_SLOTS_DEFAULT 64
+
+
+enum ValueType {
+    Number = 1,
+    String,
+    Array,
+    Object,
+    Null,
+    Bool,
+    Int /* integers that fit json_int, anything else is a Number */
+};
+
+/*
+ * Values are read and written through the VALUE_ macros, which work the
+ * same whichever way a value is laid out. The setters evaluate their
+ * arguments once.
+ */
+#ifndef JSON_NAN_BOXING
 
 struct Value {
-    enum ValueType {
-        Number = 1,
-        String,
-        Array,
-        Object,
-        Null,
-        Bool
-    } type;
+    enum ValueType type;
 
     union {
         double number;
+        json_int integer;
         char *string;
         bool bool_;
         struct Array *array;
@@ -58,36 +91,193 @@ struct Value {
     } as;
 };
 
+#define VALUE_TYPE(value) ((value)->type)
+#define VALUE_NUMBER(value) ((value)->as.number)
+#define VALUE_INT(value) ((value)->as.integer)
+#define VALUE_STRING(value) ((value)->as.string)
+#define VALUE_BOOL(value) ((value)->as.bool_)
+#define VALUE_ARRAY(value) ((value)->as.array)
+#define VALUE_OBJECT(value) ((value)->as.object)
+
+#define VALUE_SET_NUMBER(value, n) ((value)->type = Number, (value)->as.number = (n))
+#define VALUE_SET_INT(value, i) ((value)->type = Int, (value)->as.integer = (i))
+#define VALUE_SET_STRING(value, s) ((value)->type = String, (value)->as.string = (s))
+#define VALUE_SET_BOOL(value, b) ((value)->type = Bool, (value)->as.bool_ = (b))
+#define VALUE_SET_ARRAY(value, a) ((value)->type = Array, (value)->as.array = (a))
+#define VALUE_SET_OBJECT(value, o) ((value)->type = Object, (value)->as.object = (o))
+#define VALUE_SET_NULL(value) ((value)->type = Null)
+/* mark a released value, its type is 0 from then on */
+#define VALUE_CLEAR(value) ((value)->type = 0)
+
+#else
+
+/*
+ * NaN-boxed values, 8 bytes instead of 16. Doubles are stored as they are,
+ * everything else hides in the payload of a quiet NaN: the 3 bits under the
+ * quiet bit tag it and the low 48 bits hold a pointer, a bool or an integer.
+ * Pointers must fit in 48 bits, which user space pointers do on x86-64 and
+ * AArch64. Integers that don't fit 48 bits are stored as a Number.
+ */
+struct Value {
+    union {
+        json_uint bits;
+        double number;
+    } box;
+};
+
+#define NANBOX_PAYLOAD (((json_uint)1 << 48) - 1)
+#define NANBOX(tag, payload) (((json_uint)(0x7ff8 | (tag)) << 48) | (json_uint)(payload))
+
+/* the type of each tag, tag 0 is the one NaN doubles are stored as */
+extern const enum ValueType value_box_types[8];
+
+#define VALUE_TYPE(value) ((value)->box.bits >> 51 == 0xfff ? value_box_types[(value)->box.bits >> 48 & 7] : Number)
+#define VALUE_NUMBER(value) ((value)->box.number)
+#define VALUE_INT(value) ((json_int)((value)->box.bits & NANBOX_PAYLOAD) - \
+                          (json_int)(((value)->box.bits & ((json_uint)1 << 47)) << 1))
+#define VALUE_STRING(value) ((char *)(size_t)((value)->box.bits & NANBOX_PAYLOAD))
+#define VALUE_BOOL(value) ((bool)((value)->box.bits & 1))
+#define VALUE_ARRAY(value) ((struct Array *)(size_t)((value)->box.bits & NANBOX_PAYLOAD))
+#define VALUE_OBJECT(value) ((struct Object *)(size_t)((value)->box.bits & NANBOX_PAYLOAD))
+
+#define VALUE_SET_NUMBER(value, n) ((value)->box.number = (n), \
+    (void)((value)->box.number != (value)->box.number && ((value)->box.bits = NANBOX(0, 0))))
+#define VALUE_SET_INT(value, i) value_set_int((value), (i))
+#define VALUE_SET_STRING(value, s) ((value)->box.bits = NANBOX(1, (size_t)(s)))
+#define VALUE_SET_ARRAY(value, a) ((value)->box.bits = NANBOX(2, (size_t)(a)))
+#define VALUE_SET_OBJECT(value, o) ((value)->box.bits = NANBOX(3, (size_t)(o)))
+#define VALUE_SET_NULL(value) ((value)->box.bits = NANBOX(4, 0))
+#define VALUE_SET_BOOL(value, b) ((value)->box.bits = NANBOX(5, (b) ? 1 : 0))
+#define VALUE_CLEAR(value) ((value)->box.bits = NANBOX(7, 0))
+
+void value_set_int(struct Value* const value, const json_int integer);
+
+#endif /* JSON_NAN_BOXING */
+
+/*
+ * Containers remember the arena they were allocated from (NULL for the heap),
+ * so everything later added through array_push and object_set lives in that
+ * same arena. Values stored into an arena-backed container are owned by the
+ * arena and are released together with it, unless it's a heap arena: those
+ * are freed one by one, like heap containers.
+ */
 struct Array {
     struct Value *arr_dump;
     size_t allocated, written;
+    struct Arena *arena;
 };
 
+/*
+ * One copy of every key, shared by any number of objects and documents, for
+ * streams that use the same keys over and over. Interned keys are
+ * NUL-terminated, never modified and carry their hash and length, so two of
+ * them are equal exactly when they are the same pointer. They stay until the
+ * table is deallocated, which must outlive every object using it. A table
+ * isn't thread safe, give every thread its own.
+ */
+struct KeyTable {
+    struct Arena arena; /* where the keys live */
+    const char **slots; /* open addressed, NULL marks an empty slot */
+    size_t count, allocated;
+};
+
+/*
+ * Pairs are kept in one flat vector, in insertion order. Small objects are
+ * searched linearly; once an object grows past OBJECT_INDEX_THRESHOLD pairs
+ * it also gets an open addressed index holding node positions plus one
+ * (zero marks an empty slot). Nodes store the hash of their key once the
+ * object is indexed, so probing rarely has to touch the key itself.
+ *
+ * An object with a key table interns every key it's given there instead of
+ * copying it, and finds keys by comparing pointers. Its nodes always have
+ * their hashes, and its keys belong to the table.
+ */
 struct Object {
     struct Node {
-        struct Node *next;
+        size_t hash, key_length;
         char *key;
         struct Value value;
-    } **buckets;
-    size_t allocated, pairs;
+    } *nodes;
+    size_t *index;
+    size_t allocated, pairs, index_allocated;
+    struct Arena *arena;
+    struct KeyTable *keys; /* where keys are interned, NULL if the object owns them */
 };
 
+/* release everything value holds, but not value itself */
+void value_release(struct Value *value);
+
 void value_dealloc(struct Value *value);
 
+/*
+ * Like value_release and value_dealloc, for a value allocated from arena.
+ * Only heap arenas give anything back, the rest release all at once.
+ */
+void value_release_in(struct Value *value, struct Arena* const arena);
+
+void value_dealloc_in(struct Value *value, struct Arena* const arena);
+
 void array_construct(struct Array *array);
 
+/*
+ * An array whose elements are allocated from arena. array_dealloc frees the
+ * array itself too, so in a heap arena it must come from arena_alloc.
+ */
+void array_construct_in(struct Array *array, struct Arena* const arena);
+
 void array_dealloc(struct Array* const array);
 
+/* make room for count elements in all, so pushing up to that many never reallocates */
+bool array_reserve(struct Array* const array, const size_t count);
+
 bool array_push(struct Array* const array, struct Value value);
 
 struct Value *array_at(const struct Array* const array, const size_t idx);
 
 void object_construct(struct Object *obj);
 
+/* an object whose pairs are allocated from arena, see array_construct_in */
+void object_construct_in(struct Object *obj, struct Arena* const arena);
+
+/* an object whose keys are interned in keys, see object_construct_in */
+void object_construct_interned(struct Object *obj, struct Arena* const arena, struct KeyTable* const keys);
+
+/* make room for count pairs in all, so setting up to that many never reallocates */
+bool object_reserve(struct Object *obj, const size_t count);
+
 bool object_set(struct Object *obj, char *key, struct Value *value);
 
+/*
+ * Like object_set, but key (key_length bytes, NUL-terminated) isn't copied.
+ * On success obj owns key: it must come from obj's arena, or the heap if obj
+ * has none. On failure key is left to the caller.
+ */
+bool object_set_owned(struct Object *obj, char *key, const size_t key_length, struct Value *value);
+
+/* like object_set, for a key that was interned in obj->keys already */
+bool object_set_interned(struct Object *obj, const char *key, struct Value *value);
+
 void object_dealloc(struct Object *obj);
 
 struct Value *object_get(struct Object *obj, char *key);
 
+/*
+ * Like object_get, for a key interned in obj->keys already. Keys are only
+ * compared by pointer, without hashing or looking key up in the table.
+ */
+struct Value *object_get_interned(struct Object *obj, const char *key);
+
+void key_table_construct(struct KeyTable* const table);
+
+/* a table whose keys and slots all come from allocator */
+void key_table_construct_with(struct KeyTable* const table, const struct JsonAllocator* const allocator);
+
+void key_table_dealloc(struct KeyTable* const table);
+
+/* the interned copy of key (length bytes long), added if it isn't there yet, NULL if out of memory */
+const char *key_table_intern(struct KeyTable* const table, const char* const key, const size_t length);
+
+/* the interned copy of key, NULL if it never was interned */
+const char *key_table_find(const struct KeyTable* const table, const char* const key, const size_t length);
+
 #endif /* JSON_TYPES_H */
@@ -0,0 +1,325 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* writers to file descriptors need write, which isn't standard C */
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+# ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L
+# endif
+# include <errno.h>
+# include <unistd.h>
+# define WRITER_WRITE(fd, buffer, size) write((fd), (buffer), (size))
+#elif defined(_WIN32)
+# include <errno.h>
+# include <io.h>
+# define WRITER_WRITE(fd, buffer, size) _write((fd), (buffer), (unsigned int)(size))
+#endif
+
+#include "writer.h"
+#include "number.h"
+#include "scan.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void writer_construct(struct JsonWriter* const writer, const int fd) {
+    writer->pretty = false;
+    writer->indent = 2;
+    writer->buffer = NULL;
+    writer->length = 0;
+    writer->allocated = 0;
+    writer->fd = fd;
+    writer->failed = false;
+}
+
+void json_writer_construct(struct JsonWriter* const writer) {
+    writer_construct(writer, -1);
+}
+
+void json_writer_construct_fd(struct JsonWriter* const writer, const int fd) {
+    writer_construct(writer, fd);
+}
+
+void json_writer_dealloc(struct JsonWriter* const writer) {
+    free(writer->buffer);
+    writer->buffer = NULL;
+    writer->length = 0;
+    writer->allocated = 0;
+}
+
+bool json_writer_flush(struct JsonWriter* const writer) {
+#ifdef WRITER_WRITE
+    size_t done = 0;
+    long written;
+
+    if (writer->fd < 0 || writer->failed)
+        return !writer->failed;
+
+    while (done < writer->length) {
+        written = (long)WRITER_WRITE(writer->fd, writer->buffer + done, writer->length - done);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0) {
+            writer->failed = true;
+            return false;
+        }
+        done += (size_t)written;
+    }
+
+    writer->length = 0;
+    return true;
+#else
+    /* there's no writing to file descriptors here */
+    if (writer->fd >= 0)
+        writer->failed = true;
+    return !writer->failed;
+#endif
+}
+
+/* make room for size more bytes, by flushing or growing the buffer */
+static bool writer_reserve(struct JsonWriter* const writer, const size_t size) {
+    size_t allocated;
+    char *buffer;
+
+    if (writer->failed)
+        return false;
+
+    if (writer->fd >= 0 && writer->allocated - writer->length < size && !json_writer_flush(writer))
+        return false;
+
+    if (writer->allocated - writer->length >= size)
+        return true;
+
+    allocated = writer->allocated ? writer->allocated * 2 : writer->fd >= 0 ? WRITER_BUFFER_SIZE : 256;
+    while (allocated - writer->length < size)
+        allocated *= 2;
+
+    buffer = realloc(writer->buffer, allocated);
+    if (buffer == NULL) {
+        writer->failed = true;
+        return false;
+    }
+
+    writer->buffer = buffer;
+    writer->allocated = allocated;
+    return true;
+}
+
+static void writer_put(struct JsonWriter* const writer, const char* const bytes, const size_t size) {
+    if (writer->allocated - writer->length < size && !writer_reserve(writer, size))
+        return;
+
+    memcpy(writer->buffer + writer->length, bytes, size);
+    writer->length += size;
+}
+
+#define writer_put_char(writer, c) \
+    ((writer)->length < (writer)->allocated || writer_reserve((writer), 1) ? \
+     (void)((writer)->buffer[(writer)->length++] = (c)) : (void)0)
+
+/* start a new line indented depth levels, if writing pretty */
+static void writer_newline(struct JsonWriter* const writer, size_t depth) {
+    static const char spaces[] = "                                ";
+    size_t amount, chunk;
+
+    if (!writer->pretty)
+        return;
+
+    writer_put_char(writer, '\n');
+    for (amount = depth * writer->indent; amount > 0; amount -= chunk) {
+        chunk = amount < sizeof(spaces) - 1 ? amount : sizeof(spaces) - 1;
+        writer_put(writer, spaces, chunk);
+    }
+}
+
+static void writer_int(struct JsonWriter* const writer, const json_int integer) {
+    json_uint magnitude = integer < 0 ? (json_uint)0 - (json_uint)integer : (json_uint)integer;
+    char digits[24];
+    size_t i = sizeof(digits);
+
+    do {
+        digits[--i] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (integer < 0)
+        digits[--i] = '-';
+
+    writer_put(writer, &digits[i], sizeof(digits) - i);
+}
+
+static void writer_number(struct JsonWriter* const writer, const double number) {
+    char text[NUMBER_FORMAT_MAX];
+
+    /* json has no infinities and no NaN */
+    if (number != number || number - number != 0)
+        writer_put(writer, "null", 4);
+    else
+        writer_put(writer, text, number_format(number, text));
+}
+
+static void writer_string(struct JsonWriter* const writer, const char *string) {
+    static const char hex[] = "0123456789abcdef";
+    char escape[6];
+    size_t run;
+
+    writer_put_char(writer, '"');
+
+    for (;;) {
+        /* everything up to the next quote, backslash or control character goes out as is */
+        run = scan_string(string);
+        writer_put(writer, string, run);
+        string += run;
+
+        switch (*string) {
+        case '\0':
+            writer_put_char(writer, '"');
+            return;
+        case '"': writer_put(writer, "\\\"", 2); break;
+        case '\\': writer_put(writer, "\\\\", 2); break;
+        case '\b': writer_put(writer, "\\b", 2); break;
+        case '\f': writer_put(writer, "\\f", 2); break;
+        case '\n': writer_put(writer, "\\n", 2); break;
+        case '\r': writer_put(writer, "\\r", 2); break;
+        case '\t': writer_put(writer, "\\t", 2); break;
+        default:
+            memcpy(escape, "\\u00", 4);
+            escape[4] = hex[(unsigned char)*string >> 4];
+            escape[5] = hex[*string & 0xf];
+            writer_put(writer, escape, sizeof(escape));
+        }
+        ++string;
+    }
+}
+
+static void writer_scalar(struct JsonWriter* const writer, const struct Value* const value) {
+    switch (VALUE_TYPE(value)) {
+    case Number:
+        writer_number(writer, VALUE_NUMBER(value));
+        break;
+    case Int:
+        writer_int(writer, VALUE_INT(value));
+        break;
+    case String:
+        writer_string(writer, VALUE_STRING(value));
+        break;
+    case Bool:
+        if (VALUE_BOOL(value))
+            writer_put(writer, "true", 4);
+        else
+            writer_put(writer, "false", 5);
+        break;
+    case Null:
+        writer_put(writer, "null", 4);
+        break;
+    default:
+        /* a released value */
+        writer->failed = true;
+    }
+}
+
+/* an array or object being written, and the element or member up next */
+struct WriterFrame {
+    const struct Value *container;
+    size_t next;
+};
+
+/* nesting up to this deep needs no allocation */
+#define WRITER_LOCAL_DEPTH 32
+
+/*
+ * Write value and everything in it. Nesting doesn't recurse, the open
+ * containers are kept on a stack of their own, so no tree is too deep to
+ * be written.
+ */
+static void writer_value(struct JsonWriter* const writer, const struct Value* const value) {
+    struct WriterFrame local_stack[WRITER_LOCAL_DEPTH], *stack = local_stack, *grown, *top;
+    size_t depth = 0, allocated = WRITER_LOCAL_DEPTH, count;
+    const struct Value *child = value;
+    bool array;
+
+    for (;;) {
+        if (child != NULL && VALUE_TYPE(child) != Array && VALUE_TYPE(child) != Object) {
+            writer_scalar(writer, child);
+        } else if (child != NULL) {
+            if (depth >= allocated) {
+                grown = stack == local_stack ? malloc(allocated * 2 * sizeof(struct WriterFrame)) :
+                                               realloc(stack, allocated * 2 * sizeof(struct WriterFrame));
+                if (grown == NULL) {
+                    writer->failed = true;
+                    break;
+                }
+                if (stack == local_stack)
+                    memcpy(grown, local_stack, sizeof(local_stack));
+                stack = grown;
+                allocated *= 2;
+            }
+
+            stack[depth].container = child;
+            stack[depth].next = 0;
+            ++depth;
+            writer_put_char(writer, VALUE_TYPE(child) == Array ? '[' : '{');
+        }
+
+        if (depth == 0)
+            break;
+
+        top = &stack[depth - 1];
+        array = VALUE_TYPE(top->container) == Array;
+        count = array ? VALUE_ARRAY(top->container)->written : VALUE_OBJECT(top->container)->pairs;
+
+        if (top->next == count) {
+            if (count > 0)
+                writer_newline(writer, depth - 1);
+            writer_put_char(writer, array ? ']' : '}');
+            --depth;
+            child = NULL;
+            continue;
+        }
+
+        if (top->next > 0)
+            writer_put_char(writer, ',');
+        writer_newline(writer, depth);
+
+        if (array) {
+            child = &VALUE_ARRAY(top->container)->arr_dump[top->next];
+        } else {
+            writer_string(writer, VALUE_OBJECT(top->container)->nodes[top->next].key);
+            if (writer->pretty)
+                writer_put(writer, ": ", 2);
+            else
+                writer_put_char(writer, ':');
+            child = &VALUE_OBJECT(top->container)->nodes[top->next].value;
+        }
+        ++top->next;
+    }
+
+    if (stack != local_stack)
+        free(stack);
+}
+
+bool json_write(const struct Value* const value, struct JsonWriter* const writer) {
+    writer_value(writer, value);
+    return !writer->failed;
+}
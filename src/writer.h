@@ -0,0 +1,74 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include "types.h"
+
+#include <stddef.h>
+
+/* how much a writer to a file descriptor buffers before writing it out */
+#define WRITER_BUFFER_SIZE (64 * 1024)
+
+/*
+ * Serializes values as json, either into a buffer that grows as needed or,
+ * through a buffer, to a file descriptor. Everything a writer does depends
+ * only on the writer, so any number of them can be used at once from
+ * different threads.
+ *
+ * Numbers are written in as few digits as read back to exactly the same
+ * double, and always with a fraction or exponent, so they don't come back
+ * as an Int. Infinities and NaN, which json can't hold, are written as null.
+ */
+struct JsonWriter {
+    /* options, may be changed at any time after construction */
+    bool pretty; /* a value per line, indented, instead of no whitespace at all */
+    size_t indent; /* spaces per level when pretty, 2 by default */
+    /* everything written and not yet flushed, which isn't NUL-terminated */
+    char *buffer;
+    size_t length, allocated;
+    int fd; /* where the buffer is flushed to, -1 when writing to memory */
+    bool failed; /* out of memory or a write to fd failed, nothing is written after */
+};
+
+/* write into writer->buffer */
+void json_writer_construct(struct JsonWriter* const writer);
+
+/* write to fd, which is never closed by the writer */
+void json_writer_construct_fd(struct JsonWriter* const writer, const int fd);
+
+/*
+ * Append value to what was written before. Fails if the writer failed, now
+ * or before. A writer to a file descriptor has to be flushed when done.
+ */
+bool json_write(const struct Value* const value, struct JsonWriter* const writer);
+
+/* write everything buffered out to fd, does nothing when writing to memory */
+bool json_writer_flush(struct JsonWriter* const writer);
+
+void json_writer_dealloc(struct JsonWriter* const writer);
+
+#endif /* JSON_WRITER_H */
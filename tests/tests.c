@@ -0,0 +1,1752 @@
+/* Copyright (c) 2021, Yuval Tasher (ziki.flicky@gmail.com)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Checks the parsers against each other and against the C library, mostly
+ * on random input. Every test is a ctest test of its own, run one with
+ * `jsonfc_tests name` or all of them with no arguments.
+ */
+
+#include "index.h"
+#include "multi.h"
+#include "number.h"
+#include "parser.h"
+#include "push.h"
+#include "scan.h"
+#include "tape.h"
+#include "writer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t failures;
+
+/* report a failure on input, only the first few are printed */
+static void test_fail(const char* const test, const char* const input, const size_t length,
+                      const char* const what) {
+    size_t i;
+
+    if (failures++ >= 20)
+        return;
+
+    printf("%s: %s on \"", test, what);
+    for (i = 0; i < length && i < 200; ++i) {
+        if ((unsigned char)input[i] < ' ' || (unsigned char)input[i] >= 0x7f || input[i] == '"')
+            printf("\\x%02x", (unsigned char)input[i]);
+        else
+            putchar(input[i]);
+    }
+    printf(i < length ? "\"...\n" : "\"\n");
+}
+
+static json_uint test_state = 0x9e3779b97f4a7c15UL;
+
+/* xorshift, so runs are the same everywhere */
+static size_t test_random(const size_t below) {
+    test_state ^= test_state << 13;
+    test_state ^= test_state >> 7;
+    test_state ^= test_state << 17;
+    return (size_t)(test_state >> 11) % below;
+}
+
+/* a document being put together, as long as it fits */
+struct TestText {
+    char text[4096];
+    size_t length;
+};
+
+static void test_append(struct TestText* const text, const char* const append, const size_t length) {
+    if (text->length + length < sizeof(text->text)) {
+        memcpy(text->text + text->length, append, length);
+        text->length += length;
+    }
+}
+
+/* valid scalars and keys, with escapes and UTF-8 of every length */
+static const char* const test_scalars[] = {
+    "0", "-0", "1", "-12", "3.25", "1e3", "-1.5E-7", "9223372036854775807", "9223372036854775808",
+    "-9223372036854775809", "1e400", "2.2250738585072011e-308", "true", "false", "null", "\"\"",
+    "\"a\"", "\"tab\\there\"", "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"", "\"\\u00e9t\\u00e9\"",
+    "\"\\ud83d\\ude00\"", "\"\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\"",
+    "\"a long string that runs past one block of sixty four bytes, to reach the vectorized paths\""
+};
+
+static const char* const test_keys[] = {
+    "\"a\"", "\"b\"", "\"key\"", "\"\"", "\"\\u00e9\"", "\"\xc3\xa9\"", "\"with \\\"quotes\\\"\""
+};
+
+/* bytes that are likely to break a document in an interesting way */
+static const char test_breakers[] = "{}[]:,\"\\ 0-.eE+atfnu\x01\x1f\x7f\x80\xbf\xc3\xed\xf0\xff";
+
+static void test_blank(struct TestText* const text) {
+    static const char* const blanks[] = { "", "", "", " ", "\n", "\t ", "\r\n  " };
+
+    const char *blank = blanks[test_random(sizeof(blanks) / sizeof(blanks[0]))];
+    test_append(text, blank, strlen(blank));
+}
+
+/* a key out of test_keys, or one of many made up ones so that big objects get indexed */
+static void test_key(struct TestText* const text) {
+    const char *key;
+    char made_up[16];
+
+    if (test_random(2)) {
+        sprintf(made_up, "\"k%lu\"", (unsigned long)test_random(64));
+        key = made_up;
+    } else {
+        key = test_keys[test_random(sizeof(test_keys) / sizeof(test_keys[0]))];
+    }
+    test_append(text, key, strlen(key));
+}
+
+/*
+ * A random valid document, nesting at most depth deep. The innermost
+ * containers are sometimes big, past OBJECT_INDEX_THRESHOLD.
+ */
+static void test_value(struct TestText* const text, const size_t depth) {
+    const char *scalar;
+    size_t count, i, kind = depth > 0 ? test_random(4) : 0;
+
+    test_blank(text);
+
+    if (kind < 2) {
+        scalar = test_scalars[test_random(sizeof(test_scalars) / sizeof(test_scalars[0]))];
+        test_append(text, scalar, strlen(scalar));
+    } else {
+        count = depth == 1 && test_random(4) == 0 ? OBJECT_INDEX_THRESHOLD + 1 + test_random(24) : test_random(4);
+        test_append(text, kind == 2 ? "[" : "{", 1);
+
+        for (i = 0; i < count; ++i) {
+            if (i > 0)
+                test_append(text, ",", 1);
+            if (kind == 3) {
+                test_blank(text);
+                test_key(text);
+                test_blank(text);
+                test_append(text, ":", 1);
+            }
+            test_value(text, depth - 1);
+        }
+
+        test_blank(text);
+        test_append(text, kind == 2 ? "]" : "}", 1);
+    }
+
+    test_blank(text);
+}
+
+/* arrays and objects in turn, nested depth deep around a 0 */
+static void test_nested(struct TestText* const text, const size_t depth) {
+    size_t i;
+
+    for (i = 0; i < depth; ++i)
+        test_append(text, i % 2 ? "{\"\":" : "[", i % 2 ? 4 : 1);
+    test_append(text, "0", 1);
+    for (i = depth; i > 0; --i)
+        test_append(text, (i - 1) % 2 ? "}" : "]", 1);
+}
+
+/* arrays and objects of random kinds, nested depth deep, some with a member before the way down */
+static void test_deep(struct TestText* const text, const size_t depth) {
+    char *closing = malloc(depth);
+    size_t i;
+
+    if (closing == NULL)
+        return;
+
+    for (i = 0; i < depth; ++i) {
+        closing[i] = test_random(2) ? ']' : '}';
+        test_append(text, closing[i] == ']' ? "[" : "{", 1);
+        if (test_random(2)) {
+            if (closing[i] == '}') {
+                test_key(text);
+                test_append(text, ":", 1);
+            }
+            test_value(text, 0);
+            test_append(text, ",", 1);
+        }
+        if (closing[i] == '}') {
+            test_key(text);
+            test_append(text, ":", 1);
+        }
+    }
+
+    test_value(text, 2);
+    for (i = depth; i > 0; --i)
+        test_append(text, &closing[i - 1], 1);
+    free(closing);
+}
+
+/* change a valid document, usually but not always into an invalid one */
+static void test_mutate(struct TestText* const text) {
+    size_t at = text->length > 0 ? test_random(text->length) : 0;
+
+    switch (test_random(4)) {
+    case 0: /* drop a byte */
+        if (text->length > 0) {
+            memmove(text->text + at, text->text + at + 1, text->length - at - 1);
+            --text->length;
+        }
+        break;
+    case 1: /* overwrite a byte */
+        if (text->length > 0)
+            text->text[at] = test_breakers[test_random(sizeof(test_breakers) - 1)];
+        break;
+    case 2: /* insert a byte */
+        if (text->length + 1 < sizeof(text->text)) {
+            memmove(text->text + at + 1, text->text + at, text->length - at);
+            text->text[at] = test_breakers[test_random(sizeof(test_breakers) - 1)];
+            ++text->length;
+        }
+        break;
+    default: /* cut it short */
+        text->length = at;
+        break;
+    }
+}
+
+/* every event as a line of text, to compare the event streams of two parsers */
+static bool test_record(void *context, const char kind, const char* const data, const size_t length) {
+    struct TestText *events = context;
+
+    test_append(events, &kind, 1);
+    test_append(events, data, length);
+    test_append(events, "\n", 1);
+    return true;
+}
+
+static bool test_on_object_start(void *context) {
+    return test_record(context, '{', "", 0);
+}
+
+static bool test_on_object_end(void *context) {
+    return test_record(context, '}', "", 0);
+}
+
+static bool test_on_array_start(void *context) {
+    return test_record(context, '[', "", 0);
+}
+
+static bool test_on_array_end(void *context) {
+    return test_record(context, ']', "", 0);
+}
+
+static bool test_on_key(void *context, const char *key, size_t length) {
+    return test_record(context, 'k', key, length);
+}
+
+static bool test_on_string(void *context, const char *string, size_t length) {
+    return test_record(context, 's', string, length);
+}
+
+static bool test_on_number(void *context, double number) {
+    char text[NUMBER_FORMAT_MAX];
+
+    return test_record(context, 'd', text, number_format(number, text));
+}
+
+static bool test_on_int(void *context, json_int integer) {
+    char text[32];
+
+    sprintf(text, "%ld", (long)integer);
+    return test_record(context, 'i', text, strlen(text));
+}
+
+static bool test_on_bool(void *context, bool b) {
+    return test_record(context, b ? 't' : 'f', "", 0);
+}
+
+static bool test_on_null(void *context) {
+    return test_record(context, 'n', "", 0);
+}
+
+static void test_handler(struct JsonHandler* const handler, struct TestText* const events) {
+    events->length = 0;
+    handler->context = events;
+    handler->on_object_start = test_on_object_start;
+    handler->on_object_end = test_on_object_end;
+    handler->on_array_start = test_on_array_start;
+    handler->on_array_end = test_on_array_end;
+    handler->on_key = test_on_key;
+    handler->on_string = test_on_string;
+    handler->on_number = test_on_number;
+    handler->on_int = test_on_int;
+    handler->on_bool = test_on_bool;
+    handler->on_null = test_on_null;
+}
+
+static bool test_same_error(const struct JsonError* const a, const struct JsonError* const b) {
+    return a->offset == b->offset && strcmp(a->reason, b->reason) == 0;
+}
+
+/* write value out, into text */
+static void test_write(const struct Value* const value, struct TestText* const text) {
+    struct JsonWriter writer;
+
+    json_writer_construct(&writer);
+    json_write(value, &writer);
+    text->length = 0;
+    test_append(text, writer.buffer, writer.length);
+    json_writer_dealloc(&writer);
+}
+
+/*
+ * Every parser has to accept and reject the same documents, for the same
+ * reason at the same offset. The push parser is fed one byte at a time, so
+ * that every token spans chunks, or in chunks of random sizes.
+ */
+static void test_parse_one(const char* const text, const size_t length) {
+    struct JsonError parsed, other;
+    struct JsonHandler handler;
+    struct JsonPushParser push;
+    struct TestText events, pushed, written, rewritten;
+    struct JsonTape tape;
+    struct Value *value, *again;
+    bool accepted;
+    char *copy;
+    size_t i, chunk;
+
+    value = parse_n(text, length, &parsed);
+    /* trees can't hold a NUL, the rest take strings with their length */
+    accepted = value != NULL || strcmp(parsed.reason, "NUL character in string") == 0;
+
+    if (json_validate(text, length, &other) != accepted || (!accepted && !test_same_error(&parsed, &other)))
+        test_fail("parse", text, length, "json_validate disagrees with parse_n");
+
+    /* the rest want a terminator, which stops them early at a NUL byte */
+    copy = malloc(length + 1);
+    if (copy == NULL) {
+        test_fail("parse", text, length, "out of memory");
+        if (value != NULL)
+            value_dealloc(value);
+        return;
+    }
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    test_handler(&handler, &events);
+    if (parse_events(copy, &handler, &other) != accepted || (!accepted && !test_same_error(&parsed, &other)))
+        test_fail("parse", text, length, "parse_events disagrees with parse_n");
+
+    tape_construct(&tape);
+    if (tape_parse(&tape, copy, &other) != accepted || (!accepted && !test_same_error(&parsed, &other)))
+        test_fail("parse", text, length, "tape_parse disagrees with parse_n");
+    tape_dealloc(&tape);
+
+    test_handler(&handler, &pushed);
+    json_push_parser_construct(&push, &handler);
+    chunk = test_random(2) ? 1 : 0;
+    for (i = 0; i < length; i += chunk) {
+        chunk = chunk == 1 || length - i == 1 ? 1 : 1 + test_random(length - i);
+        if (!json_push_parser_feed(&push, text + i, chunk))
+            break;
+    }
+    if ((i >= length && json_push_parser_finish(&push)) != accepted) {
+        test_fail("parse", text, length, "the push parser disagrees with parse_n");
+    } else if (accepted) {
+        if (pushed.length != events.length || memcmp(pushed.text, events.text, events.length) != 0)
+            test_fail("parse", text, length, "the push parser's events differ from parse_events'");
+    } else if (!test_same_error(&push.error, &parsed)) {
+        test_fail("parse", text, length, "the push parser fails differently from parse_n");
+    }
+    json_push_parser_dealloc(&push);
+
+    /* what is written out parses back into the same tree */
+    if (value != NULL) {
+        test_write(value, &written);
+        again = parse_n(written.text, written.length, NULL);
+        if (again == NULL) {
+            test_fail("parse", text, length, "what json_write wrote doesn't parse");
+        } else {
+            test_write(again, &rewritten);
+            if (rewritten.length != written.length || memcmp(rewritten.text, written.text, written.length) != 0)
+                test_fail("parse", text, length, "the tree changed when written out and parsed back");
+            value_dealloc(again);
+        }
+        value_dealloc(value);
+    }
+
+    free(copy);
+}
+
+static void test_parse(void) {
+    static const char* const cases[] = {
+        "", " ", "{", "}", "[", "]", "[1,]", "{\"a\":1,}", "{\"a\" 1}", "{1:2}", "[1 2]", "01", "-", "1.",
+        "1e", "1e+", ".5", "+1", "tru", "nulll", "\"", "\"\\", "\"\\u12\"", "\"\\ud800\"", "\"\\udc00\"",
+        "\"\\ud800\\u0041\"", "\"\x01\"", "\"\xc3\"", "\"\xed\xa0\x80\"", "\"\xe0\x80\x80\"", "[]]", "{}{}",
+        "[1] x", "\"abc", "[\"a\",{\"b\":[true,false,null]}]", "[\"\\u0000\"]", "{\"a\\u0000\":1}"
+    };
+    static const char nul[] = "[\"a\\u0000\"]";
+    struct JsonError error;
+    struct TestText text;
+    struct Value *value;
+    size_t i;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+        test_parse_one(cases[i], strlen(cases[i]));
+
+    /* right up to the nesting limit and one past it, which every parser fails at the same bracket */
+    for (i = JSON_MAX_DEPTH_DEFAULT; i <= JSON_MAX_DEPTH_DEFAULT + 1; ++i) {
+        text.length = 0;
+        test_nested(&text, i);
+        test_parse_one(text.text, text.length);
+
+        value = parse_n(text.text, text.length, &error);
+        if ((value != NULL) != (i <= JSON_MAX_DEPTH_DEFAULT) ||
+            (value == NULL && strcmp(error.reason, "nested too deeply") != 0))
+            test_fail("parse", text.text, text.length, "parse_n doesn't stop at the nesting limit");
+        if (value != NULL)
+            value_dealloc(value);
+    }
+
+    /* rather than a string cut short, a tree fails right at the escape */
+    if (parse_n(nul, sizeof(nul) - 1, &error) != NULL || error.offset != 3 ||
+        strcmp(error.reason, "NUL character in string") != 0)
+        test_fail("parse", nul, sizeof(nul) - 1, "parse_n takes a NUL into a tree");
+
+    for (i = 0; i < 20000; ++i) {
+        text.length = 0;
+        test_value(&text, test_random(5));
+        if (test_random(2))
+            test_mutate(&text);
+        test_parse_one(text.text, text.length);
+    }
+
+    /* nested past PARSER_LOCAL_DEPTH, where the parsers' stacks of open containers grow */
+    for (i = 0; i < 2000; ++i) {
+        text.length = 0;
+        test_deep(&text, PARSER_LOCAL_DEPTH + test_random(3 * PARSER_LOCAL_DEPTH));
+        if (test_random(2))
+            test_mutate(&text);
+        test_parse_one(text.text, text.length);
+    }
+}
+
+static bool test_same_double(const double a, const double b) {
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+/* text written out as a number, next to what it should parse as */
+static void test_number_text(const struct TestText* const text, const double expected) {
+    struct JsonNumber number;
+
+    if (number_parse(text->text, text->length, &number) != text->length || number.integer ||
+        !test_same_double(number.as.number, expected))
+        test_fail("numbers", text->text, text->length, "number_parse doesn't round like strtod");
+}
+
+/*
+ * Numbers too long for the fast paths, down to the last of hundreds of
+ * digits. Halfway between 0 and the smallest double, 2^-1075 = 5^1075 /
+ * 10^1075, rounds to even, and any digit past it that isn't 0 rounds up.
+ */
+static void test_long_numbers(void) {
+    struct TestText text;
+    char five[800], digit;
+    size_t i, j, count, point, length = 1;
+
+    five[0] = 1;
+    for (i = 0; i < 1075; ++i) {
+        for (j = 0, digit = 0; j < length; ++j) {
+            digit = (char)(five[j] * 5 + digit);
+            five[j] = (char)(digit % 10);
+            digit /= 10;
+        }
+        if (digit > 0)
+            five[length++] = digit;
+    }
+
+    text.length = 0;
+    test_append(&text, "0.", 2);
+    for (i = length; i < 1075; ++i)
+        test_append(&text, "0", 1);
+    for (i = length; i > 0; --i) {
+        digit = (char)('0' + five[i - 1]);
+        test_append(&text, &digit, 1);
+    }
+    test_number_text(&text, 0.0);
+    test_append(&text, "000", 3);
+    test_number_text(&text, 0.0);
+    test_append(&text, "1", 1);
+    test_number_text(&text, 4.9406564584124654e-324);
+
+    for (i = 0; i < 3000; ++i) {
+        text.length = 0;
+        if (test_random(2))
+            test_append(&text, "-", 1);
+        count = 20 + test_random(1500);
+        point = test_random(count);
+        for (j = 0; j < count; ++j) {
+            digit = (char)(j == 0 ? '1' + test_random(9) : '0' + test_random(test_random(4) ? 10 : 1));
+            test_append(&text, &digit, 1);
+            if (j == point && j + 1 < count)
+                test_append(&text, ".", 1);
+        }
+        test_append(&text, "e-", 2 - test_random(2));
+        digit = (char)('0' + test_random(10));
+        test_append(&text, &digit, 1);
+        digit = (char)('0' + test_random(10));
+        test_append(&text, &digit, 1);
+        test_append(&text, "", 1);
+        --text.length;
+
+        test_number_text(&text, strtod(text.text, NULL));
+    }
+}
+
+/* number_parse has to round exactly like strtod, and number_format has to read back exactly */
+static void test_numbers(void) {
+    static const char* const cases[] = {
+        "0.1", "1e23", "8.98846567431158e307", "1.7976931348623157e308", "1.7976931348623159e308",
+        "2.2250738585072011e-308", "2.2250738585072014e-308", "4.9e-324", "2.4703282292062327e-324",
+        "2.4703282292062328e-324", "9007199254740993.0", "9007199254740992.5", "0.30000000000000004",
+        "123456789012345678901234567890e-10", "1e-400", "-0.0", "7.0e-10", "3.0517578125e-05"
+    };
+    struct JsonNumber number;
+    struct TestText text;
+    char formatted[NUMBER_FORMAT_MAX], digit;
+    json_uint bits;
+    double value;
+    size_t i, j, count;
+
+    for (i = 0; i < 200000; ++i) {
+        text.length = 0;
+
+        if (i < sizeof(cases) / sizeof(cases[0])) {
+            test_append(&text, cases[i], strlen(cases[i]));
+        } else {
+            if (test_random(2))
+                test_append(&text, "-", 1);
+            digit = (char)('1' + test_random(9));
+            test_append(&text, &digit, 1);
+            for (j = 0, count = test_random(25); j < count; ++j) {
+                digit = (char)('0' + test_random(10));
+                test_append(&text, &digit, 1);
+            }
+            /* a fraction or an exponent keeps it from being an integer */
+            test_append(&text, ".", 1);
+            for (j = 0, count = 1 + test_random(10); j < count; ++j) {
+                digit = (char)('0' + test_random(10));
+                test_append(&text, &digit, 1);
+            }
+            if (test_random(2)) {
+                sprintf(formatted, "e%d", (int)test_random(700) - 350);
+                test_append(&text, formatted, strlen(formatted));
+            }
+        }
+        test_append(&text, "", 1);
+
+        if (number_parse(text.text, text.length - 1, &number) != text.length - 1 || number.integer ||
+            !test_same_double(number.as.number, strtod(text.text, NULL)))
+            test_fail("numbers", text.text, text.length - 1, "number_parse doesn't round like strtod");
+    }
+
+    for (i = 0; i < 200000; ++i) {
+        /* any finite double, bits picked at random */
+        bits = ((json_uint)test_random(1UL << 31) << 33) ^ ((json_uint)test_random(1UL << 31) << 2) ^
+               test_random(4);
+        memcpy(&value, &bits, sizeof(double));
+        if (value != value || value - value != 0)
+            continue;
+
+        count = number_format(value, formatted);
+        if (number_parse(formatted, count, &number) != count || number.integer ||
+            !test_same_double(number.as.number, value) || !test_same_double(strtod(formatted, NULL), value))
+            test_fail("numbers", formatted, count, "number_format doesn't read back exactly");
+    }
+
+    test_long_numbers();
+}
+
+/* how much of p is well-formed UTF-8, one code point at a time */
+static size_t test_utf8_prefix(const unsigned char* const p, const size_t length) {
+    size_t i = 0, need, k;
+    unsigned long point;
+
+    while (i < length) {
+        if (p[i] < 0x80) {
+            ++i;
+            continue;
+        }
+
+        if (p[i] >= 0xc2 && p[i] < 0xe0) {
+            need = 1;
+            point = p[i] & 0x1f;
+        } else if (p[i] >= 0xe0 && p[i] < 0xf0) {
+            need = 2;
+            point = p[i] & 0x0f;
+        } else if (p[i] >= 0xf0 && p[i] < 0xf5) {
+            need = 3;
+            point = p[i] & 0x07;
+        } else {
+            return i;
+        }
+
+        if (length - i <= need)
+            return i;
+        for (k = 1; k <= need; ++k) {
+            if ((p[i + k] & 0xc0) != 0x80)
+                return i;
+            point = point << 6 | (p[i + k] & 0x3f);
+        }
+
+        if ((need == 2 && point < 0x800) || (need == 3 && point < 0x10000) || point > 0x10ffff ||
+            (point >= 0xd800 && point <= 0xdfff))
+            return i;
+        i += need + 1;
+    }
+
+    return i;
+}
+
+static size_t test_encode(unsigned long point, unsigned char* const out) {
+    if (point < 0x80) {
+        out[0] = (unsigned char)point;
+        return 1;
+    }
+    if (point < 0x800) {
+        out[0] = (unsigned char)(0xc0 | point >> 6);
+        out[1] = (unsigned char)(0x80 | (point & 0x3f));
+        return 2;
+    }
+    if (point < 0x10000) {
+        out[0] = (unsigned char)(0xe0 | point >> 12);
+        out[1] = (unsigned char)(0x80 | (point >> 6 & 0x3f));
+        out[2] = (unsigned char)(0x80 | (point & 0x3f));
+        return 3;
+    }
+    out[0] = (unsigned char)(0xf0 | point >> 18);
+    out[1] = (unsigned char)(0x80 | (point >> 12 & 0x3f));
+    out[2] = (unsigned char)(0x80 | (point >> 6 & 0x3f));
+    out[3] = (unsigned char)(0x80 | (point & 0x3f));
+    return 4;
+}
+
+/*
+ * scan_utf8_n against the plain decoder above. Runs of 64 bytes and more go
+ * through the vectorized check where the CPU has one, shorter ones and the
+ * tails through the scalar one, so both are covered.
+ */
+static void test_utf8(void) {
+    unsigned char text[1024];
+    unsigned long point;
+    size_t i, j, length, target;
+
+    for (i = 0; i < 300000; ++i) {
+        target = test_random(600);
+        for (length = 0; length < target;) {
+            switch (test_random(i % 4 == 0 ? 2 : 5)) {
+            case 0:
+                point = test_random(0x80);
+                break;
+            case 1:
+                point = 0x80 + test_random(0x780);
+                break;
+            case 2:
+                point = 0x800 + test_random(0xf800);
+                if (point >= 0xd800 && point <= 0xdfff)
+                    point = 'a';
+                break;
+            case 3:
+                point = 0x10000 + test_random(0x100000);
+                break;
+            default:
+                point = ' ';
+                break;
+            }
+            length += test_encode(point, text + length);
+        }
+
+        /* break a few bytes, then maybe cut a sequence short */
+        for (j = test_random(3) == 0 ? 0 : 1 + test_random(3); j > 0 && length > 0; --j)
+            text[test_random(length)] = (unsigned char)(test_random(2) ? test_random(256) : 0x80 | test_random(0x40));
+        if (test_random(4) == 0 && length > 0)
+            length -= test_random(length);
+
+        if (scan_utf8_n((const char *)text, length) != test_utf8_prefix(text, length))
+            test_fail("utf8", (const char *)text, length, "scan_utf8_n disagrees with the plain decoder");
+    }
+}
+
+/* every document written out on a line of its own */
+static bool test_on_document(void *context, size_t index, struct Value *value) {
+    struct TestText *documents = context, written;
+
+    (void)index;
+    test_write(value, &written);
+    test_append(documents, written.text, written.length);
+    test_append(documents, "\n", 1);
+    return true;
+}
+
+/* parse text in small batches and on a few threads, which has to be the same as parsing it in one batch */
+static void test_multi_one(const char* const text, const size_t length, const size_t batch_size,
+                           const size_t threads) {
+    struct JsonMultiOptions options;
+    struct TestText serial, batched;
+    struct JsonError serial_error, batched_error;
+    bool serial_parsed, batched_parsed;
+
+    serial.length = 0;
+    options.context = &serial;
+    options.on_document = test_on_document;
+    options.threads = 1;
+    options.batch_size = length + 1;
+    serial_parsed = json_multi_parse(text, length, &options, &serial_error);
+
+    batched.length = 0;
+    options.context = &batched;
+    options.threads = threads;
+    options.batch_size = batch_size;
+    batched_parsed = json_multi_parse(text, length, &options, &batched_error);
+
+    if (batched_parsed != serial_parsed || (!serial_parsed && !test_same_error(&batched_error, &serial_error)))
+        test_fail("multi", text, length, "parsing in batches fails differently");
+    else if (batched.length != serial.length || memcmp(batched.text, serial.text, serial.length) != 0)
+        test_fail("multi", text, length, "parsing in batches finds other documents");
+}
+
+static void test_multi(void) {
+    static const char pretty[] = "{\"a\":\n 1,\n \"b\": [\n 2,\n 3\n ]\n}\n{\"c\":\n 4\n}\n";
+    struct TestText text;
+    size_t i, j, count, batch_size;
+
+    for (batch_size = 1; batch_size <= sizeof(pretty); ++batch_size)
+        test_multi_one(pretty, sizeof(pretty) - 1, batch_size, 1 + batch_size % 3);
+
+    for (i = 0; i < 2000; ++i) {
+        text.length = 0;
+        for (j = 0, count = 1 + test_random(8); j < count; ++j) {
+            test_value(&text, test_random(4));
+            test_append(&text, test_random(2) ? "\n" : " ", 1);
+        }
+        if (test_random(2))
+            test_mutate(&text);
+
+        test_multi_one(text.text, text.length, 1 + test_random(64), 1 + test_random(4));
+    }
+}
+
+/* json_parse_parallel has to build the same tree as parse_n, or fail the same way */
+static void test_parallel_one(const char* const text, const size_t length, const size_t threads) {
+    struct JsonError serial_error, parallel_error;
+    struct TestText serial, parallel;
+    struct Value *serial_value, *parallel_value;
+
+    serial_value = parse_n(text, length, &serial_error);
+    parallel_value = json_parse_parallel(text, length, threads, &parallel_error);
+
+    if ((serial_value != NULL) != (parallel_value != NULL) ||
+        (serial_value == NULL && !test_same_error(&serial_error, &parallel_error))) {
+        test_fail("parallel", text, length, "json_parse_parallel disagrees with parse_n");
+    } else if (serial_value != NULL) {
+        test_write(serial_value, &serial);
+        test_write(parallel_value, &parallel);
+        if (serial.length != parallel.length || memcmp(serial.text, parallel.text, serial.length) != 0)
+            test_fail("parallel", text, length, "json_parse_parallel builds another tree");
+    }
+
+    if (serial_value != NULL)
+        value_dealloc(serial_value);
+    if (parallel_value != NULL)
+        value_dealloc(parallel_value);
+}
+
+static void test_parallel(void) {
+    struct TestText text;
+    size_t i, j, depth, count;
+
+    /* an element nested right up to the limit and just past it, the array counts as a level */
+    for (depth = JSON_MAX_DEPTH_DEFAULT - 2; depth <= JSON_MAX_DEPTH_DEFAULT + 1; ++depth) {
+        text.length = 0;
+        test_append(&text, "[1,", 3);
+        test_nested(&text, depth - 1);
+        test_append(&text, ",2]", 3);
+        test_parallel_one(text.text, text.length, 2);
+    }
+
+    for (i = 0; i < 2000; ++i) {
+        text.length = 0;
+        test_append(&text, "[", 1);
+        for (j = 0, count = test_random(20); j < count; ++j) {
+            if (j > 0)
+                test_append(&text, ",", 1);
+            test_value(&text, test_random(4));
+        }
+        test_append(&text, "]", 1);
+        if (test_random(2))
+            test_mutate(&text);
+
+        test_parallel_one(text.text, text.length, 1 + test_random(4));
+    }
+}
+
+/* how deep the writer is made to go, far past what recursion would survive */
+#define TEST_WRITER_DEPTH 1000000
+
+/* pretty output reads back as the same tree, and no tree is too deep to write */
+static void test_writer(void) {
+    static const char small[] = "{\"a\":[1,{}],\"b\":[],\"c\":{\"d\":null}}";
+    static const char pretty[] = "{\n  \"a\": [\n    1,\n    {}\n  ],\n  \"b\": [],\n  \"c\": {\n    \"d\": null\n  }\n}";
+    struct JsonWriter writer;
+    struct TestText text, compact, again;
+    struct Value *value;
+    char *deep;
+    size_t i;
+
+    value = parse_n(small, sizeof(small) - 1, NULL);
+    json_writer_construct(&writer);
+    writer.pretty = true;
+    if (value == NULL || !json_write(value, &writer) || writer.length != sizeof(pretty) - 1 ||
+        memcmp(writer.buffer, pretty, writer.length) != 0)
+        test_fail("writer", small, sizeof(small) - 1, "pretty output isn't laid out as it should be");
+    json_writer_dealloc(&writer);
+    if (value != NULL)
+        value_dealloc(value);
+
+    for (i = 0; i < 2000; ++i) {
+        text.length = 0;
+        test_value(&text, test_random(6));
+        value = parse_n(text.text, text.length, NULL);
+        if (value == NULL)
+            continue;
+
+        test_write(value, &compact);
+        json_writer_construct(&writer);
+        writer.pretty = true;
+        writer.indent = test_random(4);
+        json_write(value, &writer);
+        value_dealloc(value);
+
+        value = parse_n(writer.buffer, writer.length, NULL);
+        if (value == NULL) {
+            test_fail("writer", writer.buffer, writer.length, "pretty output doesn't parse");
+        } else {
+            test_write(value, &again);
+            if (again.length != compact.length || memcmp(again.text, compact.text, compact.length) != 0)
+                test_fail("writer", writer.buffer, writer.length, "pretty output reads back as another tree");
+            value_dealloc(value);
+        }
+        json_writer_dealloc(&writer);
+    }
+
+    deep = malloc(2 * TEST_WRITER_DEPTH);
+    if (deep == NULL) {
+        test_fail("writer", "", 0, "out of memory");
+        return;
+    }
+    memset(deep, '[', TEST_WRITER_DEPTH);
+    memset(deep + TEST_WRITER_DEPTH, ']', TEST_WRITER_DEPTH);
+
+    value = parse_n_depth(deep, 2 * TEST_WRITER_DEPTH, TEST_WRITER_DEPTH, NULL);
+    json_writer_construct(&writer);
+    if (value == NULL || !json_write(value, &writer) || writer.length != 2 * TEST_WRITER_DEPTH ||
+        memcmp(writer.buffer, deep, writer.length) != 0)
+        test_fail("writer", deep, 2 * TEST_WRITER_DEPTH, "a deep tree isn't written as it was parsed");
+    json_writer_dealloc(&writer);
+    if (value != NULL)
+        value_dealloc(value);
+    free(deep);
+}
+
+/* an allocator that runs out after left allocations, to reach the out of memory paths */
+struct TestLimit {
+    struct JsonAllocator allocator;
+    size_t left;
+};
+
+static void *test_limit_allocate(void *context, size_t size) {
+    struct TestLimit *limit = context;
+
+    if (limit->left == 0)
+        return NULL;
+    --limit->left;
+    return malloc(size);
+}
+
+static void *test_limit_reallocate(void *context, void *ptr, size_t size) {
+    struct TestLimit *limit = context;
+
+    if (limit->left == 0)
+        return NULL;
+    --limit->left;
+    return realloc(ptr, size);
+}
+
+static void test_limit_deallocate(void *context, void *ptr) {
+    (void)context;
+    free(ptr);
+}
+
+/* counter counts what goes through limit, hand &counter->allocator out */
+static void test_limit_construct(struct TestLimit* const limit, struct JsonCountingAllocator* const counter,
+                                 const size_t left) {
+    limit->allocator.context = limit;
+    limit->allocator.allocate = test_limit_allocate;
+    limit->allocator.reallocate = test_limit_reallocate;
+    limit->allocator.deallocate = test_limit_deallocate;
+    limit->left = left;
+    json_counting_allocator_construct(counter, &limit->allocator);
+}
+
+/* enough pairs for an object to be indexed, and for the index to grow a few times */
+#define TEST_OBJECT_KEYS 200
+
+static void test_object_key(char* const key, const size_t i) {
+    sprintf(key, "key%lu", (unsigned long)(i * 7));
+}
+
+/*
+ * Whether obj holds exactly the first count keys, in the order they were
+ * added, with i as the value of key i, or -i for every third one once they
+ * were replaced. Keys in between are never there.
+ */
+static bool test_object_holds(struct Object* const obj, const size_t count, const bool replaced) {
+    struct TestText expected, written;
+    struct Value object, *found;
+    char key[32], pair[64];
+    json_int want;
+    size_t i;
+
+    if (obj->pairs != count || object_get(obj, "") != NULL || object_get(obj, "key") != NULL)
+        return false;
+
+    expected.length = 0;
+    test_append(&expected, "{", 1);
+    for (i = 0; i < count; ++i) {
+        test_object_key(key, i);
+        want = replaced && i % 3 == 0 ? -(json_int)i : (json_int)i;
+        found = object_get(obj, key);
+        if (found != &obj->nodes[i].value || VALUE_TYPE(found) != Int || VALUE_INT(found) != want)
+            return false;
+
+        sprintf(pair, "%s\"%s\":%ld", i > 0 ? "," : "", key, (long)want);
+        test_append(&expected, pair, strlen(pair));
+
+        sprintf(key, "key%lu", (unsigned long)(i * 7 + 3));
+        if (object_get(obj, key) != NULL)
+            return false;
+    }
+    test_append(&expected, "}", 1);
+
+    /* written out, as print_object prints it, in insertion order */
+    VALUE_SET_OBJECT(&object, obj);
+    test_write(&object, &written);
+    return written.length == expected.length && memcmp(written.text, expected.text, expected.length) == 0;
+}
+
+/* objects big enough to be indexed find, replace and keep the order of their keys, even out of memory */
+static void test_objects(void) {
+    struct JsonCountingAllocator counter;
+    struct TestLimit limit;
+    struct Arena arena;
+    struct Object *obj;
+    struct Value value;
+    char key[32];
+    size_t i, count, left;
+    bool ran_out;
+
+    obj = malloc(sizeof(struct Object));
+    if (obj == NULL) {
+        test_fail("objects", "", 0, "out of memory");
+        return;
+    }
+    object_construct(obj);
+
+    for (i = 0; i < TEST_OBJECT_KEYS; ++i) {
+        test_object_key(key, i);
+        VALUE_SET_INT(&value, (json_int)i);
+        if (!object_set(obj, key, &value))
+            test_fail("objects", key, strlen(key), "object_set fails");
+        if (i % 10 == 0 && !test_object_holds(obj, i + 1, false))
+            test_fail("objects", key, strlen(key), "an object loses track of its keys as it grows");
+    }
+
+    for (i = 0; i < TEST_OBJECT_KEYS; i += 3) {
+        test_object_key(key, i);
+        VALUE_SET_INT(&value, -(json_int)i);
+        if (!object_set(obj, key, &value))
+            test_fail("objects", key, strlen(key), "object_set fails to replace a value");
+    }
+    if (!test_object_holds(obj, TEST_OBJECT_KEYS, true))
+        test_fail("objects", "", 0, "replacing values changes more than the values");
+    object_dealloc(obj);
+
+    /* running out at every allocation in turn, the index's included */
+    for (left = 0;; ++left) {
+        test_limit_construct(&limit, &counter, left);
+        arena_construct_heap(&arena, &counter.allocator);
+        obj = arena_alloc(&arena, sizeof(struct Object));
+        if (obj == NULL)
+            continue;
+        object_construct_in(obj, &arena);
+
+        for (count = 0; count < TEST_OBJECT_KEYS; ++count) {
+            test_object_key(key, count);
+            VALUE_SET_INT(&value, (json_int)count);
+            if (!object_set(obj, key, &value))
+                break;
+        }
+        ran_out = count < TEST_OBJECT_KEYS;
+
+        /* what was added before is all there, and the rest can be added once there's memory again */
+        if (!test_object_holds(obj, count, false))
+            test_fail("objects", "", 0, "an object is broken after running out of memory");
+        limit.left = (size_t)-1;
+        for (; count < TEST_OBJECT_KEYS; ++count) {
+            test_object_key(key, count);
+            VALUE_SET_INT(&value, (json_int)count);
+            object_set(obj, key, &value);
+        }
+        if (!test_object_holds(obj, TEST_OBJECT_KEYS, false))
+            test_fail("objects", "", 0, "an object can't be added to after running out of memory");
+
+        object_dealloc(obj);
+        if (counter.bytes != 0)
+            test_fail("objects", "", 0, "an object leaks after running out of memory");
+        if (!ran_out)
+            break;
+    }
+}
+
+/*
+ * Two documents sharing a key table, each an object big enough to be
+ * indexed, with the same keys in opposite orders. One writes key 0 with an
+ * escape, which is still the same key once decoded. Equal keys have to be
+ * one pointer, and are found by it.
+ */
+static void test_key_table(void) {
+    struct JsonCountingAllocator counter;
+    struct JsonDocument first, second;
+    struct TestText texts[2];
+    struct KeyTable keys;
+    struct Value *roots[2], *found;
+    struct Object *objects[2];
+    const char *interned, *absent;
+    char key[32];
+    size_t i, j, count;
+
+    for (i = 0; i < 2; ++i) {
+        texts[i].length = 0;
+        test_append(&texts[i], "{", 1);
+        for (j = 0; j < TEST_OBJECT_KEYS; ++j) {
+            count = i == 0 ? j : TEST_OBJECT_KEYS - 1 - j;
+            if (i == 1 && count == 0)
+                strcpy(key, "\"key\\u0030\":1000");
+            else
+                sprintf(key, "\"key%lu\":%lu", (unsigned long)count, (unsigned long)(i * 1000 + count));
+            if (j > 0)
+                test_append(&texts[i], ",", 1);
+            test_append(&texts[i], key, strlen(key));
+        }
+        /* and the terminator parse_document wants */
+        test_append(&texts[i], "}", 2);
+    }
+
+    json_counting_allocator_construct(&counter, NULL);
+    key_table_construct_with(&keys, &counter.allocator);
+    document_construct(&first);
+    document_construct(&second);
+    first.keys = second.keys = &keys;
+
+    roots[0] = parse_document(&first, texts[0].text, NULL);
+    roots[1] = parse_document(&second, texts[1].text, NULL);
+    if (roots[0] == NULL || roots[1] == NULL || VALUE_TYPE(roots[0]) != Object || VALUE_TYPE(roots[1]) != Object) {
+        test_fail("keys", texts[0].text, texts[0].length, "documents sharing a key table don't parse");
+    } else {
+        objects[0] = VALUE_OBJECT(roots[0]);
+        objects[1] = VALUE_OBJECT(roots[1]);
+        count = keys.count;
+
+        for (i = 0; i < TEST_OBJECT_KEYS; ++i) {
+            sprintf(key, "key%lu", (unsigned long)i);
+            interned = key_table_find(&keys, key, strlen(key));
+            if (interned == NULL || interned != objects[0]->nodes[i].key ||
+                interned != objects[1]->nodes[TEST_OBJECT_KEYS - 1 - i].key ||
+                key_table_intern(&keys, key, strlen(key)) != interned)
+                test_fail("keys", key, strlen(key), "equal keys aren't the same pointer");
+
+            for (j = 0; j < 2; ++j) {
+                found = object_get_interned(objects[j], interned);
+                if (found == NULL || VALUE_INT(found) != (json_int)(j * 1000 + i) || object_get(objects[j], key) != found)
+                    test_fail("keys", key, strlen(key), "object_get_interned doesn't find an interned key");
+            }
+        }
+
+        /* a key that is interned, but in neither object */
+        absent = key_table_intern(&keys, "absent", 6);
+        if (key_table_find(&keys, "missing", 7) != NULL || keys.count != count + 1 || absent == NULL ||
+            object_get_interned(objects[0], absent) != NULL || object_get_interned(objects[1], absent) != NULL)
+            test_fail("keys", "absent", 6, "a key that isn't in an object is found");
+    }
+
+    document_dealloc(&first);
+    document_dealloc(&second);
+    key_table_dealloc(&keys);
+    if (counter.bytes != 0)
+        test_fail("keys", "", 0, "the key table doesn't give all its memory back");
+
+    /* the first key takes an arena chunk and the slots, both from the table's allocator */
+    json_counting_allocator_construct(&counter, NULL);
+    key_table_construct_with(&keys, &counter.allocator);
+    if (key_table_intern(&keys, "a", 1) == NULL || counter.allocations != 2)
+        test_fail("keys", "a", 1, "the key table doesn't allocate everything through its allocator");
+    key_table_dealloc(&keys);
+    if (counter.bytes != 0)
+        test_fail("keys", "", 0, "the key table doesn't give all its memory back");
+}
+
+/* running out of memory anywhere fails cleanly, without leaking what was built so far */
+static void test_memory(void) {
+    static const char sized[] = "{\"a\":[1,2,[3,\"x\"]],\"b\":{\"c\":\"d\",\"e\":{},\"f\":[]}}";
+    struct JsonCountingAllocator counter;
+    struct TestLimit limit;
+    struct JsonDocument doc;
+    struct Value *value;
+    char copy[sizeof(sized)];
+    size_t left;
+
+    /* a presized document in a heap arena, where containers are reserved as they open */
+    for (left = 0;; ++left) {
+        test_limit_construct(&limit, &counter, left);
+        document_construct(&doc);
+        arena_construct_heap(&doc.arena, &counter.allocator);
+        doc.presize = true;
+
+        memcpy(copy, sized, sizeof(sized));
+        value = parse_document(&doc, copy, NULL);
+        if (value != NULL)
+            value_dealloc_in(value, &doc.arena);
+        document_dealloc(&doc);
+
+        if (counter.bytes != 0)
+            test_fail("memory", sized, sizeof(sized) - 1, "a presized document leaks when out of memory");
+        if (value != NULL)
+            break;
+    }
+}
+
+/* whether a parse that gave value, or failed with error, made what parse_n makes of text */
+static bool test_same_parse(const char* const text, const size_t length, const struct Value* const value,
+                            const struct JsonError* const error) {
+    struct TestText expected, written;
+    struct JsonError parsed;
+    struct Value *tree = parse_n(text, length, &parsed);
+    bool same;
+
+    if (tree == NULL)
+        return value == NULL && test_same_error(&parsed, error);
+    if (value == NULL) {
+        value_dealloc(tree);
+        return false;
+    }
+
+    test_write(tree, &expected);
+    test_write(value, &written);
+    same = written.length == expected.length && memcmp(written.text, expected.text, expected.length) == 0;
+    value_dealloc(tree);
+    return same;
+}
+
+/*
+ * One document parsed into over and over, reset in between, parses like
+ * parse_n every time. The chunk a reset keeps is the biggest one, so after
+ * a text was parsed twice it holds all of it, and the next parse of that
+ * text holds on to no more memory than before.
+ */
+static void test_documents(void) {
+    struct JsonCountingAllocator counter;
+    struct JsonDocument doc;
+    struct JsonError error;
+    struct TestText text;
+    struct Value *value;
+    char copy[sizeof(text.text) + 1];
+    size_t i, round, bytes;
+
+    json_counting_allocator_construct(&counter, NULL);
+    document_construct_with(&doc, &counter.allocator);
+
+    for (i = 0; i < 5000; ++i) {
+        text.length = 0;
+        test_value(&text, test_random(5));
+        if (test_random(2))
+            test_mutate(&text);
+
+        for (round = 0; round < 3; ++round) {
+            memcpy(copy, text.text, text.length);
+            copy[text.length] = '\0';
+            doc.presize = test_random(2);
+
+            bytes = counter.bytes;
+            value = parse_document(&doc, copy, &error);
+            if (!test_same_parse(text.text, text.length, value, &error))
+                test_fail("documents", text.text, text.length, "a reused document parses differently from parse_n");
+            if (round == 2 && counter.bytes != bytes)
+                test_fail("documents", text.text, text.length, "a reused document keeps growing");
+
+            document_reset(&doc);
+            if (doc.root != NULL ||
+                (doc.arena.head != NULL && (doc.arena.head->next != NULL || doc.arena.head->used != 0)))
+                test_fail("documents", text.text, text.length, "document_reset keeps more than one empty chunk");
+        }
+    }
+
+    document_dealloc(&doc);
+    if (counter.bytes != 0)
+        test_fail("documents", "", 0, "a reused document leaks");
+}
+
+/* whether every string and key in value lies between start and end */
+static bool test_in_buffer(const struct Value* const value, const char* const start, const char* const end) {
+    const struct Array *array;
+    const struct Object *obj;
+    size_t i;
+
+    switch (VALUE_TYPE(value)) {
+    case String:
+        return VALUE_STRING(value) >= start && VALUE_STRING(value) + strlen(VALUE_STRING(value)) < end;
+    case Array:
+        array = VALUE_ARRAY(value);
+        for (i = 0; i < array->written; ++i) {
+            if (!test_in_buffer(&array->arr_dump[i], start, end))
+                return false;
+        }
+        return true;
+    case Object:
+        obj = VALUE_OBJECT(value);
+        for (i = 0; i < obj->pairs; ++i) {
+            if (obj->nodes[i].key < start || obj->nodes[i].key + obj->nodes[i].key_length >= end ||
+                !test_in_buffer(&obj->nodes[i].value, start, end))
+                return false;
+        }
+        return true;
+    default:
+        return true;
+    }
+}
+
+/*
+ * parse_document_in_situ makes the tree parse_n does, with every string and
+ * key decoded where it is in the stream, escapes included.
+ */
+static void test_in_situ(void) {
+    static const char escaped[] = "{\"k\\u00e9y\":[\"a\\nb\",\"\\ud83d\\ude00\"]}";
+    struct JsonDocument doc;
+    struct JsonError error;
+    struct TestText text;
+    struct Value *value, *found;
+    char copy[sizeof(text.text) + 1];
+    size_t i;
+
+    document_construct(&doc);
+
+    for (i = 0; i < 20000; ++i) {
+        text.length = 0;
+        test_value(&text, test_random(5));
+        if (test_random(2))
+            test_mutate(&text);
+        memcpy(copy, text.text, text.length);
+        copy[text.length] = '\0';
+
+        value = parse_document_in_situ(&doc, copy, &error);
+        if (!test_same_parse(text.text, text.length, value, &error))
+            test_fail("in_situ", text.text, text.length, "parse_document_in_situ disagrees with parse_n");
+        else if (value != NULL && !test_in_buffer(value, copy, copy + text.length + 1))
+            test_fail("in_situ", text.text, text.length, "a string is copied out of the stream");
+    }
+
+    /* decoded right over the escapes, from where the string starts */
+    memcpy(copy, escaped, sizeof(escaped));
+    value = parse_document_in_situ(&doc, copy, &error);
+    found = value != NULL && VALUE_TYPE(value) == Object ? object_get(VALUE_OBJECT(value), "k\xc3\xa9y") : NULL;
+    if (found == NULL || VALUE_OBJECT(value)->nodes[0].key != copy + 2 || VALUE_TYPE(found) != Array ||
+        VALUE_ARRAY(found)->written != 2 || VALUE_STRING(&VALUE_ARRAY(found)->arr_dump[0]) != copy + 14 ||
+        strcmp(VALUE_STRING(&VALUE_ARRAY(found)->arr_dump[0]), "a\nb") != 0 ||
+        VALUE_STRING(&VALUE_ARRAY(found)->arr_dump[1]) != copy + 21 ||
+        strcmp(VALUE_STRING(&VALUE_ARRAY(found)->arr_dump[1]), "\xf0\x9f\x98\x80") != 0)
+        test_fail("in_situ", escaped, sizeof(escaped) - 1, "escapes aren't decoded in place");
+
+    document_dealloc(&doc);
+}
+
+/* where test_files puts its documents, in the directory the tests run in */
+#define TEST_FILE "jsonfc_tests.json"
+
+/*
+ * A file is mapped whole and exactly, and parse_document_file and
+ * parse_file make of it what parse_n makes of its bytes. A file that isn't
+ * there fails to open.
+ */
+static void test_files(void) {
+    struct JsonDocument doc;
+    struct JsonError error;
+    struct TestText text;
+    struct Value *value;
+    size_t i, length;
+    char *buffer;
+    FILE *file;
+
+    document_construct(&doc);
+
+    for (i = 0; i < 1000; ++i) {
+        text.length = 0;
+        /* the first one is empty */
+        if (i > 0)
+            test_value(&text, test_random(5));
+        if (test_random(2))
+            test_mutate(&text);
+
+        file = fopen(TEST_FILE, "wb");
+        if (file == NULL || fwrite(text.text, 1, text.length, file) != text.length || fclose(file) != 0) {
+            test_fail("files", TEST_FILE, strlen(TEST_FILE), "can't write the file");
+            break;
+        }
+
+        buffer = map_file(TEST_FILE, &length, &error);
+        if (buffer == NULL || length != text.length || memcmp(buffer, text.text, length) != 0)
+            test_fail("files", text.text, text.length, "map_file doesn't map the whole file");
+        if (buffer != NULL)
+            unmap_file(buffer, length);
+
+        value = parse_document_file(&doc, TEST_FILE, &error);
+        if (!test_same_parse(text.text, text.length, value, &error) || doc.root != value)
+            test_fail("files", text.text, text.length, "parse_document_file disagrees with parse_n");
+
+        value = parse_file(TEST_FILE, &error);
+        if (!test_same_parse(text.text, text.length, value, &error))
+            test_fail("files", text.text, text.length, "parse_file disagrees with parse_n");
+        if (value != NULL)
+            value_dealloc(value);
+    }
+
+    remove(TEST_FILE);
+    if (map_file(TEST_FILE, &length, &error) != NULL || strcmp(error.reason, "can't open file") != 0 ||
+        parse_document_file(&doc, TEST_FILE, &error) != NULL || doc.root != NULL ||
+        strcmp(error.reason, "can't open file") != 0 || parse_file(TEST_FILE, &error) != NULL ||
+        strcmp(error.reason, "can't open file") != 0)
+        test_fail("files", TEST_FILE, strlen(TEST_FILE), "a missing file doesn't fail to open");
+
+    document_dealloc(&doc);
+}
+
+/* a member's key as parse_events reports it, and whether json_cursor_key and json_cursor_find agree */
+static bool test_cursor_key(const struct JsonCursor* const object, const struct JsonCursor* const member,
+                            struct TestText* const events) {
+    const struct JsonIndex *index = member->index;
+    struct JsonCursor key, found;
+    const char *raw, *found_raw;
+    size_t length, raw_length, found_length;
+    char *decoded;
+    bool escaped, same;
+
+    /* the key is the string two before the value, right before its ':' */
+    key.index = index;
+    key.at = member->at - 2;
+    if (!json_cursor_string(&key, NULL, &decoded, &length))
+        return false;
+    test_record(events, 'k', decoded, length);
+
+    escaped = memchr(index->buffer + index->offsets[key.at], '\\',
+                     index->offsets[member->at - 1] - index->offsets[key.at]) != NULL;
+    if (escaped) {
+        same = !json_cursor_key(member, &raw, &raw_length);
+    } else {
+        /* the first member with that key is found, which may come before this one */
+        same = json_cursor_key(member, &raw, &raw_length) && raw_length == length &&
+               memcmp(raw, decoded, length) == 0 && json_cursor_find(object, decoded, &found) &&
+               found.at <= member->at && json_cursor_key(&found, &found_raw, &found_length) &&
+               found_length == length && memcmp(found_raw, decoded, length) == 0;
+    }
+
+    free(decoded);
+    return same;
+}
+
+/*
+ * Walk the value at cursor the way parse_events reports it, into events.
+ * Going through a container one value at a time has to land where
+ * json_cursor_at and json_cursor_find do.
+ */
+static bool test_cursor_walk(const struct JsonCursor* const cursor, struct TestText* const events) {
+    struct JsonCursor child, found;
+    char number[NUMBER_FORMAT_MAX], *string;
+    json_int integer;
+    double real;
+    size_t i, length;
+    bool more, b;
+
+    switch (json_cursor_type(cursor)) {
+    case Array:
+        test_record(events, '[', "", 0);
+        for (i = 0, more = json_cursor_first(cursor, &child); more; ++i, more = json_cursor_next(&child)) {
+            if (!json_cursor_at(cursor, i, &found) || found.at != child.at || !test_cursor_walk(&child, events))
+                return false;
+        }
+        test_record(events, ']', "", 0);
+        return !json_cursor_at(cursor, i, &found) && !json_cursor_find(cursor, "", &found);
+    case Object:
+        test_record(events, '{', "", 0);
+        for (more = json_cursor_first(cursor, &child); more; more = json_cursor_next(&child)) {
+            if (!test_cursor_key(cursor, &child, events) || !test_cursor_walk(&child, events))
+                return false;
+        }
+        test_record(events, '}', "", 0);
+        return !json_cursor_at(cursor, 0, &found);
+    case String:
+        if (!json_cursor_string(cursor, NULL, &string, &length))
+            return false;
+        test_record(events, 's', string, length);
+        free(string);
+        return !json_cursor_number(cursor, &real) && !json_cursor_first(cursor, &child);
+    case Number:
+        if (json_cursor_int(cursor, &integer))
+            test_on_int(events, integer);
+        else if (json_cursor_number(cursor, &real))
+            test_record(events, 'd', number, number_format(real, number));
+        else
+            return false;
+        return !json_cursor_bool(cursor, &b) && !json_cursor_is_null(cursor);
+    case Bool:
+        if (!json_cursor_bool(cursor, &b))
+            return false;
+        test_record(events, b ? 't' : 'f', "", 0);
+        return !json_cursor_is_null(cursor) && !json_cursor_int(cursor, &integer);
+    case Null:
+        test_record(events, 'n', "", 0);
+        return json_cursor_is_null(cursor) && !json_cursor_bool(cursor, &b) &&
+               !json_cursor_string(cursor, NULL, &string, &length);
+    default:
+        return false;
+    }
+}
+
+/*
+ * Walking the cursors over a valid document reports what parse_events
+ * does, and json_cursor_parse makes parse_n's tree. Over a broken one they
+ * mustn't go wrong, whatever they answer.
+ */
+static void test_cursors_one(const char* const text, const size_t length) {
+    struct TestText events, walked;
+    struct JsonHandler handler;
+    struct JsonIndex index;
+    struct JsonCursor root;
+    struct JsonError error;
+    struct Value *value;
+    char *copy;
+    bool valid = json_validate(text, length, NULL);
+
+    if (!json_index_build(&index, text, length, &error)) {
+        if (valid)
+            test_fail("cursors", text, length, "a valid document isn't indexed");
+        return;
+    }
+
+    copy = malloc(length + 1);
+    if (copy == NULL) {
+        test_fail("cursors", text, length, "out of memory");
+        json_index_dealloc(&index);
+        return;
+    }
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    json_index_root(&index, &root);
+    walked.length = 0;
+    if (!test_cursor_walk(&root, &walked)) {
+        if (valid)
+            test_fail("cursors", text, length, "the cursors can't walk a valid document");
+    } else if (valid) {
+        test_handler(&handler, &events);
+        if (!parse_events(copy, &handler, NULL) || walked.length != events.length ||
+            memcmp(walked.text, events.text, events.length) != 0)
+            test_fail("cursors", text, length, "the cursors find other values than parse_events");
+    }
+
+    value = json_cursor_parse(&root, &error);
+    if (valid && memchr(text, '\0', length) == NULL && !test_same_parse(text, length, value, &error))
+        test_fail("cursors", text, length, "json_cursor_parse disagrees with parse_n");
+    if (value != NULL)
+        value_dealloc(value);
+
+    free(copy);
+    json_index_dealloc(&index);
+}
+
+static void test_cursors(void) {
+    static const char escaped[] = "{\"a\\\"b\":1,\"ab\":2}";
+    struct JsonIndex index;
+    struct JsonCursor root, member;
+    struct TestText text;
+    const char *key;
+    size_t i, length;
+
+    for (i = 0; i < 20000; ++i) {
+        text.length = 0;
+        if (i % 10 == 0)
+            test_deep(&text, 1 + test_random(2 * PARSER_LOCAL_DEPTH));
+        else
+            test_value(&text, test_random(5));
+        if (test_random(2))
+            test_mutate(&text);
+        test_cursors_one(text.text, text.length);
+    }
+
+    /* an escaped key can't be handed out as it is in the buffer, nor found */
+    if (!json_index_build(&index, escaped, sizeof(escaped) - 1, NULL)) {
+        test_fail("cursors", escaped, sizeof(escaped) - 1, "a valid document isn't indexed");
+        return;
+    }
+    json_index_root(&index, &root);
+    if (!json_cursor_first(&root, &member) || json_cursor_key(&member, &key, &length) ||
+        json_cursor_find(&root, "a\"b", &member) || !json_cursor_find(&root, "ab", &member) ||
+        !json_cursor_key(&member, &key, &length) || length != 2 || memcmp(key, "ab", 2) != 0)
+        test_fail("cursors", escaped, sizeof(escaped) - 1, "json_cursor_key hands out an escaped key");
+    json_index_dealloc(&index);
+}
+
+/*
+ * Walk the value at at with the tape iterators the way parse_events reports
+ * it, into events. Where the walk ends has to be where tape_skip says the
+ * value ends, and closing words point back at their opening ones.
+ */
+static bool test_tape_walk(const struct JsonTape* const tape, const size_t at, struct TestText* const events) {
+    struct TapeIterator iterator;
+    char number[NUMBER_FORMAT_MAX];
+    const char *string;
+    size_t length, end = at;
+
+    switch (tape_type(tape, at)) {
+    case Array:
+    case Object:
+        test_record(events, TAPE_TYPE(tape->words[at]), "", 0);
+        for (tape_iterate(tape, at, &iterator); !tape_iterator_done(&iterator); tape_iterator_next(&iterator)) {
+            if (iterator.object) {
+                string = tape_iterator_key(&iterator, &length);
+                if (string[length] != '\0')
+                    return false;
+                test_record(events, 'k', string, length);
+            }
+            if (!test_tape_walk(tape, tape_iterator_value(&iterator), events))
+                return false;
+        }
+        end = iterator.at;
+        if (TAPE_TYPE(tape->words[end]) != (tape_type(tape, at) == Array ? ']' : '}') ||
+            TAPE_PAYLOAD(tape->words[end]) != at)
+            return false;
+        test_record(events, TAPE_TYPE(tape->words[end]), "", 0);
+        ++end;
+        break;
+    case String:
+        string = tape_string(tape, at, &length);
+        if (string[length] != '\0' || tape_string(tape, at, NULL) != string)
+            return false;
+        test_record(events, 's', string, length);
+        ++end;
+        break;
+    case Int:
+        if (!test_same_double(tape_number(tape, at), (double)tape_int(tape, at)))
+            return false;
+        test_on_int(events, tape_int(tape, at));
+        end += 2;
+        break;
+    case Number:
+        test_record(events, 'd', number, number_format(tape_number(tape, at), number));
+        end += 2;
+        break;
+    case Bool:
+        test_record(events, tape_bool(tape, at) ? 't' : 'f', "", 0);
+        ++end;
+        break;
+    case Null:
+        test_record(events, 'n', "", 0);
+        ++end;
+        break;
+    default:
+        return false;
+    }
+
+    return tape_skip(tape, at) == end;
+}
+
+/* a tape holds what parse_events reports, in the same order, and ends right after the root */
+static void test_tape(void) {
+    struct TestText text, events, walked;
+    struct JsonHandler handler;
+    struct JsonTape tape;
+    char copy[sizeof(text.text) + 1];
+    size_t i;
+
+    tape_construct(&tape);
+
+    for (i = 0; i < 20000; ++i) {
+        text.length = 0;
+        if (i % 10 == 0)
+            test_deep(&text, 1 + test_random(2 * PARSER_LOCAL_DEPTH));
+        else
+            test_value(&text, test_random(5));
+        if (test_random(4) == 0)
+            test_mutate(&text);
+        memcpy(copy, text.text, text.length);
+        copy[text.length] = '\0';
+
+        /* the same tape over and over, so that it's reused */
+        if (!tape_parse(&tape, copy, NULL))
+            continue;
+
+        walked.length = 0;
+        test_handler(&handler, &events);
+        if (!test_tape_walk(&tape, 0, &walked) || tape_skip(&tape, 0) != tape.length)
+            test_fail("tape", text.text, text.length, "the tape can't be walked");
+        else if (!parse_events(copy, &handler, NULL) || walked.length != events.length ||
+                 memcmp(walked.text, events.text, events.length) != 0)
+            test_fail("tape", text.text, text.length, "the tape holds other values than parse_events finds");
+    }
+
+    tape_dealloc(&tape);
+}
+
+/*
+ * A counting allocator keeps count of all a document or a heap arena takes
+ * and gives back, and is back at zero once they're freed. Counting through
+ * a second counter, which sees every call once, checks the counts.
+ */
+static void test_allocator(void) {
+    struct JsonCountingAllocator counter, outer;
+    struct JsonDocument doc;
+    struct JsonError error;
+    struct TestText text;
+    struct Arena arena;
+    struct Value *value;
+    char copy[sizeof(text.text) + 1];
+    size_t i, peak = 0;
+    void *block;
+
+    json_counting_allocator_construct(&outer, NULL);
+    json_counting_allocator_construct(&counter, &outer.allocator);
+
+    for (i = 0; i < 5000; ++i) {
+        text.length = 0;
+        test_value(&text, test_random(5));
+        if (test_random(2))
+            test_mutate(&text);
+        memcpy(copy, text.text, text.length);
+        copy[text.length] = '\0';
+
+        if (i % 2 == 0) {
+            document_construct_with(&doc, &counter.allocator);
+            doc.presize = test_random(2);
+            value = i % 4 == 0 ? parse_document(&doc, copy, &error) : parse_document_in_situ(&doc, copy, &error);
+        } else {
+            arena_construct_heap(&arena, &counter.allocator);
+            value = parse_in(copy, &arena, &error);
+        }
+        if (!test_same_parse(text.text, text.length, value, &error))
+            test_fail("allocator", text.text, text.length, "parsing through a counting allocator changes the tree");
+
+        if (counter.bytes > peak)
+            peak = counter.bytes;
+        if (counter.peak < peak || counter.total < counter.peak || outer.bytes < counter.bytes)
+            test_fail("allocator", text.text, text.length, "the counting allocator loses track of the peak");
+
+        if (i % 2 == 0)
+            document_dealloc(&doc);
+        else if (value != NULL)
+            value_dealloc_in(value, &arena);
+
+        if (counter.bytes != 0 || outer.bytes != 0 || counter.allocations != counter.deallocations)
+            test_fail("allocator", text.text, text.length, "the counting allocator isn't back at zero");
+        if (outer.allocations != counter.allocations || outer.reallocations != counter.reallocations ||
+            outer.deallocations != counter.deallocations || outer.total < counter.total)
+            test_fail("allocator", text.text, text.length, "the counting allocator miscounts the calls");
+    }
+
+    /* zeroing the counts leaves what is held counted */
+    document_construct_with(&doc, &counter.allocator);
+    memcpy(copy, "[1,2]", 6);
+    if (parse_document(&doc, copy, NULL) == NULL || counter.bytes == 0) {
+        test_fail("allocator", copy, 5, "a document doesn't allocate through its allocator");
+    } else {
+        json_counting_allocator_reset(&counter);
+        if (counter.allocations != 0 || counter.total != 0 || counter.peak != counter.bytes)
+            test_fail("allocator", copy, 5, "json_counting_allocator_reset doesn't zero the counts");
+        document_dealloc(&doc);
+        if (counter.bytes != 0 || counter.deallocations == 0)
+            test_fail("allocator", copy, 5, "the counting allocator isn't back at zero after a reset");
+    }
+
+    /* the counts of a few calls, worked out by hand */
+    json_counting_allocator_construct(&counter, NULL);
+    block = json_alloc(&counter.allocator, 100);
+    if (block != NULL && (block = json_realloc(&counter.allocator, block, 300)) != NULL) {
+        json_free(&counter.allocator, json_alloc(&counter.allocator, 50));
+        block = json_realloc(&counter.allocator, block, 20);
+    }
+    if (block == NULL || counter.bytes != 20 || counter.peak != 350 || counter.total != 470 ||
+        counter.allocations != 2 || counter.reallocations != 2 || counter.deallocations != 1)
+        test_fail("allocator", "", 0, "the counting allocator miscounts a few calls");
+    json_free(&counter.allocator, block);
+    if (counter.bytes != 0 || counter.deallocations != 2)
+        test_fail("allocator", "", 0, "the counting allocator isn't back at zero");
+}
+
+struct Test {
+    const char *name;
+    void (*run)(void);
+};
+
+static const struct Test tests[] = {
+    { "parse", test_parse },
+    { "numbers", test_numbers },
+    { "utf8", test_utf8 },
+    { "multi", test_multi },
+    { "parallel", test_parallel },
+    { "writer", test_writer },
+    { "objects", test_objects },
+    { "keys", test_key_table },
+    { "memory", test_memory },
+    { "documents", test_documents },
+    { "in_situ", test_in_situ },
+    { "files", test_files },
+    { "cursors", test_cursors },
+    { "tape", test_tape },
+    { "allocator", test_allocator }
+};
+
+int main(int argc, char **argv) {
+    size_t i;
+    int arg;
+
+    for (i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+        for (arg = 1; arg < argc && strcmp(argv[arg], tests[i].name) != 0; ++arg)
+            ;
+        if (argc == 1 || arg < argc)
+            tests[i].run();
+    }
+
+    if (failures > 0)
+        printf("%lu failures\n", (unsigned long)failures);
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}